@@ -0,0 +1,105 @@
+/* =====================================================================
+ *
+ * This benchmark is a part of:
+ * "deltautils.h" - General-purpose utility library for C
+ *
+ * Source Code: https://github.com/Delta7Actual/Delta-Utils
+ * Created and maintained by Dror Sheffer
+ *
+ * Licensed under the MIT License.
+ * See the accompanying LICENSE file for full terms.
+ *
+ * =====================================================================
+ *
+ * Measures b64Encode / b64Decode throughput in GB/s (of raw bytes) for
+ * each base64 kernel available on this machine, scalar included.
+ *
+ * Build and run:
+ *
+ *     cc -O2 -o bench_base64 bench/bench_base64.c && ./bench_base64
+ *
+ * =====================================================================
+ */
+
+
+#define _POSIX_C_SOURCE 199309L
+
+#define DU_BASE64
+#define DU_IMPLEMENTATION
+#include "../deltautils.h"
+
+
+#define BENCH_BYTES (256u << 20)  // Total bytes processed per measurement
+
+static double __benchNow(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+static void __benchRun(const char *name, size_t size, uint8_t *raw, char *enc, uint8_t *dec) {
+    size_t rounds = BENCH_BYTES / size + 1;
+    size_t enc_len = 0, dec_len = 0;
+
+    double t0 = __benchNow();
+    for (size_t r = 0; r < rounds; r++) enc_len = b64Encode(raw, size, enc);
+    double t1 = __benchNow();
+    for (size_t r = 0; r < rounds; r++) dec_len = b64Decode(enc, enc_len, dec);
+    double t2 = __benchNow();
+
+    if (dec_len != size || memcmp(raw, dec, size) != 0) {
+        printf("  %-8s %9zu bytes | round trip FAILED\n", name, size);
+        return;
+    }
+
+    double bytes = (double)size * rounds;
+    printf("  %-8s %9zu bytes | encode %6.2f GB/s | decode %6.2f GB/s\n",
+            name, size, bytes / (t1 - t0), bytes / (t2 - t1));
+}
+
+int main(void) {
+    static const size_t sizes[] = { 64, 1024, 64 << 10, 1 << 20, 16 << 20 };
+    size_t max = 16 << 20;
+
+    uint8_t *raw = malloc(max);
+    char    *enc = malloc(max / 3 * 4 + 4);
+    uint8_t *dec = malloc(max);
+    if (!raw || !enc || !dec) return 1;
+
+    uint64_t x = 0x9E3779B97F4A7C15ull;
+    for (size_t i = 0; i < max; i++) {
+        x ^= x << 13;
+        x ^= x >> 7;
+        x ^= x << 17;
+        raw[i] = (uint8_t)x;
+    }
+
+#ifdef DU_BASE64_X86
+    // The bench includes the implementation, so it can pin each kernel
+    struct { const char *name; __B64EncodeKernel enc; __B64DecodeKernel dec; bool ok; } k[] = {
+        { "scalar", __b64EncodeNone,   __b64DecodeNone,   true },
+        { "ssse3",  __b64EncodeSsse3,  __b64DecodeSsse3,  __builtin_cpu_supports("ssse3") },
+        { "avx2",   __b64EncodeAvx2,   __b64DecodeAvx2,   __builtin_cpu_supports("avx2") },
+        { "avx512", __b64EncodeAvx512, __b64DecodeAvx512, __builtin_cpu_supports("avx512vbmi")
+                                                          && __builtin_cpu_supports("avx512bw") },
+    };
+
+    for (size_t i = 0; i < sizeof(k) / sizeof(k[0]); i++) {
+        if (!k[i].ok) continue;
+        __b64_encode_kernel = k[i].enc;
+        __b64_decode_kernel = k[i].dec;
+        for (size_t j = 0; j < sizeof(sizes) / sizeof(sizes[0]); j++) {
+            __benchRun(k[i].name, sizes[j], raw, enc, dec);
+        }
+    }
+#else
+    for (size_t j = 0; j < sizeof(sizes) / sizeof(sizes[0]); j++) {
+        __benchRun("default", sizes[j], raw, enc, dec);
+    }
+#endif
+
+    free(raw);
+    free(enc);
+    free(dec);
+    return 0;
+}
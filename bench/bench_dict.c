@@ -0,0 +1,139 @@
+/* =====================================================================
+ *
+ * This benchmark is a part of:
+ * "deltautils.h" - General-purpose utility library for C
+ *
+ * Source Code: https://github.com/Delta7Actual/Delta-Utils
+ * Created and maintained by Dror Sheffer
+ *
+ * Licensed under the MIT License.
+ * See the accompanying LICENSE file for full terms.
+ *
+ * =====================================================================
+ *
+ * Compares the Dictionary key hash against the byte-at-a-time DJB2
+ * hash (plus modulo bucket selection) it replaced.
+ *
+ * Build and run:
+ *
+ *     cc -O2 -o bench_dict bench/bench_dict.c && ./bench_dict
+ *
+ * =====================================================================
+ */
+
+
+#define _POSIX_C_SOURCE 199309L
+
+#define DU_DICT
+#define DU_IMPLEMENTATION
+#include "../deltautils.h"
+
+
+#define BENCH_KEYS   4096
+#define BENCH_ROUNDS  512
+
+static double __benchNow(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+/*
+ * The previous Dictionary hash, kept here for comparison.
+ * Based on the DJB2 hash function by Daniel J. Bernstein (djb)
+ */
+static uint32_t __benchDjb2(const void *key, size_t key_len, uint32_t size) {
+    const uint8_t *data = (const uint8_t *)key;
+    uint32_t hash = 5381;
+    for (size_t i = 0; i < key_len; i++) {
+        hash = ((hash << 5) + hash) ^ data[i];
+    }
+    return hash % size;
+}
+
+static void __benchFillKeys(uint8_t *keys, size_t key_len) {
+    uint64_t x = 0x9E3779B97F4A7C15ull;
+    for (size_t i = 0; i < BENCH_KEYS * key_len; i++) {
+        x ^= x << 13;
+        x ^= x >> 7;
+        x ^= x << 17;
+        keys[i] = (uint8_t)('a' + (x % 26));
+    }
+}
+
+static void __benchHash(size_t key_len) {
+    uint8_t *keys = malloc(BENCH_KEYS * key_len);
+    if (!keys) return;
+    __benchFillKeys(keys, key_len);
+
+    // Non-power-of-two divisor so the compiler cannot replace the modulo
+    volatile uint32_t size = DU_NBUCKET_LARGE - 1;
+    uint32_t mask = DU_NBUCKET_LARGE - 1;
+    uint64_t sink = 0;
+    Dictionary *d = dictNew(DU_NBUCKET_SMALL, NULL, NULL);
+    if (!d) {
+        free(keys);
+        return;
+    }
+
+    double t0 = __benchNow();
+    for (int r = 0; r < BENCH_ROUNDS; r++) {
+        for (size_t i = 0; i < BENCH_KEYS; i++) {
+            sink += __benchDjb2(keys + i * key_len, key_len, size);
+        }
+    }
+    double t1 = __benchNow();
+    for (int r = 0; r < BENCH_ROUNDS; r++) {
+        for (size_t i = 0; i < BENCH_KEYS; i++) {
+            sink += dictHash(d, keys + i * key_len, key_len) & mask;
+        }
+    }
+    double t2 = __benchNow();
+
+    double ops = (double)BENCH_ROUNDS * BENCH_KEYS;
+    double djb2 = (t1 - t0) / ops;
+    double wy = (t2 - t1) / ops;
+    printf("  %4zu bytes | djb2 %7.2f ns (%6.2f GB/s) | dictHash %7.2f ns (%6.2f GB/s) | %5.2fx\n",
+            key_len, djb2, key_len / djb2, wy, key_len / wy, djb2 / wy);
+
+    if (sink == 42) printf(" ");
+    dictFree(d);
+    free(keys);
+}
+
+static void __benchDict(uint32_t n) {
+    char (*keys)[32] = malloc((size_t)n * sizeof(*keys));
+    if (!keys) return;
+    for (uint32_t i = 0; i < n; i++) snprintf(keys[i], sizeof(keys[i]), "/var/log/app/%u.log", i);
+
+    Dictionary *d = dictNew(DU_NBUCKET_SMALL, NULL, NULL);
+    if (!d) {
+        free(keys);
+        return;
+    }
+
+    double t0 = __benchNow();
+    for (uint32_t i = 0; i < n; i++) dictSet(d, keys[i], strlen(keys[i]), keys[i]);
+    double t1 = __benchNow();
+    size_t hits = 0;
+    for (uint32_t i = 0; i < n; i++) hits += dictGet(d, keys[i], strlen(keys[i])) != NULL;
+    double t2 = __benchNow();
+
+    printf("  %8u keys | dictSet %7.2f ns/op | dictGet %7.2f ns/op | %zu hits\n",
+            n, (t1 - t0) / n, (t2 - t1) / n, hits);
+
+    dictFree(d);
+    free(keys);
+}
+
+int main(void) {
+    static const size_t lens[] = { 4, 8, 16, 40, 100, 200, 1024 };
+
+    printf("Key hashing (per key):\n");
+    for (size_t i = 0; i < sizeof(lens) / sizeof(lens[0]); i++) __benchHash(lens[i]);
+
+    printf("\nDictionary insert/lookup:\n");
+    for (uint32_t n = 1000; n <= 1000000; n *= 10) __benchDict(n);
+
+    return 0;
+}
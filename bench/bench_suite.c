@@ -0,0 +1,811 @@
+/* =====================================================================
+ *
+ * This benchmark is a part of:
+ * "deltautils.h" - General-purpose utility library for C
+ *
+ * Source Code: https://github.com/Delta7Actual/Delta-Utils
+ * Created and maintained by Dror Sheffer
+ *
+ * Licensed under the MIT License.
+ * See the accompanying LICENSE file for full terms.
+ *
+ * =====================================================================
+ *
+ * Microbenchmarks for every module, reporting ns/op, GB/s (where the
+ * operation has a byte size) and allocations per op. Allocations are
+ * counted through a DuAllocator installed with duSetAllocator, so they
+ * cover everything the library allocates.
+ *
+ * Build and run (see bench/Makefile):
+ *
+ *     make -C bench run                    # table + bench/results.json
+ *     ./bench/bench_suite --json           # JSON on stdout
+ *     ./bench/bench_suite --filter dict/   # only names containing "dict/"
+ *
+ * =====================================================================
+ */
+
+
+#define _POSIX_C_SOURCE 200809L
+
+#define DU_BASE64
+#define DU_HASH
+#define DU_VECTOR
+#define DU_DICT
+#define DU_ARGS
+#define DU_STRINGS
+#define DU_TUI
+#define DU_POOL
+#define DU_IO
+#define DU_RING
+#define DU_IMPLEMENTATION
+#include "../deltautils.h"
+
+#include <fcntl.h>
+#include <pthread.h>
+
+
+#ifndef BENCH_COMMIT
+#define BENCH_COMMIT "unknown"
+#endif
+#ifndef BENCH_CFLAGS
+#define BENCH_CFLAGS ""
+#endif
+
+#define BENCH_LOG_LINES  4096  // Lines in the generated log corpus
+#define BENCH_IO_LINES 200000  // Lines in the generated log file
+#define BENCH_RING_OPS (1u << 20)  // Records per ring round
+#define BENCH_PERIODIC_LEN (8u << 20)  // Haystack for str/count_periodic
+#define BENCH_TUI_W       200  // Dashboard size for the TUI benchmarks
+#define BENCH_TUI_H        60
+
+// One round of a benchmark: performs the ops being measured
+typedef void (*BenchBody)(void *ctx);
+
+typedef struct {
+    const char *filter;    // Only run names containing this (NULL = all)
+    double      min_ns;    // Minimum measuring time per benchmark
+    FILE       *json;      // JSON destination, NULL for none
+    bool        table;     // Print the human-readable table
+    size_t      results;   // Results written so far
+} BenchConfig;
+
+static BenchConfig __bench;
+
+/* ---------------------------------------------------------------------
+ * Harness
+ * --------------------------------------------------------------------- */
+
+static uint64_t __bench_allocs = 0;  // alloc + realloc calls into the library's allocator
+
+static void *__benchAlloc(void *ctx, size_t size) {
+    (void)ctx;
+    __bench_allocs++;
+    return malloc(size);
+}
+
+static void *__benchRealloc(void *ctx, void *ptr, size_t size) {
+    (void)ctx;
+    __bench_allocs++;
+    return realloc(ptr, size);
+}
+
+static void __benchFree(void *ctx, void *ptr) {
+    (void)ctx;
+    free(ptr);
+}
+
+static const DuAllocator __bench_allocator = { __benchAlloc, __benchRealloc, __benchFree, NULL };
+
+static double __benchNow(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+static uint64_t __bench_rng = 0x9E3779B97F4A7C15ull;
+
+static uint64_t __benchRand(void) {
+    __bench_rng ^= __bench_rng << 13;
+    __bench_rng ^= __bench_rng >> 7;
+    __bench_rng ^= __bench_rng << 17;
+    return __bench_rng;
+}
+
+static bool __benchSelected(const char *name) {
+    return !__bench.filter || strstr(name, __bench.filter) != NULL;
+}
+
+static void __benchReport(const char *name, size_t param, double ns_per_op,
+                          double bytes_per_op, double allocs_per_op) {
+    double gbps = bytes_per_op > 0 ? bytes_per_op / ns_per_op : 0;
+
+    if (__bench.table) {
+        printf("  %-24s %10zu | %12.2f ns/op", name, param, ns_per_op);
+        if (gbps > 0) printf(" | %7.2f GB/s", gbps);
+        else printf(" |            ");
+        printf(" | %8.3f allocs/op\n", allocs_per_op);
+    }
+
+    if (__bench.json) {
+        fprintf(__bench.json, "%s\n    { \"name\": \"%s\", \"param\": %zu, \"ns_per_op\": %.4f, "
+                "\"gb_per_s\": %.4f, \"allocs_per_op\": %.4f }",
+                __bench.results ? "," : "", name, param, ns_per_op, gbps, allocs_per_op);
+    }
+    __bench.results++;
+}
+
+// Runs 'body' (each call doing 'ops' ops over 'bytes' bytes) until
+// __bench.min_ns has passed, after one warm-up round. A warm-up round that
+// already takes that long is reported as is, so huge sizes run only once.
+static void __benchMeasure(const char *name, size_t param, size_t ops, size_t bytes,
+                           BenchBody body, void *ctx) {
+    if (!__benchSelected(name)) return;
+
+    uint64_t a0 = __bench_allocs;
+    double t0 = __benchNow();
+    body(ctx);
+    double elapsed = __benchNow() - t0;
+    size_t rounds = 1;
+
+    if (elapsed < __bench.min_ns) {
+        a0 = __bench_allocs;
+        t0 = __benchNow();
+        rounds = 0;
+        do {
+            body(ctx);
+            rounds++;
+            elapsed = __benchNow() - t0;
+        } while (elapsed < __bench.min_ns);
+    }
+
+    double total_ops = (double)ops * rounds;
+    __benchReport(name, param, elapsed / total_ops, (double)bytes / ops,
+                  (double)(__bench_allocs - a0) / total_ops);
+}
+
+/* ---------------------------------------------------------------------
+ * DU_DICT
+ * --------------------------------------------------------------------- */
+
+#define BENCH_KEY_LEN 16
+
+typedef struct {
+    char       *keys;    // n keys of BENCH_KEY_LEN bytes
+    char       *misses;  // n keys never inserted
+    size_t      n;
+    Dictionary *dict;    // Filled dictionary for lookups
+} DictCtx;
+
+static void __benchDictInsert(void *p) {
+    DictCtx *c = p;
+    Dictionary *d = dictNew(DU_NBUCKET_SMALL, NULL, NULL);
+    for (size_t i = 0; i < c->n; i++) dictSet(d, c->keys + i * BENCH_KEY_LEN, BENCH_KEY_LEN, c);
+    dictFree(d);
+}
+
+static void __benchDictLookup(void *p) {
+    DictCtx *c = p;
+    size_t hits = 0;
+    for (size_t i = 0; i < c->n; i++) hits += dictGet(c->dict, c->keys + i * BENCH_KEY_LEN, BENCH_KEY_LEN) != NULL;
+    if (hits != c->n) fprintf(stderr, "dict lookup: %zu of %zu hits\n", hits, c->n);
+}
+
+static void __benchDictMiss(void *p) {
+    DictCtx *c = p;
+    size_t hits = 0;
+    for (size_t i = 0; i < c->n; i++) hits += dictGet(c->dict, c->misses + i * BENCH_KEY_LEN, BENCH_KEY_LEN) != NULL;
+    if (hits) fprintf(stderr, "dict miss: %zu unexpected hits\n", hits);
+}
+
+static void __benchDict(size_t max_keys) {
+    for (size_t n = 1000; n <= max_keys; n *= 10) {
+        DictCtx c = { malloc(n * BENCH_KEY_LEN), malloc(n * BENCH_KEY_LEN), n, NULL };
+        if (!c.keys || !c.misses) {
+            fprintf(stderr, "dict: cannot allocate %zu keys\n", n);
+            free(c.keys);
+            free(c.misses);
+            return;
+        }
+
+        for (size_t i = 0; i < n; i++) {
+            snprintf(c.keys + i * BENCH_KEY_LEN, BENCH_KEY_LEN, "user:%010u", (unsigned)i);
+            snprintf(c.misses + i * BENCH_KEY_LEN, BENCH_KEY_LEN, "miss:%010u", (unsigned)i);
+        }
+
+        __benchMeasure("dict/insert", n, n, 0, __benchDictInsert, &c);
+
+        // Keys whose first wyhash words cancel the secret, which collided
+        // in every dictionary while the seed was only applied afterwards.
+        // Should run at the same speed as dict/insert.
+        if (__benchSelected("dict/insert_crafted")) {
+            DictCtx k = { malloc(n * BENCH_KEY_LEN), NULL, n, NULL };
+            if (k.keys) {
+                for (size_t i = 0; i < n; i++) {
+                    uint32_t w[4] = { 0x8bb84b93u, (uint32_t)i, 0x962eacc9u, (uint32_t)(i * 0x9E3779B9u) };
+                    memcpy(k.keys + i * BENCH_KEY_LEN, w, BENCH_KEY_LEN);
+                }
+                __benchMeasure("dict/insert_crafted", n, n, 0, __benchDictInsert, &k);
+                free(k.keys);
+            }
+        }
+
+        if (__benchSelected("dict/lookup")) {
+            c.dict = dictNew(DU_NBUCKET_SMALL, NULL, NULL);
+            for (size_t i = 0; i < n; i++) dictSet(c.dict, c.keys + i * BENCH_KEY_LEN, BENCH_KEY_LEN, &c);
+            __benchMeasure("dict/lookup_hit", n, n, 0, __benchDictLookup, &c);
+            __benchMeasure("dict/lookup_miss", n, n, 0, __benchDictMiss, &c);
+            dictFree(c.dict);
+        }
+
+        free(c.keys);
+        free(c.misses);
+    }
+}
+
+/* ---------------------------------------------------------------------
+ * DU_VECTOR
+ * --------------------------------------------------------------------- */
+
+typedef struct {
+    size_t    n;
+    uint64_t *src;  // n values for extend
+} VecCtx;
+
+static void __benchVecPush(void *p) {
+    VecCtx *c = p;
+    Vector *v = vecNew(sizeof(uint64_t), 0, false);
+    for (uint64_t i = 0; i < c->n; i++) vecPush(v, &i);
+    vecFree(v, false);
+}
+
+static void __benchVecPushInline(void *p) {
+    VecCtx *c = p;
+    for (size_t r = 0; r < c->n / 4; r++) {
+        Vector v;
+        vecInit(&v, sizeof(uint64_t), 0, false);
+        for (uint64_t i = 0; i < 4; i++) vecPush(&v, &i);
+        vecFree(&v, false);
+    }
+}
+
+static void __benchVecExtend(void *p) {
+    VecCtx *c = p;
+    Vector *v = vecNew(sizeof(uint64_t), 0, false);
+    for (size_t i = 0; i < c->n; i += 64) vecExtend(v, c->src + i, c->n - i < 64 ? c->n - i : 64);
+    vecFree(v, false);
+}
+
+static void __benchVecSort(void *p) {
+    VecCtx *c = p;
+    Vector *v = vecNew(sizeof(uint64_t), c->n, false);
+    vecExtend(v, c->src, c->n);
+    vecSortU64(v);
+    vecFree(v, false);
+}
+
+static void __benchVector(void) {
+    for (size_t n = 1000; n <= 1000000; n *= 10) {
+        VecCtx c = { n, malloc(n * sizeof(uint64_t)) };
+        if (!c.src) return;
+        for (size_t i = 0; i < n; i++) c.src[i] = __benchRand();
+
+        __benchMeasure("vec/push", n, n, 0, __benchVecPush, &c);
+        __benchMeasure("vec/push_inline4", n, n, 0, __benchVecPushInline, &c);
+        __benchMeasure("vec/extend64", n, n, 0, __benchVecExtend, &c);
+        __benchMeasure("vec/sort_u64", n, n, n * sizeof(uint64_t), __benchVecSort, &c);
+        free(c.src);
+    }
+}
+
+/* ---------------------------------------------------------------------
+ * DU_BASE64 and DU_HASH
+ * --------------------------------------------------------------------- */
+
+typedef struct {
+    uint8_t *raw;
+    char    *enc;
+    uint8_t *dec;
+    size_t   size;
+    size_t   enc_len;
+} BytesCtx;
+
+static void __benchB64Encode(void *p) {
+    BytesCtx *c = p;
+    c->enc_len = b64Encode(c->raw, c->size, c->enc);
+}
+
+static void __benchB64Decode(void *p) {
+    BytesCtx *c = p;
+    b64Decode(c->enc, c->enc_len, c->dec);
+}
+
+static void __benchMd5(void *p) {
+    BytesCtx *c = p;
+    md5Digest(c->raw, c->size, c->dec);
+}
+
+static void __benchHash64(void *p) {
+    BytesCtx *c = p;
+    c->enc_len ^= (size_t)hash64(c->raw, c->size, 0);
+}
+
+static void __benchSha256(void *p) {
+    BytesCtx *c = p;
+    sha256Digest(c->raw, c->size, c->dec);
+}
+
+static void __benchBytes(void) {
+    static const size_t sizes[] = { 64, 1024, 64 << 10, 1 << 20, 16 << 20 };
+    size_t max = 16 << 20;
+
+    BytesCtx c = { malloc(max), malloc(b64EncodedLen(max)), malloc(max), 0, 0 };
+    if (!c.raw || !c.enc || !c.dec) goto done;
+    for (size_t i = 0; i < max; i++) c.raw[i] = (uint8_t)__benchRand();
+
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        c.size = sizes[i];
+        __benchMeasure("base64/encode", c.size, 1, c.size, __benchB64Encode, &c);
+        c.enc_len = b64Encode(c.raw, c.size, c.enc);
+        __benchMeasure("base64/decode", c.size, 1, c.size, __benchB64Decode, &c);
+        __benchMeasure("hash/md5", c.size, 1, c.size, __benchMd5, &c);
+        __benchMeasure("hash/hash64", c.size, 1, c.size, __benchHash64, &c);
+        __benchMeasure("hash/sha256", c.size, 1, c.size, __benchSha256, &c);
+    }
+
+done:
+    free(c.raw);
+    free(c.enc);
+    free(c.dec);
+}
+
+/* ---------------------------------------------------------------------
+ * DU_STRINGS
+ * --------------------------------------------------------------------- */
+
+typedef struct {
+    char   *lines[BENCH_LOG_LINES];
+    Vector *split[BENCH_LOG_LINES];  // Tokens of each line, for join
+    size_t  bytes;                   // Total bytes in 'lines'
+} LogCtx;
+
+static void __benchStrSplit(void *p) {
+    LogCtx *c = p;
+    for (size_t i = 0; i < BENCH_LOG_LINES; i++) {
+        Vector *parts = strSplit(c->lines[i], ' ');
+        for (size_t j = 0; j < parts->length; j++) duFree(*(char **)vecAt(parts, j));
+        vecFree(parts, false);
+    }
+}
+
+static void __benchStrSplitView(void *p) {
+    LogCtx *c = p;
+    Vector parts;
+    vecInit(&parts, sizeof(StrView), 32, false);
+    for (size_t i = 0; i < BENCH_LOG_LINES; i++) {
+        parts.length = 0;
+        strSplitView(strView(c->lines[i]), ' ', &parts);
+    }
+    vecFree(&parts, false);
+}
+
+static void __benchStrReplace(void *p) {
+    LogCtx *c = p;
+    for (size_t i = 0; i < BENCH_LOG_LINES; i++) duFree(strReplace(c->lines[i], "status=", "http_status="));
+}
+
+static void __benchStrJoin(void *p) {
+    LogCtx *c = p;
+    for (size_t i = 0; i < BENCH_LOG_LINES; i++) duFree(strJoin(c->split[i], "\t"));
+}
+
+static void __benchStrCount(void *p) {
+    LogCtx *c = p;
+    size_t n = 0;
+    for (size_t i = 0; i < BENCH_LOG_LINES; i++) n += strCount(c->lines[i], "latency");
+    if (n != BENCH_LOG_LINES) fprintf(stderr, "strCount: %zu matches\n", n);
+}
+
+// A run of 'a' searched for "aa...abaa", which makes first/last-byte and
+// Horspool filters check nearly every position
+typedef struct {
+    char  *hay;
+    char  *needle;
+    size_t len;
+} PeriodicCtx;
+
+static void __benchStrCountPeriodic(void *p) {
+    PeriodicCtx *c = p;
+    size_t n = strCount(c->hay, c->needle);
+    if (n) fprintf(stderr, "strCount periodic: %zu matches\n", n);
+}
+
+static void __benchStrPeriodic(void) {
+    static const size_t needles[] = { 8, 1000, 64000 };
+    PeriodicCtx c = { malloc(BENCH_PERIODIC_LEN + 1), NULL, BENCH_PERIODIC_LEN };
+    if (!c.hay) return;
+    memset(c.hay, 'a', BENCH_PERIODIC_LEN);
+    c.hay[BENCH_PERIODIC_LEN] = '\0';
+
+    for (size_t i = 0; i < sizeof(needles) / sizeof(needles[0]); i++) {
+        size_t m = needles[i];
+        c.needle = malloc(m + 1);
+        if (!c.needle) break;
+        memset(c.needle, 'a', m);
+        c.needle[m - 3] = 'b';
+        c.needle[m] = '\0';
+        __benchMeasure("str/count_periodic", m, 1, c.len, __benchStrCountPeriodic, &c);
+        free(c.needle);
+    }
+    free(c.hay);
+}
+
+// Writes one random access-log line (without newline) and returns its length
+static size_t __benchLogLine(char line[256]) {
+    static const char *levels[] = { "INFO", "WARN", "DEBUG", "ERROR" };
+    static const char *paths[] = { "/api/v1/users", "/api/v1/orders/search", "/healthz", "/static/app.js" };
+
+    uint64_t r = __benchRand();
+    int len = snprintf(line, 256,
+            "2026-10-14T12:%02u:%02u.%03uZ %s [worker-%u] req=%016llx method=GET path=%s "
+            "status=%u latency_ms=%u bytes=%u",
+            (unsigned)(r % 60), (unsigned)(r >> 8) % 60, (unsigned)(r >> 16) % 1000,
+            levels[r >> 30 & 3], (unsigned)(r >> 32) % 16, (unsigned long long)__benchRand(),
+            paths[r >> 40 & 3], r >> 44 & 1 ? 200u : 404u, (unsigned)(r >> 48) % 900,
+            (unsigned)(r >> 20) % 65536);
+    return (size_t)len;
+}
+
+static void __benchStrings(void) {
+    LogCtx *c = calloc(1, sizeof(LogCtx));
+    if (!c) return;
+
+    for (size_t i = 0; i < BENCH_LOG_LINES; i++) {
+        char line[256];
+        size_t len = __benchLogLine(line);
+        c->lines[i] = strDup(line);
+        c->split[i] = strSplit(line, ' ');
+        c->bytes += len;
+    }
+
+    __benchMeasure("str/split", BENCH_LOG_LINES, BENCH_LOG_LINES, c->bytes, __benchStrSplit, c);
+    __benchMeasure("str/split_view", BENCH_LOG_LINES, BENCH_LOG_LINES, c->bytes, __benchStrSplitView, c);
+    __benchMeasure("str/replace", BENCH_LOG_LINES, BENCH_LOG_LINES, c->bytes, __benchStrReplace, c);
+    __benchMeasure("str/join", BENCH_LOG_LINES, BENCH_LOG_LINES, c->bytes, __benchStrJoin, c);
+    __benchMeasure("str/count", BENCH_LOG_LINES, BENCH_LOG_LINES, c->bytes, __benchStrCount, c);
+    if (__benchSelected("str/count_periodic")) __benchStrPeriodic();
+
+    for (size_t i = 0; i < BENCH_LOG_LINES; i++) {
+        duFree(c->lines[i]);
+        for (size_t j = 0; j < c->split[i]->length; j++) duFree(*(char **)vecAt(c->split[i], j));
+        vecFree(c->split[i], false);
+    }
+    free(c);
+}
+
+/* ---------------------------------------------------------------------
+ * DU_IO
+ * --------------------------------------------------------------------- */
+
+typedef struct {
+    const char *path;    // Generated log file
+    Vector     *fields;  // Reused by ioSplitFields
+    size_t      lines;   // Lines seen by the last round
+} IoCtx;
+
+// What the code did before DU_IO: fgets, strDup, strSplit
+static void __benchIoFgets(void *p) {
+    IoCtx *c = p;
+    FILE *f = fopen(c->path, "r");
+    if (!f) return;
+
+    char line[512];
+    c->lines = 0;
+    while (fgets(line, sizeof(line), f)) {
+        char *copy = strDup(line);
+        Vector *parts = strSplit(copy, ' ');
+        for (size_t j = 0; j < parts->length; j++) duFree(*(char **)vecAt(parts, j));
+        vecFree(parts, false);
+        duFree(copy);
+        c->lines++;
+    }
+    fclose(f);
+}
+
+static void __benchIoReadLine(void *p) {
+    IoCtx *c = p;
+    IoReader r;
+    StrView line;
+    if (!ioOpen(&r, c->path)) return;
+
+    c->lines = 0;
+    while (ioReadLine(&r, &line)) c->lines++;
+    ioClose(&r);
+}
+
+static void __benchIoFields(void *p) {
+    IoCtx *c = p;
+    IoReader r;
+    StrView line;
+    if (!ioOpen(&r, c->path)) return;
+
+    c->lines = 0;
+    while (ioReadLine(&r, &line)) {
+        ioSplitFields(line, ' ', c->fields);
+        c->lines++;
+    }
+    ioClose(&r);
+}
+
+static void __benchIoChunk(void *ctx, size_t chunk, StrView lines) {
+    (void)chunk;
+    IoLines it;
+    StrView line;
+    size_t n = 0;
+    ioLinesInit(&it, lines);
+    while (ioLinesNext(&it, &line)) n++;
+    __atomic_fetch_add((size_t *)ctx, n, __ATOMIC_RELAXED);
+}
+
+static void __benchIoParallel(void *p) {
+    IoCtx *c = p;
+    IoReader r;
+    if (!ioOpen(&r, c->path)) return;
+
+    c->lines = 0;
+    ioParallel(NULL, &r, 0, __benchIoChunk, &c->lines);
+    ioClose(&r);
+}
+
+static void __benchIo(void) {
+    char path[] = "/tmp/bench_suite_XXXXXX";
+    int fd = mkstemp(path);
+    if (fd < 0) return;
+
+    FILE *f = fdopen(fd, "w");
+    size_t bytes = 0;
+    for (size_t i = 0; f && i < BENCH_IO_LINES; i++) {
+        char line[256];
+        size_t len = __benchLogLine(line);
+        line[len++] = '\n';
+        bytes += fwrite(line, 1, len, f);
+    }
+    if (f) fclose(f);
+    else close(fd);
+
+    IoCtx c = { path, vecNew(sizeof(StrView), 16, false), 0 };
+    if (bytes && c.fields) {
+        __benchMeasure("io/fgets_strdup_split", BENCH_IO_LINES, BENCH_IO_LINES, bytes, __benchIoFgets, &c);
+        __benchMeasure("io/readline", BENCH_IO_LINES, BENCH_IO_LINES, bytes, __benchIoReadLine, &c);
+        __benchMeasure("io/readline_fields", BENCH_IO_LINES, BENCH_IO_LINES, bytes, __benchIoFields, &c);
+        __benchMeasure("io/parallel_lines", BENCH_IO_LINES, BENCH_IO_LINES, bytes, __benchIoParallel, &c);
+    }
+
+    vecFree(c.fields, false);
+    unlink(path);
+}
+
+/* ---------------------------------------------------------------------
+ * DU_RING
+ * --------------------------------------------------------------------- */
+
+typedef struct {
+    uint64_t seq;
+    uint64_t payload[3];
+} RingRec;  // 32-byte record
+
+typedef struct {
+    Ring           *ring;
+    size_t          batch;
+    Vector         *vec;    // Baseline: Vector behind a mutex
+    pthread_mutex_t lock;
+} RingCtx;
+
+// Push a batch, pop it back, on one thread: the cost of the handoff itself
+static void __benchRingLocal(void *p) {
+    RingCtx *c = p;
+    RingRec recs[64] = {{0}};
+    for (size_t i = 0; i < BENCH_RING_OPS; i += c->batch) {
+        recs[0].seq = i;
+        if (c->batch == 1) {
+            ringTryPush(c->ring, recs);
+            ringTryPop(c->ring, recs);
+        } else {
+            ringTryPushN(c->ring, recs, c->batch);
+            ringTryPopN(c->ring, recs, c->batch);
+        }
+    }
+}
+
+static void __benchRingMutexVec(void *p) {
+    RingCtx *c = p;
+    RingRec rec = {0};
+    for (size_t i = 0; i < BENCH_RING_OPS; i++) {
+        rec.seq = i;
+        pthread_mutex_lock(&c->lock);
+        vecPush(c->vec, &rec);
+        pthread_mutex_unlock(&c->lock);
+
+        pthread_mutex_lock(&c->lock);
+        memcpy(&rec, vecPop(c->vec), sizeof(rec));
+        pthread_mutex_unlock(&c->lock);
+    }
+}
+
+static void *__benchRingProducer(void *p) {
+    RingCtx *c = p;
+    RingRec recs[64] = {{0}};
+    for (size_t i = 0; i < BENCH_RING_OPS; i += c->batch) {
+        recs[0].seq = i;
+        ringPushN(c->ring, recs, c->batch);
+    }
+    return NULL;
+}
+
+// Producer thread to the calling thread
+static void __benchRingThreads(void *p) {
+    RingCtx *c = p;
+    RingRec recs[64];
+    pthread_t t;
+    if (pthread_create(&t, NULL, __benchRingProducer, c) != 0) return;
+    for (size_t i = 0; i < BENCH_RING_OPS; i += c->batch) ringPopN(c->ring, recs, c->batch);
+    pthread_join(t, NULL);
+}
+
+static void __benchRing(void) {
+    static const struct { const char *local, *threads; uint32_t flags; size_t batch; } cases[] = {
+        { "ring/spsc_local",       "ring/spsc_threads",       DU_RING_SPSC,  1 },
+        { "ring/spsc_local_batch", "ring/spsc_threads_batch", DU_RING_SPSC, 32 },
+        { "ring/mpmc_local",       "ring/mpmc_threads",       DU_RING_MPMC,  1 },
+        { "ring/mpmc_local_batch", "ring/mpmc_threads_batch", DU_RING_MPMC, 32 },
+    };
+
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        RingCtx c = { ringNew(sizeof(RingRec), 1024, cases[i].flags), cases[i].batch, NULL,
+                      PTHREAD_MUTEX_INITIALIZER };
+        if (!c.ring) return;
+        __benchMeasure(cases[i].local, c.batch, BENCH_RING_OPS, 0, __benchRingLocal, &c);
+        __benchMeasure(cases[i].threads, c.batch, BENCH_RING_OPS, 0, __benchRingThreads, &c);
+        ringFree(c.ring);
+    }
+
+    RingCtx c = { NULL, 1, vecNew(sizeof(RingRec), 1024, false), PTHREAD_MUTEX_INITIALIZER };
+    if (c.vec) __benchMeasure("ring/mutex_vector_local", 1, BENCH_RING_OPS, 0, __benchRingMutexVec, &c);
+    vecFree(c.vec, false);
+}
+
+/* ---------------------------------------------------------------------
+ * DU_TUI
+ * --------------------------------------------------------------------- */
+
+typedef struct {
+    TuiFrame   frame;
+    TuiScreen *screen;
+    int        fd;     // /dev/null
+    size_t     bytes;  // Bytes flushed by the last round
+    uint32_t   tick;
+} TuiCtx;
+
+static const char *__bench_fg[] = { DU_TUI_FG_GREEN, DU_TUI_FG_YELLOW, DU_TUI_FG_RED, DU_TUI_FG_CYAN };
+
+// Redraws every cell through the escape-sequence API
+static void __benchTuiFull(void *p) {
+    TuiCtx *c = p;
+    tuiFrameBegin(&c->frame, c->fd);
+    for (uint16_t y = 1; y <= BENCH_TUI_H; y++) {
+        tuiCursorPos(1, y);
+        for (uint16_t x = 0; x < BENCH_TUI_W; x += 10) {
+            tuiSetColor(__bench_fg[(x + y + c->tick) & 3], NULL);
+            tuiWrite("|  42.0% ", 9);
+            tuiWrite(" ", 1);
+        }
+    }
+    tuiReset();
+    c->bytes = c->frame.len;
+    tuiFlush();
+    c->tick++;
+}
+
+// Changes 2% of a TuiScreen per frame and presents the difference
+static void __benchTuiDiff(void *p) {
+    TuiCtx *c = p;
+    size_t changes = BENCH_TUI_W * BENCH_TUI_H / 50;
+    for (size_t i = 0; i < changes; i++) {
+        uint64_t r = __benchRand();
+        tuiScreenSet(c->screen, (uint16_t)(r % BENCH_TUI_W), (uint16_t)((r >> 16) % BENCH_TUI_H),
+                     '0' + (uint32_t)(r >> 32) % 10, (uint16_t)((r >> 40) % 8), DU_TUI_COLOR_DEFAULT, 0);
+    }
+
+    tuiFrameBegin(&c->frame, c->fd);
+    tuiScreenPresent(c->screen);
+    c->bytes = c->frame.len;
+    tuiFlush();
+}
+
+static void __benchTui(void) {
+    TuiCtx c = { { NULL, 0, 0, -1 }, tuiScreenNew(BENCH_TUI_W, BENCH_TUI_H), open("/dev/null", O_WRONLY), 0, 0 };
+    if (c.fd < 0 || !c.screen) goto done;
+
+    __benchTuiFull(&c);
+    __benchMeasure("tui/frame_full", BENCH_TUI_W * BENCH_TUI_H, 1, c.bytes, __benchTuiFull, &c);
+
+    __benchTuiDiff(&c);  // First present draws everything
+    __benchTuiDiff(&c);
+    __benchMeasure("tui/screen_diff_2pct", BENCH_TUI_W * BENCH_TUI_H, 1, c.bytes, __benchTuiDiff, &c);
+
+done:
+    tuiFrameEnd();
+    tuiScreenFree(c.screen);
+    if (c.fd >= 0) close(c.fd);
+}
+
+/* ---------------------------------------------------------------------
+ * Main
+ * --------------------------------------------------------------------- */
+
+int main(int argc, char **argv) {
+    bool json = false, quick = false;
+    int max_keys = 10000000;
+    double min_ms = 200;
+    char *output = NULL, *filter = NULL;
+
+    ArgSpec spec[] = {
+        ARG_BOOL  ("j", "json",     &json,     "Print JSON on stdout instead of the table", false),
+        ARG_STRING("o", "output",   &output,   "Also write the JSON results to this file", false),
+        ARG_STRING("f", "filter",   &filter,   "Only run benchmarks whose name contains this", false),
+        ARG_INT   ("k", "max-keys", &max_keys, "Largest dictionary size (default 10000000)", false),
+        ARG_DOUBLE("t", "min-ms",   &min_ms,   "Minimum time per benchmark in ms (default 200)", false),
+        ARG_BOOL  ("q", "quick",    &quick,    "Short run: 20 ms per benchmark, up to 100K keys", false),
+        ARG_END()
+    };
+    if (argc > 1 && !parseArgs(spec, argc, argv)) {
+        printHelp(argv[0], spec);
+        return 1;
+    }
+    if (quick) {
+        min_ms = 20;
+        if (max_keys > 100000) max_keys = 100000;
+    }
+
+    __bench.filter = filter;
+    __bench.min_ns = min_ms * 1e6;
+    __bench.table = !json;
+    __bench.json = json ? stdout : NULL;
+    if (output) {
+        __bench.json = fopen(output, "w");
+        if (!__bench.json) {
+            fprintf(stderr, "Error: cannot open %s\n", output);
+            return 1;
+        }
+    }
+
+    duSetAllocator(&__bench_allocator);
+
+    if (__bench.json) {
+        char stamp[32];
+        time_t now = time(NULL);
+        strftime(stamp, sizeof(stamp), "%Y-%m-%dT%H:%M:%SZ", gmtime(&now));
+        fprintf(__bench.json, "{\n  \"suite\": \"deltautils\",\n  \"commit\": \"%s\",\n"
+                "  \"timestamp\": \"%s\",\n  \"compiler\": \"%s\",\n  \"cflags\": \"%s\",\n"
+                "  \"min_ms\": %.1f,\n  \"results\": [",
+                BENCH_COMMIT, stamp, __VERSION__, BENCH_CFLAGS, min_ms);
+    }
+    if (__bench.table) {
+        printf("  %-24s %10s | %15s | %12s | %17s\n", "benchmark", "param", "time", "throughput", "allocations");
+    }
+
+    __benchDict((size_t)max_keys);
+    __benchVector();
+    __benchBytes();
+    __benchStrings();
+    __benchIo();
+    __benchRing();
+    __benchTui();
+
+    if (__bench.json) {
+        fprintf(__bench.json, "\n  ]\n}\n");
+        if (__bench.json != stdout) fclose(__bench.json);
+    }
+    if (__bench.table && output) printf("\nWrote %zu results to %s\n", __bench.results, output);
+    return 0;
+}
@@ -45,6 +45,15 @@
  * -   DU_ARGS    | CLI argument handling
  * -   DU_STRINGS | Expanded string operations
  * -   DU_TUI     | Terminal UI functionality
+ * -   DU_POOL    | Thread pool and parallel loops
+ * -   DU_ARENA   | Region (bump) allocation
+ * -   DU_IO      | Memory-mapped line reading
+ * -   DU_RING    | Bounded ring buffers (SPSC / MPMC)
+ * 
+ * BUILD OPTIONS:
+ *
+ * -   DU_STATS           | Hot-path counters and dictStats (nothing when undefined)
+ * -   DU_DICT_CHECK_HASH | Assert that hashes given to dict*Hashed are right
  * 
  * =====================================================================
  */
@@ -67,6 +76,7 @@ extern "C" {
 #include <stdio.h>
 #include <ctype.h>
 #include <stdbool.h>
+#include <time.h>
 
 
 /* =====================================================================
@@ -77,1746 +87,8997 @@ extern "C" {
  */
 
 
-#ifdef DU_BASE64
-#ifndef DU_BASE64_H
-#define DU_BASE64_H
+#ifndef DU_ALLOC_H
+#define DU_ALLOC_H
 /* =====================================================================
  *
- * BASE64 ENCODING AND DECODING
+ * MEMORY ALLOCATION
  *
  * =====================================================================
  */
 
+// Every allocation the library makes goes through a DuAllocator.
+// The default one calls DU_MALLOC/DU_REALLOC/DU_FREE, which are the C
+// library functions unless all three are defined before including this
+// header (in every file that includes it).
+#if defined(DU_MALLOC) && defined(DU_REALLOC) && defined(DU_FREE)
+// Compile-time override in use
+#elif !defined(DU_MALLOC) && !defined(DU_REALLOC) && !defined(DU_FREE)
+#define DU_MALLOC(size)       malloc(size)
+#define DU_REALLOC(ptr, size) realloc(ptr, size)
+#define DU_FREE(ptr)          free(ptr)
+#else
+#error "DU_MALLOC, DU_REALLOC and DU_FREE must be defined together"
+#endif
+
+// Runtime allocator. All three functions are required and receive 'ctx'.
+// They follow malloc/realloc/free semantics (realloc of NULL allocates).
+typedef struct {
+    void *(*alloc)  (void *ctx, size_t size);
+    void *(*realloc)(void *ctx, void *ptr, size_t size);
+    void  (*free)   (void *ctx, void *ptr);
+    void   *ctx;
+} DuAllocator;
 
 /**
- * b64Encode:
- *   Encodes binary data into Base64.
+ * duSetAllocator:
+ *   Sets the global allocator used by every routine without an allocator
+ *   of its own. Objects remember the allocator they were created with, so
+ *   set it before creating any, and keep 'alloc' alive while it is in use.
+ *   Not thread-safe; meant to be called once at startup.
  *
  * Parameters:
- *   in  - pointer to input byte array
- *   len - length of input in bytes
- *   out - output buffer (must be large enough to hold encoded string)
- *
- * Returns:
- *   Number of bytes written to 'out'
+ *   alloc - allocator to use, or NULL for the default (DU_MALLOC & co.)
  */
-size_t b64Encode(uint8_t *in, size_t len, char *out);
+void duSetAllocator(const DuAllocator *alloc);
 
 /**
- * b64Decode:
- *   Decodes a Base64-encoded string into binary data.
- *
- * Parameters:
- *   in  - pointer to Base64 string
- *   len - length of input string
- *   out - output buffer for decoded bytes
+ * duGetAllocator:
+ *   Returns the current global allocator.
  *
  * Returns:
- *   Number of bytes written to 'out'
+ *   Pointer to the global allocator (never NULL)
  */
-size_t b64Decode(char *in, size_t len, uint8_t *out);
+const DuAllocator *duGetAllocator(void);
 
-#endif // DU_BASE64_H
-#endif // DU_BASE64
+/**
+ * duMalloc / duCalloc / duRealloc / duFree:
+ *   malloc-style calls on the global allocator. Strings and buffers the
+ *   library hands back (strDup, strReplace, sbDetach...) come from it, so
+ *   release them with duFree. With the default allocator plain free works.
+ */
+void *duMalloc(size_t size);
+void *duCalloc(size_t count, size_t size);
+void *duRealloc(void *ptr, size_t size);
+void  duFree(void *ptr);
 
+#endif // DU_ALLOC_H
 
-#ifdef DU_HASH
-#ifndef DU_HASH_H
-#define DU_HASH_H
+
+#ifdef DU_STATS
+#ifndef DU_STATS_H
+#define DU_STATS_H
 /* =====================================================================
  *
- * HASH UTILITIES
+ * STATISTICS
  *
  * =====================================================================
  */
 
+// Histogram buckets for probe / chain lengths: 1, 2, 3-4, 5-8, ..., 65+ slots
+#define DU_STATS_HIST 8
+
+// Library-wide counters, updated with relaxed atomics so they can be
+// bumped from pool threads. Byte counts are raw (unencoded) bytes.
+typedef struct {
+    uint64_t allocs;           // alloc calls made through any DuAllocator
+    uint64_t reallocs;         // realloc calls
+    uint64_t frees;            // free calls (NULL pointers excluded)
+    uint64_t alloc_bytes;      // Bytes requested by allocs and reallocs
+    uint64_t vec_grows;        // Vector buffer reallocations
+    uint64_t vec_bytes_copied; // Bytes moved by them (when the buffer moved)
+    uint64_t str_allocs;       // Allocations made for strings and builders
+    uint64_t str_bytes;        // Bytes requested by them
+    uint64_t b64_encoded;      // Bytes base64 encoded
+    uint64_t b64_decoded;      // Bytes produced by base64 decoding
+    uint64_t md5_bytes;        // Bytes fed to MD5
+    uint64_t sha256_bytes;     // Bytes fed to SHA-256
+    uint64_t dict_grows;       // Dictionary table doublings, all dictionaries
+    uint64_t dict_purges;      // Same-size rebuilds to drop tombstones
+} DuStats;
 
 /**
- * md5Digest:
- *   Computes the MD5 digest of a data block.
+ * duStatsSnapshot:
+ *   Copies the library-wide counters. Each counter is read atomically,
+ *   but the set is not one consistent instant while other threads run.
  *
  * Parameters:
- *   data - pointer to input data
- *   len  - length of input data in bytes
- *   out  - output buffer of 16 bytes to hold the MD5 digest
- *
- * Returns:
- *   void (result stored in `out`)
+ *   out - Receives the counters
  */
-void md5Digest(uint8_t *data, size_t len, uint8_t out[16]);
+void duStatsSnapshot(DuStats *out);
 
-#endif // DU_HASH_H
-#endif // DU_HASH
+/**
+ * duStatsReset:
+ *   Zeroes the library-wide counters.
+ */
+void duStatsReset(void);
 
+#endif // DU_STATS_H
+#endif // DU_STATS
 
-#ifdef DU_VECTOR
-#ifndef DU_VECTOR_H
-#define DU_VECTOR_H
+
+#ifdef DU_ARENA
+#ifndef DU_ARENA_H
+#define DU_ARENA_H
 /* =====================================================================
  *
- * VECTOR OPERATIONS
+ * ARENA ALLOCATION
  *
  * =====================================================================
  */
 
+// Default size of an arena block (larger requests get a block of their own)
+#ifndef DU_ARENA_BLOCK_SIZE
+#define DU_ARENA_BLOCK_SIZE (64 * 1024)
+#endif
+
+// Alignment of every arena allocation (a power of two)
+#ifndef DU_ARENA_ALIGN
+#define DU_ARENA_ALIGN 16
+#endif
+
+// A block of arena memory, data follows the header
+typedef struct arena_block_s {
+    struct arena_block_s *prev;  // Block filled before this one
+    size_t                used;  // Bytes handed out from this block
+    size_t                cap;   // Usable bytes in this block
+} ArenaBlock;
+
+// Bump allocator: memory is handed out from a chain of blocks and only
+// released all at once (arenaReset, arenaFree) or back to a mark (arenaRewind).
+// The arena embeds the DuAllocator returned by arenaAllocator, so it must
+// not be moved or copied once initialized.
+typedef struct {
+    ArenaBlock        *head;        // Block currently being filled
+    size_t             block_size;  // Size of new blocks
+    const DuAllocator *backing;     // Allocator the blocks come from
+    DuAllocator        iface;       // This arena as a DuAllocator
+} Arena;
+
+// Position in an arena to rewind to
+typedef struct {
+    ArenaBlock *block;  // Head block when the mark was taken
+    size_t      used;   // Its fill level at that time
+} ArenaMark;
+
 
 /**
- * Vector:
- *   Generic dynamic array structure, storing metadata about allocated
- *   capacity, element size, and current length.
+ * arenaInit:
+ *   Prepares an empty arena. Blocks come from the global allocator and
+ *   are only allocated on first use.
+ *
+ * Parameters:
+ *   arena      - arena to initialize
+ *   block_size - size of each block (0 = DU_ARENA_BLOCK_SIZE)
  */
-typedef struct vec_meta_s {
-    uint32_t  capacity;  // How many cells can the vector hold before resizing
-    uint32_t    length;  // The length of the vector
-    uint16_t cell_size;  // The size of each cell in bytes
-    void *        data;  // A pointer to the data stored in the vector
-} Vector;
+void arenaInit(Arena *arena, size_t block_size);
 
 /**
- * vecNew:
- *   Allocates and initializes a new vector.
+ * arenaAlloc:
+ *   Allocates 'size' bytes aligned to DU_ARENA_ALIGN.
  *
  * Parameters:
- *   cell_size    - Size of each element in bytes (must be > 0)
- *   capacity_opt - Initial capacity (0 = default of 4)
- *   do_clear     - Whether to zero-initialize allocated memory
+ *   arena - arena to allocate from
+ *   size  - number of bytes
  *
  * Returns:
- *   Pointer to the newly allocated vector, or NULL if allocation fails
+ *   Pointer to the memory (uninitialized), or NULL on allocation failure
  */
-Vector *vecNew(uint16_t cell_size, uint32_t capacity_opt, bool do_clear);
-
+void *arenaAlloc(Arena *arena, size_t size);
 
 /**
- * vecFree:
- *   Frees a vector and its internal data buffer.
+ * arenaCalloc:
+ *   Same as arenaAlloc, zeroing the memory.
  *
  * Parameters:
- *   vec        - Pointer to vector
- *   purge_data - If true, zeroes out the vector's internal data before freeing
+ *   arena - arena to allocate from
+ *   size  - number of bytes
+ *
+ * Returns:
+ *   Pointer to the zeroed memory, or NULL on allocation failure
  */
-void vecFree(Vector *vec, bool purge_data);
-
+void *arenaCalloc(Arena *arena, size_t size);
 
 /**
- * vecLength:
- *   Returns the number of elements currently stored in the vector.
+ * arenaRealloc:
+ *   Resizes an arena allocation. The most recent allocation grows or shrinks
+ *   in place while its block has room; anything else is copied.
  *
  * Parameters:
- *   vec - Vector pointer
+ *   arena    - arena 'ptr' came from
+ *   ptr      - allocation to resize (NULL to allocate)
+ *   old_size - current size of 'ptr'
+ *   new_size - requested size
  *
  * Returns:
- *   Current length of the vector
+ *   Pointer to the resized memory, or NULL on failure ('ptr' stays valid)
  */
-uint32_t vecLength(const Vector *vec);
-
+void *arenaRealloc(Arena *arena, void *ptr, size_t old_size, size_t new_size);
 
 /**
- * vecCellSize:
- *   Returns the size in bytes of each element in the vector.
+ * arenaMark:
+ *   Records the current position for a later arenaRewind.
  *
  * Parameters:
- *   vec - Vector pointer
+ *   arena - arena
  *
  * Returns:
- *   Size of one element in bytes
+ *   The current position
  */
-uint16_t vecCellSize(const Vector *vec);
-
+ArenaMark arenaMark(const Arena *arena);
 
 /**
- * vecCapacity:
- *   Returns the current allocated capacity of the vector.
+ * arenaRewind:
+ *   Releases everything allocated since 'mark' was taken. Marks taken
+ *   after it become invalid.
  *
  * Parameters:
- *   vec - Vector pointer
+ *   arena - arena
+ *   mark  - position from arenaMark
+ */
+void arenaRewind(Arena *arena, ArenaMark mark);
+
+/**
+ * arenaReset:
+ *   Releases every allocation at once. The first block is kept for reuse,
+ *   so an arena reset after each request settles into not allocating.
  *
- * Returns:
- *   Number of elements the vector can hold before resizing
+ * Parameters:
+ *   arena - arena to reset
  */
-uint32_t vecCapacity(const Vector *vec);
+void arenaReset(Arena *arena);
 
+/**
+ * arenaFree:
+ *   Returns all blocks to the backing allocator. The arena stays usable.
+ *
+ * Parameters:
+ *   arena - arena to free
+ */
+void arenaFree(Arena *arena);
 
 /**
- * vecSet:
- *   Sets the value of an element at a specific index.
+ * arenaAllocator:
+ *   Returns the arena as a DuAllocator, for vecNewWith, dictNewWith and
+ *   friends. Frees are ignored (except that freeing the most recent
+ *   allocation gives its space back), reallocs grow in place when they can.
  *
  * Parameters:
- *   vec - Vector pointer
- *   idx - Index of the element (must be < vecLength(vec))
- *   val - Pointer to the new value to store
+ *   arena - arena
+ *
+ * Returns:
+ *   Allocator valid as long as the arena
+ */
+const DuAllocator *arenaAllocator(Arena *arena);
+
+#endif // DU_ARENA_H
+#endif // DU_ARENA
+
+
+#ifdef DU_POOL
+#ifndef DU_POOL_H
+#define DU_POOL_H
+/* =====================================================================
+ *
+ * THREAD POOL
+ *
+ * =====================================================================
  */
-void vecSet(Vector *vec, uint32_t idx, const void *val);
 
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// In order to use this functionality you must define
+// DU_POOL and link with pthreads.
+// Under strict ISO modes also define _POSIX_C_SOURCE >= 200112L.
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+#include <pthread.h>
+
+#ifndef DU_CACHE_LINE
+#define DU_CACHE_LINE       64
+#endif
+
+// Largest pool the library creates on its own (poolDefault)
+#define DU_POOL_MAX_THREADS 256
+
+// Body of a parallel loop, called with a sub-range [begin, end) of items
+typedef void (*PoolTaskFn)(void *arg, size_t begin, size_t end);
+
+// Fixed set of worker threads. Each parallelFor hands every thread
+// (the caller included) an equal slice of the range; a thread that runs
+// out of work steals half of what is left in another thread's slice.
+typedef struct thread_pool_s ThreadPool;
 
 /**
- * vecAt:
- *   Returns a pointer to the element at the specified index.
+ * poolNew:
+ *   Starts a thread pool.
  *
  * Parameters:
- *   vec - Vector pointer
- *   idx - Index of the element (must be < vecLength(vec))
+ *   nthreads - Number of threads taking part in each loop, the calling
+ *              thread included (0 for one per online CPU).
  *
  * Returns:
- *   Pointer to the element inside the vector
+ *   Pointer to the new pool, or NULL on failure.
  */
-void *vecAt(Vector *vec, uint32_t idx);
+ThreadPool *poolNew(size_t nthreads);
 
 
 /**
- * vecPush:
- *   Appends a new element to the end of the vector, resizing if needed.
+ * poolDefault:
+ *   Returns a process-wide pool with one thread per online CPU,
+ *   started on first use. Passing NULL as a pool means this pool.
  *
- * Parameters:
- *   vec - Vector pointer
- *   val - Pointer to the value to append
+ * Returns:
+ *   Pointer to the shared pool, or NULL if it could not be started.
  */
-void vecPush(Vector *vec, const void *val);
+ThreadPool *poolDefault(void);
 
 
 /**
- * vecPop:
- *   Removes and returns the last element from the vector.
+ * poolThreads:
+ *   Returns the number of threads taking part in each loop.
  *
  * Parameters:
- *   vec - Vector pointer (must have at least 1 element)
+ *   pool - Target pool (NULL for poolDefault).
+ */
+size_t poolThreads(ThreadPool *pool);
+
+
+/**
+ * parallelFor:
+ *   Runs 'fn' over the items [begin, end) on all threads of the pool and
+ *   returns once every item is done. Each call covers a contiguous
+ *   sub-range of at least 'grain' items (except at the end), so 'grain'
+ *   should be large enough to amortize the call. Calls from inside a
+ *   running loop of the same pool run on the calling thread only.
  *
- * Returns:
- *   Pointer to the popped element inside the buffer.
- *   NOTE: This pointer becomes invalid if the vector is resized afterward.
+ * Parameters:
+ *   pool  - Target pool (NULL for poolDefault).
+ *   begin - First item.
+ *   end   - One past the last item.
+ *   grain - Smallest number of items handed out at once (0 for 1).
+ *   fn    - Loop body.
+ *   arg   - Passed to every call to 'fn'.
  */
-void *vecPop(Vector *vec);
+void parallelFor(ThreadPool *pool, size_t begin, size_t end, size_t grain,
+                 PoolTaskFn fn, void *arg);
 
 
 /**
- * vecReserve:
- *   Ensures the vector has at least 'new_capacity' slots allocated.
+ * poolFree:
+ *   Stops the pool's threads and frees it.
+ *   Must not be called while a loop is running on it.
  *
  * Parameters:
- *   vec          - Vector pointer
- *   new_capacity - Desired minimum capacity
- *   do_clear     - If true, zero-initializes newly allocated space
+ *   pool - Target pool (the default pool is never freed).
  */
-void vecReserve(Vector *vec, uint32_t new_capacity, bool do_clear);
+void poolFree(ThreadPool *pool);
 
-#endif // DU_VECTOR_H
-#endif // DU_VECTOR
+#endif // DU_POOL_H
+#endif // DU_POOL
 
 
-#ifdef DU_DICT
-#ifndef DU_DICT_H
-#define DU_DICT_H
+#ifdef DU_BASE64
+#ifndef DU_BASE64_H
+#define DU_BASE64_H
 /* =====================================================================
  *
- * HASHMAP OPERATIONS
+ * BASE64 ENCODING AND DECODING
  *
  * =====================================================================
  */
 
-#define DU_NBUCKET_SMALL    32
-#define DU_NBUCKET_MEDIUM  128
-#define DU_NBUCKET_BIG    1024
-#define DU_NBUCKET_LARGE  4096
-
-// A single entry in a dictionary bucket
-typedef struct entry_s {
-    void            *key;      // Pointer to the key
-    size_t           key_len;  // Length of the key in bytes
-    void            *val;      // Pointer to the value
-    struct entry_s  *next;     // Next entry in the bucket's linked list
-} DictEntry;
-
-// Hash table mapping arbitrary byte-sequence keys to values
-typedef struct dict_s {
-    DictEntry      **entries;  // Array of bucket pointers
-    uint32_t         size;     // Number of buckets
-    void           (*free_key)(void *); // Callback to free keys
-    void           (*free_val)(void *); // Callback to free values
-} Dictionary;
-
 
 /**
- * dictNew:
- *   Creates a new dictionary with a fixed-size bucket array
+ * b64Encode:
+ *   Encodes binary data into Base64.
  *
  * Parameters:
- *   size     - Number of buckets (use DU_NBUCKET_*)
- *   free_key - Callback to free keys when removed or replaced
- *   free_val - Callback to free values when removed or replaced
+ *   in  - pointer to input byte array
+ *   len - length of input in bytes
+ *   out - output buffer (must be large enough to hold encoded string)
  *
  * Returns:
- *   Pointer to a new Dictionary on success.
- *   NULL on allocation failure.
+ *   Number of bytes written to 'out'
  */
-Dictionary *dictNew(uint32_t size, void (*free_key)(void *), void (*free_val)(void *));
-
+size_t b64Encode(uint8_t *in, size_t len, char *out);
 
 /**
- * dictSet:
- *   Inserts or updates a key/value pair in the dictionary.
+ * b64Decode:
+ *   Decodes a Base64-encoded string into binary data.
  *
  * Parameters:
- *   dict    - Target dictionary.
- *   key     - Key pointer (will be copied as-is, not duplicated).
- *   key_len - Length of the key in bytes.
- *   val     - Value pointer.
+ *   in  - pointer to Base64 string
+ *   len - length of input string
+ *   out - output buffer for decoded bytes
+ *
+ * Returns:
+ *   Number of bytes written to 'out'
  */
-void dictSet(Dictionary *dict, void *key, size_t key_len, void *val);
-
+size_t b64Decode(char *in, size_t len, uint8_t *out);
 
 /**
- * dictGet:
- *   Retrieves a value by key.
+ * b64EncodedLen:
+ *   Computes the exact length b64Encode produces for an input.
  *
  * Parameters:
- *   dict    - Target dictionary.
- *   key     - Key pointer.
- *   key_len - Length of the key in bytes.
+ *   len - length of input in bytes
  *
  * Returns:
- *   Pointer to the stored value, or NULL if the key is not found.
+ *   Number of characters in the padded encoding of 'len' bytes
  */
-void *dictGet(Dictionary *dict, void *key, size_t key_len);
-
+size_t b64EncodedLen(size_t len);
 
 /**
- * dictFree:
- *   Frees a dictionary and all of its contents.
+ * b64DecodedMaxLen:
+ *   Computes an upper bound on the bytes b64Decode produces for an input.
+ *   The bound is exact unless the input ends with padding.
  *
  * Parameters:
- *   dict - Target dictionary.
+ *   len - length of Base64 string
+ *
+ * Returns:
+ *   Maximum number of bytes decoded from 'len' characters
  */
-void dictFree(Dictionary *dict);
-
-#endif // DU_DICT_H
-#endif // DU_DICT
+size_t b64DecodedMaxLen(size_t len);
 
+// Flags for b64DecodeEx
+#define DU_B64_SKIP_SPACE 0x1  // Skip whitespace anywhere in the input (MIME line breaks)
+#define DU_B64_URL_SAFE   0x2  // Also accept the URL-safe alphabet ('-' and '_')
+#define DU_B64_NO_PAD     0x4  // Accept a final group without '=' padding
 
-#ifdef DU_ARGS
-#ifndef DU_ARGS_H
-#define DU_ARGS_H
-/* =====================================================================
+/**
+ * b64DecodeEx:
+ *   Decodes a Base64 string in a single pass, validating every character.
+ *   Unlike b64Decode, the input length needs not be a multiple of 4.
  *
- * CLI ARGUMENT PARSING
+ * Parameters:
+ *   in      - pointer to Base64 string
+ *   len     - length of input string
+ *   out     - output buffer, at least b64DecodedMaxLen(len + 3) bytes
+ *   flags   - bitwise OR of DU_B64_* flags
+ *   written - receives the number of bytes written to 'out' (may be NULL)
  *
- * =====================================================================
+ * Returns:
+ *   true if the whole input was valid, false on an invalid character,
+ *   misplaced or missing padding, or a truncated group ('written' then
+ *   counts the bytes decoded before the error)
  */
+bool b64DecodeEx(const char *in, size_t len, uint8_t *out, uint32_t flags, size_t *written);
+
+// Streaming encoder state, carries a partial 3-byte group across calls
+typedef struct {
+    uint8_t carry[3];   // Input bytes not yet encoded
+    uint8_t carry_len;  // Number of valid bytes in 'carry'
+} B64Encoder;
 
+// Streaming decoder state, carries a partial 4-character group across calls
+typedef struct {
+    char    carry[4];   // Input characters not yet decoded
+    uint8_t carry_len;  // Number of valid characters in 'carry'
+} B64Decoder;
 
 /**
- * ArgType:
- *   Enumerates the supported argument types.
+ * b64EncoderInit:
+ *   Prepares an encoder for a new stream.
+ *
+ * Parameters:
+ *   enc - encoder to initialize
  */
-typedef enum {
-    DU_ARG_BOL,   // Boolean flag (true if present)
-    DU_ARG_INT,   // Integer argument
-    DU_ARG_DBL,   // Double/float argument
-    DU_ARG_STR,   // String argument
-    DU_ARG_END    // Marks the end of an ArgSpec array
-} ArgType;
+void b64EncoderInit(B64Encoder *enc);
 
 /**
- * ArgSpec:
- *   Describes one command-line argument option.
+ * b64EncoderUpdate:
+ *   Encodes the next chunk of a stream. Bytes that do not complete a
+ *   3-byte group are kept in 'enc' for the next call.
+ *
+ * Parameters:
+ *   enc - encoder state
+ *   in  - next input bytes (may be NULL if 'len' is 0)
+ *   len - length of input in bytes
+ *   out - output buffer, at least b64EncodedLen(len + 2) bytes
+ *
+ * Returns:
+ *   Number of bytes written to 'out'
  */
-typedef struct {
-    const char *s_rep;   // Short option name (e.g., "h") or NULL
-    const char *l_rep;   // Long option name (e.g., "help") or NULL
-    const char *help;    // Help text (can be NULL)
-    void       *out;     // Pointer to storage for the parsed value
-    ArgType     type;    // Argument type
-    bool        is_req;  // Whether this argument is required
-} ArgSpec;
-
-// For the following macros:
-// - sr   = short option (e.g., "h")
-// - lr   = long option (e.g., "help")
-// - o    = pointer to storage for the value
-// - h    = help description
-// - ir   = whether the argument is required
-
-// ARG_BOOL: Define a boolean flag argument.
-#define ARG_BOOL(sr, lr, o, h, ir) \
-    ((ArgSpec){ (sr), (lr), (h), (o), DU_ARG_BOL, (ir) })
-
-// ARG_INT: Define an integer argument.
-#define ARG_INT(sr, lr, o, h, ir) \
-    ((ArgSpec){ (sr), (lr), (h), (o), DU_ARG_INT, (ir) })
-
-// ARG_DOUBLE: Define a floating-point argument.
-#define ARG_DOUBLE(sr, lr, o, h, ir) \
-    ((ArgSpec){ (sr), (lr), (h), (o), DU_ARG_DBL, (ir) })
-
-// ARG_STRING: Define a string argument.
-#define ARG_STRING(sr, lr, o, h, ir) \
-    ((ArgSpec){ (sr), (lr), (h), (o), DU_ARG_STR, (ir) })
-
-// ARG_END: Marks the end of the argument specification array.
-// Must be placed as the last element in ArgSpec array.
-#define ARG_END() \
-    ((ArgSpec){NULL, NULL, NULL, NULL, DU_ARG_END, false})
-
+size_t b64EncoderUpdate(B64Encoder *enc, const uint8_t *in, size_t len, char *out);
 
 /**
- * parseArgs:
- *   Parses command-line arguments according to the given specification array.
+ * b64EncoderFinal:
+ *   Encodes any carried bytes with padding and resets the encoder.
  *
  * Parameters:
- *   ctx   - Pointer to an ArgSpec array describing expected arguments.
- *           Must be terminated with ARG_END().
- *   argc  - Argument count from main().
- *   argv  - Argument vector from main().
- *
+ *   enc - encoder state
+ *   out - output buffer, at least 4 bytes
  *
  * Returns:
- *   true  if parsing succeeded with all requirements met.
- *   false if an error occurred.
+ *   Number of bytes written to 'out'
  */
-bool parseArgs(ArgSpec *ctx, int argc, char **argv);
-
+size_t b64EncoderFinal(B64Encoder *enc, char *out);
 
 /**
- * printHelp:
- *   Prints usage information for the program based on the argument
- *   specification array.
+ * b64DecoderInit:
+ *   Prepares a decoder for a new stream.
  *
  * Parameters:
- *   progName - Name of the program (usually argv[0]).
- *   ctx      - Pointer to an ArgSpec array (must be terminated with ARG_END()).
+ *   dec - decoder to initialize
  */
-void printHelp(const char *progName, ArgSpec *ctx);
-
-#endif // DU_ARGS_H
-#endif // DU_ARGS
+void b64DecoderInit(B64Decoder *dec);
 
-
-#ifdef DU_STRINGS
-#ifndef DU_STRINGS_H
-#define DU_STRINGS_H
-/* =====================================================================
+/**
+ * b64DecoderUpdate:
+ *   Decodes the next chunk of a stream. Characters that do not complete
+ *   a 4-character group are kept in 'dec' for the next call.
  *
- * STRING UTILITIES
+ * Parameters:
+ *   dec - decoder state
+ *   in  - next Base64 characters (may be NULL if 'len' is 0)
+ *   len - length of input
+ *   out - output buffer, at least b64DecodedMaxLen(len + 3) bytes
  *
- * =====================================================================
+ * Returns:
+ *   Number of bytes written to 'out'
  */
-
+size_t b64DecoderUpdate(B64Decoder *dec, const char *in, size_t len, uint8_t *out);
 
 /**
- * strTrim:
- *   Removes whitespace from both ends of the string in-place.
+ * b64DecoderFinal:
+ *   Decodes any carried characters as if the group were padded and
+ *   resets the decoder.
  *
  * Parameters:
- *   s - string to trim
+ *   dec - decoder state
+ *   out - output buffer, at least 3 bytes
  *
  * Returns:
- *   Pointer to the trimmed string (same as input)
+ *   Number of bytes written to 'out'
  */
-char *strTrim(char *s);
+size_t b64DecoderFinal(B64Decoder *dec, uint8_t *out);
 
+#ifdef DU_POOL
 
 /**
- * strLTrim:
- *   Removes whitespace from the start of the string in-place.
+ * b64EncodeParallel:
+ *   Same as b64Encode, spread over the threads of a pool. The input is cut
+ *   on 3-byte group boundaries, so each thread knows where its output goes.
  *
  * Parameters:
- *   s - string to trim
+ *   pool - pool to run on (NULL for poolDefault)
+ *   in   - pointer to input byte array
+ *   len  - length of input in bytes
+ *   out  - output buffer, at least b64EncodedLen(len) bytes
  *
  * Returns:
- *   Pointer to the trimmed string (same as input)
+ *   Number of bytes written to 'out'
  */
-char *strLTrim(char *s);
-
+size_t b64EncodeParallel(ThreadPool *pool, const uint8_t *in, size_t len, char *out);
 
 /**
- * strRTrim:
- *   Removes whitespace from the end of the string in-place.
+ * b64DecodeParallel:
+ *   Same as b64Decode, spread over the threads of a pool. The input is cut
+ *   on 4-character group boundaries and may only be padded in its final
+ *   group (as b64Encode produces it).
  *
  * Parameters:
- *   s - string to trim
+ *   pool - pool to run on (NULL for poolDefault)
+ *   in   - pointer to Base64 string
+ *   len  - length of input string
+ *   out  - output buffer, at least b64DecodedMaxLen(len) bytes
  *
  * Returns:
- *   Pointer to the trimmed string (same as input)
+ *   Number of bytes written to 'out'
  */
-char *strRTrim(char *s);
+size_t b64DecodeParallel(ThreadPool *pool, const char *in, size_t len, uint8_t *out);
 
+#endif // DU_POOL
 
-/**
- * strReplace:
- *   Replaces all occurrences of `needle` in `s` with `replacement`.
+#endif // DU_BASE64_H
+#endif // DU_BASE64
+
+
+#ifdef DU_HASH
+#ifndef DU_HASH_H
+#define DU_HASH_H
+/* =====================================================================
  *
- * Parameters:
- *   s           - input string
- *   needle      - substring to replace
- *   replacement - string to insert
+ * HASH UTILITIES
  *
- * Returns:
- *   Newly allocated string; caller must free
+ * =====================================================================
  */
-char *strReplace(const char *s, const char *needle, const char *replacement);
 
 
 /**
- * strToLower:
- *   Converts the string to lowercase in-place.
+ * md5Digest:
+ *   Computes the MD5 digest of a data block.
  *
  * Parameters:
- *   s - string to convert
+ *   data - pointer to input data
+ *   len  - length of input data in bytes
+ *   out  - output buffer of 16 bytes to hold the MD5 digest
  *
  * Returns:
- *   Pointer to the converted string (same as input)
+ *   void (result stored in `out`)
  */
-char *strToLower(char *s);
+void md5Digest(uint8_t *data, size_t len, uint8_t out[16]);
 
+// Incremental MD5 state, holds a partial block between md5Update calls
+typedef struct {
+    uint32_t a, b, c, d;  // Running digest state
+    uint8_t  buff[64];    // Partial block not yet hashed
+    uint64_t size;        // Total number of bytes hashed so far
+    size_t   blen;        // Number of valid bytes in 'buff'
+} Md5Ctx;
 
 /**
- * strToUpper:
- *   Converts the string to uppercase in-place.
+ * md5Init:
+ *   Prepares an MD5 context for a new message.
  *
  * Parameters:
- *   s - string to convert
+ *   ctx - context to initialize
+ */
+void md5Init(Md5Ctx *ctx);
+
+/**
+ * md5Update:
+ *   Feeds the next part of the message into the digest.
+ *   Whole 64-byte blocks are hashed in place without being copied.
  *
- * Returns:
- *   Pointer to the converted string (same as input)
+ * Parameters:
+ *   ctx  - initialized context
+ *   data - next message bytes (may be NULL if 'len' is 0)
+ *   len  - length of data in bytes
  */
-char *strToUpper(char *s);
+void md5Update(Md5Ctx *ctx, const void *data, size_t len);
 
+/**
+ * md5Final:
+ *   Finishes the message and writes its digest.
+ *   The context must be re-initialized before hashing another message.
+ *
+ * Parameters:
+ *   ctx - context holding the message
+ *   out - output buffer of 16 bytes to hold the MD5 digest
+ */
+void md5Final(Md5Ctx *ctx, uint8_t out[16]);
 
 /**
- * strStartsWith:
- *   Checks if the string starts with the given prefix.
+ * md5File:
+ *   Computes the MD5 digest of a file's contents without loading it into
+ *   memory. Regular files are memory mapped for sequential reading where
+ *   the platform supports it, anything else is read in large chunks.
  *
  * Parameters:
- *   s      - string to check
- *   prefix - prefix to test
+ *   path - path of the file to hash
+ *   out  - output buffer of 16 bytes to hold the MD5 digest
  *
  * Returns:
- *   true if `s` starts with `prefix`, false otherwise
+ *   true on success, false if the file could not be opened or read
  */
-bool strStartsWith(const char *s, const char *prefix);
+bool md5File(const char *path, uint8_t out[16]);
 
+/**
+ * md5DigestMany:
+ *   Computes the MD5 digests of many independent messages at once.
+ *   Messages are interleaved across SIMD lanes (4, 8 or 16 wide, picked
+ *   for the running CPU) and a lane is refilled with the next message
+ *   as soon as its current one finishes, so lengths may differ freely.
+ *   Define DU_HASH_NO_SIMD to hash one message at a time instead.
+ *
+ * Parameters:
+ *   inputs - array of 'n' pointers to message data
+ *   lens   - array of 'n' message lengths in bytes
+ *   outs   - array of 'n' 16-byte buffers receiving the digests
+ *   n      - number of messages
+ */
+void md5DigestMany(const uint8_t *const inputs[], const size_t lens[], uint8_t outs[][16], size_t n);
 
 /**
- * strEndsWith:
- *   Checks if the string ends with the given suffix.
+ * hash64:
+ *   Computes a fast 64-bit non-cryptographic checksum (wyhash).
+ *   dictHash is the same function with a random per-process seed.
  *
  * Parameters:
- *   s      - string to check
- *   suffix - suffix to test
+ *   data - pointer to input data (may be NULL if 'len' is 0)
+ *   len  - length of input data in bytes
+ *   seed - seed selecting one of a family of hash functions
  *
  * Returns:
- *   true if `s` ends with `suffix`, false otherwise
+ *   64-bit hash of the data
  */
-bool strEndsWith(const char *s, const char *suffix);
-
+uint64_t hash64(const void *data, size_t len, uint64_t seed);
 
 /**
- * strSlice:
- *   Returns a newly allocated substring from `start` to `end` (exclusive).
- *   Negative indices count from the end of the string.
+ * hash128:
+ *   Computes a 128-bit non-cryptographic checksum from two independent
+ *   wyhash lanes, for when 64 bits leave too high a collision chance.
  *
  * Parameters:
- *   s     - input string
- *   start - starting index
- *   end   - ending index (exclusive)
- *
- * Returns:
- *   Newly allocated substring; caller must free
+ *   data - pointer to input data (may be NULL if 'len' is 0)
+ *   len  - length of input data in bytes
+ *   seed - seed selecting one of a family of hash functions
+ *   out  - output buffer of 16 bytes (first lane, then second, little-endian)
  */
-char *strSlice(const char *s, size_t start, size_t end);
+void hash128(const void *data, size_t len, uint64_t seed, uint8_t out[16]);
 
+// Incremental hash64/hash128 state, gives the same result as the one-shot calls
+typedef struct {
+    uint64_t seed[2];     // Running state of each lane
+    uint64_t see1[2];     // Second and third stripe accumulators
+    uint64_t see2[2];
+    uint64_t size;        // Total number of bytes hashed so far
+    uint8_t  buff[64];    // 16 bytes of history, then up to 48 pending bytes
+    size_t   blen;        // Number of pending bytes
+    uint8_t  lanes;       // 1 for hash64, 2 for hash128
+} HashCtx;
 
 /**
- * strCount:
- *   Counts the number of occurrences of `needle` in `s`.
+ * hash64Init:
+ *   Prepares a context for an incremental hash64.
  *
  * Parameters:
- *   s      - string to search
- *   needle - substring to count
+ *   ctx  - context to initialize
+ *   seed - seed, as for hash64
+ */
+void hash64Init(HashCtx *ctx, uint64_t seed);
+
+/**
+ * hash128Init:
+ *   Prepares a context for an incremental hash128.
  *
- * Returns:
- *   Number of occurrences
+ * Parameters:
+ *   ctx  - context to initialize
+ *   seed - seed, as for hash128
  */
-size_t strCount(const char *s, const char *needle);
+void hash128Init(HashCtx *ctx, uint64_t seed);
 
+/**
+ * hashUpdate:
+ *   Feeds the next part of the data into the hash.
+ *
+ * Parameters:
+ *   ctx  - initialized context
+ *   data - next bytes (may be NULL if 'len' is 0)
+ *   len  - length of data in bytes
+ */
+void hashUpdate(HashCtx *ctx, const void *data, size_t len);
 
 /**
- * strDup:
- *   Returns a newly allocated copy of the string.
+ * hash64Final:
+ *   Finishes a context initialized with hash64Init.
  *
  * Parameters:
- *   s - string to duplicate
+ *   ctx - context holding the data
  *
  * Returns:
- *   Newly allocated string; caller must free
+ *   64-bit hash of the data
  */
-char *strDup(const char *s);
+uint64_t hash64Final(HashCtx *ctx);
 
+/**
+ * hash128Final:
+ *   Finishes a context initialized with hash128Init.
+ *
+ * Parameters:
+ *   ctx - context holding the data
+ *   out - output buffer of 16 bytes
+ */
+void hash128Final(HashCtx *ctx, uint8_t out[16]);
 
 /**
- * strRev:
- *   Reverses the string in-place.
+ * sha256Digest:
+ *   Computes the SHA-256 digest of a data block. Uses the SHA-NI or
+ *   ARMv8 SHA-2 instructions when the CPU (or target) provides them.
  *
  * Parameters:
- *   s - string to reverse
+ *   data - pointer to input data
+ *   len  - length of input data in bytes
+ *   out  - output buffer of 32 bytes to hold the SHA-256 digest
+ */
+void sha256Digest(const uint8_t *data, size_t len, uint8_t out[32]);
+
+// Incremental SHA-256 state, holds a partial block between sha256Update calls
+typedef struct {
+    uint32_t state[8];    // Running digest state
+    uint8_t  buff[64];    // Partial block not yet hashed
+    uint64_t size;        // Total number of bytes hashed so far
+    size_t   blen;        // Number of valid bytes in 'buff'
+} Sha256Ctx;
+
+/**
+ * sha256Init:
+ *   Prepares a SHA-256 context for a new message.
  *
- * Returns:
- *   Pointer to the reversed string (same as input)
+ * Parameters:
+ *   ctx - context to initialize
  */
-char *strRev(char *s);
+void sha256Init(Sha256Ctx *ctx);
 
+/**
+ * sha256Update:
+ *   Feeds the next part of the message into the digest.
+ *   Whole 64-byte blocks are hashed in place without being copied.
+ *
+ * Parameters:
+ *   ctx  - initialized context
+ *   data - next message bytes (may be NULL if 'len' is 0)
+ *   len  - length of data in bytes
+ */
+void sha256Update(Sha256Ctx *ctx, const void *data, size_t len);
 
-#ifdef DU_VECTOR
+/**
+ * sha256Final:
+ *   Finishes the message and writes its digest.
+ *   The context must be re-initialized before hashing another message.
+ *
+ * Parameters:
+ *   ctx - context holding the message
+ *   out - output buffer of 32 bytes to hold the SHA-256 digest
+ */
+void sha256Final(Sha256Ctx *ctx, uint8_t out[32]);
 
-// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
-// In order to use this functionality you must define DU_VECTOR
-// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+#ifdef DU_POOL
 
-// Splits the string 's' by delimiter 'delim'.
-// Returns a NULL-terminated array of strings; caller must free each element and the array.
-Vector *strSplit(const char *s, const char delim);
+// Chunk size sha256Tree uses when given 0
+#define DU_HASH_TREE_CHUNK (1u << 20)
 
-// Joins an array of strings 'parts' into a single string, using 'sep' as separator.
-// Returns a newly allocated string; caller must free.
-char *strJoin(const Vector *parts, const char *sep);
+/**
+ * sha256Tree:
+ *   Computes a tree-mode SHA-256 of a data block on the threads of a pool.
+ *   Every 'chunk'-byte piece is hashed on its own, then the root digest is
+ *   the SHA-256 of the piece digests followed by the total length and the
+ *   chunk size (both as 64-bit little-endian). The result depends on
+ *   'chunk' and differs from sha256Digest, but not on the thread count.
+ *
+ * Parameters:
+ *   pool  - pool to run on (NULL for poolDefault)
+ *   data  - pointer to input data
+ *   len   - length of input data in bytes
+ *   chunk - bytes per leaf (0 for DU_HASH_TREE_CHUNK)
+ *   out   - output buffer of 32 bytes to hold the root digest
+ *
+ * Returns:
+ *   true on success, false if the leaf digests could not be allocated
+ */
+bool sha256Tree(ThreadPool *pool, const uint8_t *data, size_t len, size_t chunk, uint8_t out[32]);
 
-#endif // DU_VECTOR
+#endif // DU_POOL
 
-#endif // DU_STRINGS_H
-#endif // DU_STRINGS
+#endif // DU_HASH_H
+#endif // DU_HASH
 
 
-#ifdef DU_TUI
+#ifdef DU_VECTOR
+#ifndef DU_VECTOR_H
+#define DU_VECTOR_H
 /* =====================================================================
  *
- * TERMINAL UI UTILITIES
+ * VECTOR OPERATIONS
  *
  * =====================================================================
  */
 
 
-#define DU_TUI_RESET       "\x1b[0m"
-#define DU_TUI_BOLD        "\x1b[1m"
-#define DU_TUI_DIM         "\x1b[2m"
-#define DU_TUI_UNDERLINE   "\x1b[4m"
-#define DU_TUI_BLINK       "\x1b[5m"
-#define DU_TUI_REVERSE     "\x1b[7m"
-#define DU_TUI_HIDDEN      "\x1b[8m"
+// Bytes of cell storage kept inside the Vector struct itself
+#define DU_VEC_INLINE_BYTES 32
 
-#define DU_TUI_FG_BLACK    "\x1b[30m"
-#define DU_TUI_FG_RED      "\x1b[31m"
-#define DU_TUI_FG_GREEN    "\x1b[32m"
-#define DU_TUI_FG_YELLOW   "\x1b[33m"
-#define DU_TUI_FG_BLUE     "\x1b[34m"
-#define DU_TUI_FG_MAGENTA  "\x1b[35m"
-#define DU_TUI_FG_CYAN     "\x1b[36m"
-#define DU_TUI_FG_WHITE    "\x1b[37m"
+// Vector flags
+#define DU_VEC_HEAP_HEADER 0x1  // The Vector struct was allocated by vecNew
 
-#define DU_TUI_FG_BBLACK   "\x1b[90m"
-#define DU_TUI_FG_BRED     "\x1b[91m"
-#define DU_TUI_FG_BGREEN   "\x1b[92m"
-#define DU_TUI_FG_BYELLOW  "\x1b[93m"
-#define DU_TUI_FG_BBLUE    "\x1b[94m"
-#define DU_TUI_FG_BMAGENTA "\x1b[95m"
-#define DU_TUI_FG_BCYAN    "\x1b[96m"
-#define DU_TUI_FG_BWHITE   "\x1b[97m"
+#ifdef DU_VECTOR_PARALLEL
 
-#define DU_TUI_BG_BLACK    "\x1b[40m"
-#define DU_TUI_BG_RED      "\x1b[41m"
-#define DU_TUI_BG_GREEN    "\x1b[42m"
-#define DU_TUI_BG_YELLOW   "\x1b[43m"
-#define DU_TUI_BG_BLUE     "\x1b[44m"
-#define DU_TUI_BG_MAGENTA  "\x1b[45m"
-#define DU_TUI_BG_CYAN     "\x1b[46m"
-#define DU_TUI_BG_WHITE    "\x1b[47m"
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// In order to use parallel sorting you must define
+// DU_VECTOR_PARALLEL and link with pthreads.
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
-#define DU_TUI_BG_BBLACK   "\x1b[100m"
-#define DU_TUI_BG_BRED     "\x1b[101m"
-#define DU_TUI_BG_BGREEN   "\x1b[102m"
-#define DU_TUI_BG_BYELLOW  "\x1b[103m"
-#define DU_TUI_BG_BBLUE    "\x1b[104m"
-#define DU_TUI_BG_BMAGENTA "\x1b[105m"
-#define DU_TUI_BG_BCYAN    "\x1b[106m"
-#define DU_TUI_BG_BWHITE   "\x1b[107m"
+#include <pthread.h>
 
+#ifndef DU_VEC_SORT_THREADS
+#define DU_VEC_SORT_THREADS        8  // Chunks sorted in parallel
+#endif
+#ifndef DU_VEC_PARALLEL_MIN
+#define DU_VEC_PARALLEL_MIN  4000000  // Smallest vector worth splitting
+#endif
+
+#endif // DU_VECTOR_PARALLEL
 
 /**
- * tuiSetColor:
- *   Sets the foreground and/or background color for text output.
+ * Vector:
+ *   Generic dynamic array structure, storing metadata about allocated
+ *   capacity, element size, and current length.
+ *
+ *   Small vectors keep their cells in 'inline_buf' and only move to
+ *   the heap once they outgrow it. Because 'data' may point into the
+ *   struct itself, a Vector must not be copied by value.
+ */
+typedef struct vec_meta_s {
+    size_t    capacity;  // How many cells can the vector hold before resizing
+    size_t      length;  // The length of the vector
+    uint16_t cell_size;  // The size of each cell in bytes
+    uint16_t     flags;  // DU_VEC_* flags
+    void *        data;  // A pointer to the data stored in the vector
+    const DuAllocator *alloc;  // Allocator for the cells (and the header of vecNew)
+    union {
+        unsigned char bytes[DU_VEC_INLINE_BYTES];
+        uint64_t      align_u;
+        double        align_d;
+        void *        align_p;
+    } inline_buf;        // Inline cell storage for small vectors
+} Vector;
+
+/**
+ * vecNew:
+ *   Allocates and initializes a new vector.
  *
  * Parameters:
- *   foreground - ANSI escape code string for foreground color (e.g., DU_TUI_RED)
- *   background - ANSI escape code string for background color
+ *   cell_size    - Size of each element in bytes (must be > 0)
+ *   capacity_opt - Initial capacity (0 = default of 4)
+ *   do_clear     - Whether to zero-initialize allocated memory
+ *
+ * Returns:
+ *   Pointer to the newly allocated vector, or NULL if allocation fails
  */
-void tuiSetColor(const char *foreground, const char *background);
+Vector *vecNew(uint16_t cell_size, size_t capacity_opt, bool do_clear);
+
 
 /**
- * tuiReset:
- *   Resets text formatting and colors to defaults.
+ * vecNewWith:
+ *   Same as vecNew, allocating the vector and its cells from 'alloc'.
+ *
+ * Parameters:
+ *   alloc        - Allocator to use (NULL = the global allocator);
+ *                  must outlive the vector
+ *   cell_size    - Size of each element in bytes (must be > 0)
+ *   capacity_opt - Initial capacity (0 = default of 4)
+ *   do_clear     - Whether to zero-initialize allocated memory
+ *
+ * Returns:
+ *   Pointer to the newly allocated vector, or NULL if allocation fails
  */
-void tuiReset(void);
+Vector *vecNewWith(const DuAllocator *alloc, uint16_t cell_size, size_t capacity_opt, bool do_clear);
+
 
 /**
- * tuiCursorUp:
- *   Moves the cursor up by `n` lines.
+ * vecInit:
+ *   Initializes a vector embedded in another struct or on the stack.
+ *   Cells are stored inline until the vector outgrows DU_VEC_INLINE_BYTES,
+ *   so a small vector needs no allocation at all.
  *
  * Parameters:
- *   n - number of lines to move up
+ *   vec          - Pointer to the Vector to initialize
+ *   cell_size    - Size of each element in bytes (must be > 0)
+ *   capacity_opt - Initial capacity (0 = as many cells as fit inline)
+ *   do_clear     - Whether to zero-initialize the storage
+ *
+ * Returns:
+ *   true on success, false if a heap buffer was needed and allocation failed
  */
-void tuiCursorUp(uint8_t n);
+bool vecInit(Vector *vec, uint16_t cell_size, size_t capacity_opt, bool do_clear);
+
 
 /**
- * tuiCursorDown:
- *   Moves the cursor down by `n` lines.
+ * vecFree:
+ *   Frees a vector's data buffer, and the vector itself if it was
+ *   created by vecNew. Vectors set up with vecInit are left empty.
  *
  * Parameters:
- *   n - number of lines to move down
+ *   vec        - Pointer to vector
+ *   purge_data - If true, zeroes out the vector's internal data before freeing
  */
-void tuiCursorDown(uint8_t n);
+void vecFree(Vector *vec, bool purge_data);
+
 
 /**
- * tuiCursorRight:
- *   Moves the cursor right by `n` columns.
+ * vecLength:
+ *   Returns the number of elements currently stored in the vector.
  *
  * Parameters:
- *   n - number of columns to move right
+ *   vec - Vector pointer
+ *
+ * Returns:
+ *   Current length of the vector
  */
-void tuiCursorRight(uint8_t n);
+size_t vecLength(const Vector *vec);
+
 
 /**
- * tuiCursorLeft:
- *   Moves the cursor left by `n` columns.
+ * vecCellSize:
+ *   Returns the size in bytes of each element in the vector.
  *
  * Parameters:
- *   n - number of columns to move left
+ *   vec - Vector pointer
+ *
+ * Returns:
+ *   Size of one element in bytes
  */
-void tuiCursorLeft(uint8_t n);
+uint16_t vecCellSize(const Vector *vec);
+
 
 /**
- * tuiCursorPos:
- *   Moves the cursor to absolute position (x, y).
+ * vecCapacity:
+ *   Returns the current allocated capacity of the vector.
  *
  * Parameters:
- *   x - column number (1-based)
- *   y - row number (1-based)
+ *   vec - Vector pointer
+ *
+ * Returns:
+ *   Number of elements the vector can hold before resizing
  */
-void tuiCursorPos(uint8_t x, uint8_t y);
+size_t vecCapacity(const Vector *vec);
+
 
 /**
- * tuiHideCursor:
- *   Hides the terminal cursor.
+ * vecSet:
+ *   Sets the value of an element at a specific index.
+ *
+ * Parameters:
+ *   vec - Vector pointer
+ *   idx - Index of the element (must be < vecLength(vec))
+ *   val - Pointer to the new value to store
  */
-void tuiHideCursor(void);
+void vecSet(Vector *vec, size_t idx, const void *val);
+
 
 /**
- * tuiShowCursor:
- *   Shows the terminal cursor if it was hidden.
+ * vecAt:
+ *   Returns a pointer to the element at the specified index.
+ *
+ * Parameters:
+ *   vec - Vector pointer
+ *   idx - Index of the element (must be < vecLength(vec))
+ *
+ * Returns:
+ *   Pointer to the element inside the vector
  */
-void tuiShowCursor(void);
+void *vecAt(Vector *vec, size_t idx);
+
 
 /**
- * tuiClearScreen:
- *   Clears the terminal screen and moves cursor to top-left.
+ * vecPush:
+ *   Appends a new element to the end of the vector, resizing if needed.
+ *
+ * Parameters:
+ *   vec - Vector pointer
+ *   val - Pointer to the value to append
+ *
+ * Returns:
+ *   true on success, false if reallocation failed (vector unchanged)
  */
-void tuiClearScreen(void);
+bool vecPush(Vector *vec, const void *val);
 
-#endif // DU_TUI
+
+/**
+ * vecPushUninit:
+ *   Appends 'n' uninitialized elements and returns a pointer to the
+ *   first of them, so records can be built in place.
+ *
+ * Parameters:
+ *   vec - Vector pointer
+ *   n   - Number of elements to append
+ *
+ * Returns:
+ *   Pointer to the first new element, or NULL if reallocation failed.
+ *   NOTE: This pointer becomes invalid if the vector is resized afterward.
+ */
+void *vecPushUninit(Vector *vec, size_t n);
 
 
-/* =====================================================================
+/**
+ * vecExtend:
+ *   Appends 'n' elements from a contiguous buffer with a single copy.
  *
- * Delta-Utils: IMPLEMENTATION
- * 
- * =====================================================================
+ * Parameters:
+ *   vec - Vector pointer
+ *   src - Pointer to 'n' consecutive elements
+ *   n   - Number of elements to append
+ *
+ * Returns:
+ *   true on success, false if reallocation failed (vector unchanged)
  */
+bool vecExtend(Vector *vec, const void *src, size_t n);
 
 
-#ifdef DU_IMPLEMENTATION
+/**
+ * vecInsertRange:
+ *   Inserts 'n' elements at index 'idx', shifting later elements up.
+ *
+ * Parameters:
+ *   vec - Vector pointer
+ *   idx - Insert position (must be <= vecLength(vec))
+ *   src - Pointer to 'n' consecutive elements
+ *   n   - Number of elements to insert
+ *
+ * Returns:
+ *   true on success, false if reallocation failed (vector unchanged)
+ */
+bool vecInsertRange(Vector *vec, size_t idx, const void *src, size_t n);
 
 
-#ifdef DU_BASE64
+/**
+ * vecRemoveRange:
+ *   Removes 'n' elements starting at 'idx', keeping the order of the rest.
+ *
+ * Parameters:
+ *   vec - Vector pointer
+ *   idx - First element to remove
+ *   n   - Number of elements to remove (idx + n must be <= vecLength(vec))
+ */
+void vecRemoveRange(Vector *vec, size_t idx, size_t n);
 
-static const uint8_t b64_dt[256] = {
-    ['A'] =  0, ['B'] =  1, ['C'] =  2, ['D'] =  3,
-    ['E'] =  4, ['F'] =  5, ['G'] =  6, ['H'] =  7,
-    ['I'] =  8, ['J'] =  9, ['K'] = 10, ['L'] = 11,
-    ['M'] = 12, ['N'] = 13, ['O'] = 14, ['P'] = 15,
-    ['Q'] = 16, ['R'] = 17, ['S'] = 18, ['T'] = 19,
-    ['U'] = 20, ['V'] = 21, ['W'] = 22, ['X'] = 23,
-    ['Y'] = 24, ['Z'] = 25,
-    ['a'] = 26, ['b'] = 27, ['c'] = 28, ['d'] = 29,
-    ['e'] = 30, ['f'] = 31, ['g'] = 32, ['h'] = 33,
-    ['i'] = 34, ['j'] = 35, ['k'] = 36, ['l'] = 37,
-    ['m'] = 38, ['n'] = 39, ['o'] = 40, ['p'] = 41,
-    ['q'] = 42, ['r'] = 43, ['s'] = 44, ['t'] = 45,
-    ['u'] = 46, ['v'] = 47, ['w'] = 48, ['x'] = 49,
-    ['y'] = 50, ['z'] = 51,
-    ['0'] = 52, ['1'] = 53, ['2'] = 54, ['3'] = 55,
-    ['4'] = 56, ['5'] = 57, ['6'] = 58, ['7'] = 59,
-    ['8'] = 60, ['9'] = 61,
-    ['+'] = 62, ['/'] = 63
-};
 
-static const char b64_et[65] =
-    "ABCDEFGHIJKLMNOPQRSTUVWXYZ"
-    "abcdefghijklmnopqrstuvwxyz"
-    "0123456789+/";
+/**
+ * vecSwapRemove:
+ *   Removes the element at 'idx' in O(1) by moving the last element
+ *   into its place. Does not keep the order of elements.
+ *
+ * Parameters:
+ *   vec - Vector pointer
+ *   idx - Index of the element (must be < vecLength(vec))
+ */
+void vecSwapRemove(Vector *vec, size_t idx);
 
-size_t b64Encode(uint8_t *in, size_t len, char *out) {
-    assert(in != NULL && len != 0 && out != NULL);
 
-    size_t idx = 0;
-    int i = 0;
-    while (i+2 < len) {
-        uint32_t g = (in[i] << 16) | (in[i+1] << 8) | in[i+2];
-        i += 3;
+/**
+ * vecPop:
+ *   Removes and returns the last element from the vector.
+ *
+ * Parameters:
+ *   vec - Vector pointer (must have at least 1 element)
+ *
+ * Returns:
+ *   Pointer to the popped element inside the buffer.
+ *   NOTE: This pointer becomes invalid if the vector is resized afterward.
+ */
+void *vecPop(Vector *vec);
 
-        out[idx++] = b64_et[(g >> 18) & 0xF];
-        out[idx++] = b64_et[(g >> 12) & 0xF];
-        out[idx++] = b64_et[(g >> 6 ) & 0xF];
-        out[idx++] = b64_et[g & 0xF];
-    }
 
-    size_t rem = len - i;
+/**
+ * vecReserve:
+ *   Ensures the vector has at least 'new_capacity' slots allocated.
+ *
+ * Parameters:
+ *   vec          - Vector pointer
+ *   new_capacity - Desired minimum capacity
+ *   do_clear     - If true, zero-initializes newly allocated space
+ *
+ * Returns:
+ *   true on success, false if reallocation failed (vector unchanged)
+ */
+bool vecReserve(Vector *vec, size_t new_capacity, bool do_clear);
 
-    if (rem == 1) {
-        uint32_t g = in[i] << 16;
-        out[idx++] = b64_et[(g >> 18) & 0xF];
-        out[idx++] = b64_et[(g >> 12) & 0xF];
-        out[idx++] = '=';
+
+/**
+ * vecSort:
+ *   Sorts the vector in place with a qsort-style comparator.
+ *
+ * Parameters:
+ *   vec - Vector pointer
+ *   cmp - Returns <0, 0 or >0 when the first cell is less than,
+ *         equal to, or greater than the second
+ */
+void vecSort(Vector *vec, int (*cmp)(const void *, const void *));
+
+
+/**
+ * vecSortU32, vecSortU64, vecSortF64:
+ *   Sorts a vector of uint32_t / uint64_t / double cells in ascending
+ *   order using an LSD radix sort, with no comparator calls. Doubles
+ *   follow IEEE total order (-NaN < -Inf < ... < -0.0 < +0.0 < ... < NaN).
+ *
+ *   When compiled with DU_VECTOR_PARALLEL (link with pthreads),
+ *   vectors of at least DU_VEC_PARALLEL_MIN cells are split into
+ *   chunks that are sorted on separate threads and merged in parallel.
+ *
+ * Parameters:
+ *   vec - Vector pointer (cell_size must match the element type)
+ *
+ * Returns:
+ *   true on success. false if the scratch buffer could not be
+ *   allocated; the vector is then sorted with vecSort instead.
+ */
+bool vecSortU32(Vector *vec);
+bool vecSortU64(Vector *vec);
+bool vecSortF64(Vector *vec);
+
+
+/**
+ * vecLowerBound:
+ *   Finds the first cell of a sorted vector that is not less than 'key'.
+ *
+ * Parameters:
+ *   vec - Vector pointer (sorted by 'cmp')
+ *   key - Pointer to the value to search for
+ *   cmp - Comparator the vector was sorted with
+ *
+ * Returns:
+ *   Index of that cell, or vecLength(vec) if every cell is less than 'key'
+ */
+size_t vecLowerBound(const Vector *vec, const void *key, int (*cmp)(const void *, const void *));
+
+
+/**
+ * vecBinarySearch:
+ *   Searches a sorted vector for a cell equal to 'key'.
+ *
+ * Parameters:
+ *   vec - Vector pointer (sorted by 'cmp')
+ *   key - Pointer to the value to search for
+ *   cmp - Comparator the vector was sorted with
+ *
+ * Returns:
+ *   Pointer to the first matching cell inside the vector, or NULL
+ */
+void *vecBinarySearch(Vector *vec, const void *key, int (*cmp)(const void *, const void *));
+
+
+/**
+ * DU_VECTOR_DEFINE:
+ *   Generates a vector type 'Name' holding elements of type 'T', with
+ *   the element size known at compile time. Element access compiles
+ *   to plain loads and stores, so loops over Name_data() optimize like
+ *   loops over a raw array. Growth matches vecPush (start at 4, double).
+ *
+ *       DU_VECTOR_DEFINE(IntVec, int)
+ *
+ *       IntVec v;
+ *       IntVec_init(&v);
+ *       IntVec_push(&v, 42);
+ *       int x = *IntVec_at(&v, 0);
+ *       IntVec_free(&v);
+ *
+ * Generated functions (all static inline):
+ *   Name_init(v)            - Initializes an empty vector (no allocation)
+ *   Name_free(v)            - Frees the buffer and empties the vector
+ *   Name_reserve(v, cap)    - Ensures room for 'cap' elements
+ *   Name_push(v, val)       - Appends 'val', false if reallocation failed
+ *   Name_extend(v, src, n)  - Appends 'n' elements from 'src'
+ *   Name_pop(v)             - Removes and returns the last element
+ *   Name_at(v, idx)         - Pointer to element 'idx' (must be < length)
+ *   Name_data(v)            - Pointer to the first element
+ *   Name_len(v)             - Number of elements
+ */
+#define DU_VECTOR_DEFINE(Name, T)                                             \
+    typedef struct {                                                          \
+        size_t    capacity;                                                   \
+        size_t      length;                                                   \
+        T *         data;                                                     \
+    } Name;                                                                   \
+                                                                              \
+    static inline void Name##_init(Name *v) {                                 \
+        v->capacity = 0;                                                      \
+        v->length = 0;                                                        \
+        v->data = NULL;                                                       \
+    }                                                                         \
+                                                                              \
+    static inline void Name##_free(Name *v) {                                 \
+        duFree(v->data);                                                      \
+        Name##_init(v);                                                       \
+    }                                                                         \
+                                                                              \
+    static inline bool Name##_grow(Name *v, size_t min_cap) {                 \
+        if (min_cap <= v->capacity) return true;                              \
+        if (min_cap > SIZE_MAX / sizeof(T)) return false;                     \
+        size_t cap = v->capacity ? v->capacity : 4;                           \
+        while (cap < min_cap) cap = cap > SIZE_MAX / 2 ? min_cap : cap * 2;   \
+        if (cap > SIZE_MAX / sizeof(T)) cap = min_cap;                        \
+        T *temp = (T *)duRealloc(v->data, sizeof(T) * cap);                   \
+        if (!temp) return false;                                              \
+        v->data = temp;                                                       \
+        v->capacity = cap;                                                    \
+        return true;                                                          \
+    }                                                                         \
+                                                                              \
+    static inline bool Name##_reserve(Name *v, size_t cap) {                  \
+        if (cap <= v->capacity) return true;                                  \
+        if (cap > SIZE_MAX / sizeof(T)) return false;                         \
+        T *temp = (T *)duRealloc(v->data, sizeof(T) * cap);                   \
+        if (!temp) return false;                                              \
+        v->data = temp;                                                       \
+        v->capacity = cap;                                                    \
+        return true;                                                          \
+    }                                                                         \
+                                                                              \
+    static inline bool Name##_push(Name *v, T val) {                          \
+        if (v->length == v->capacity                                          \
+                && !Name##_grow(v, v->length + 1)) return false;              \
+        v->data[v->length++] = val;                                           \
+        return true;                                                          \
+    }                                                                         \
+                                                                              \
+    static inline bool Name##_extend(Name *v, const T *src, size_t n) {       \
+        if (n > SIZE_MAX - v->length) return false;                           \
+        if (!Name##_grow(v, v->length + n)) return false;                     \
+        if (n) memcpy(v->data + v->length, src, sizeof(T) * n);               \
+        v->length += n;                                                       \
+        return true;                                                          \
+    }                                                                         \
+                                                                              \
+    static inline T Name##_pop(Name *v) {                                     \
+        assert(v->length > 0);                                                \
+        return v->data[--v->length];                                          \
+    }                                                                         \
+                                                                              \
+    static inline T *Name##_at(Name *v, size_t idx) {                         \
+        assert(idx < v->length);                                              \
+        return &v->data[idx];                                                 \
+    }                                                                         \
+                                                                              \
+    static inline T *Name##_data(Name *v) {                                   \
+        return v->data;                                                       \
+    }                                                                         \
+                                                                              \
+    static inline size_t Name##_len(const Name *v) {                          \
+        return v->length;                                                     \
+    }
+
+#endif // DU_VECTOR_H
+#endif // DU_VECTOR
+
+
+#ifdef DU_DICT
+#ifndef DU_DICT_H
+#define DU_DICT_H
+/* =====================================================================
+ *
+ * HASHMAP OPERATIONS
+ *
+ * =====================================================================
+ */
+
+#define DU_NBUCKET_SMALL    32
+#define DU_NBUCKET_MEDIUM  128
+#define DU_NBUCKET_BIG    1024
+#define DU_NBUCKET_LARGE  4096
+
+// The table grows once it is more than DU_DICT_LOAD_NUM / DU_DICT_LOAD_DEN full
+#define DU_DICT_LOAD_NUM     7
+#define DU_DICT_LOAD_DEN     8
+
+// Number of old slots moved to the new table by each dictSet while growing
+#define DU_DICT_REHASH_STEP 32
+
+// Flags for dictNewEx
+#define DU_DICT_COPY_KEYS  0x1  // Copy key bytes into the dictionary's own arena
+
+// Size of one key arena block (larger keys get a block of their own)
+#define DU_DICT_BLOCK_SIZE 4096
+
+// A block of the key arena, key bytes follow the header
+typedef struct dict_block_s {
+    struct dict_block_s *next;  // Previously filled block
+    size_t               used;  // Bytes handed out from this block
+    size_t               cap;   // Usable bytes in this block
+} DictBlock;
+
+// A single slot in the dictionary's flat entry array
+typedef struct entry_s {
+    void            *key;      // Pointer to the key
+    size_t           key_len;  // Length of the key in bytes
+    uint64_t         hash;     // Full hash of the key
+    void            *val;      // Pointer to the value
+} DictEntry;
+
+#ifdef DU_STATS
+// Per-dictionary counters kept with DU_STATS. Lookups update them without
+// synchronization, so on ConcurrentDictionary shards they are approximate.
+typedef struct {
+    uint64_t lookups;     // Probes of a table by get/set/remove
+    uint64_t probes;      // Slots inspected by those probes
+    uint64_t probe_hist[DU_STATS_HIST]; // Probes by slots inspected
+    uint64_t inserts;     // New keys stored
+    uint64_t collisions;  // New keys that could not take their home slot
+    uint64_t grows;       // Table doublings
+    uint64_t purges;      // Same-size rebuilds to drop tombstones
+    uint32_t initial_size; // Slots the dictionary was created with
+} DictCounters;
+#endif // DU_STATS
+
+// Hash table mapping arbitrary byte-sequence keys to values.
+// Uses open addressing with linear probing and one control byte per
+// slot, which is empty, a tombstone, or holds 7 bits of the key's hash.
+// Keys are hashed with a random seed chosen once per process, so crafted
+// keys cannot be aimed at a single slot.
+//
+// Growing is incremental: the previous table is kept as 'old_*' and
+// drained a few slots per dictSet, lookups check both until it is empty.
+// The one remaining pause is freeing the drained table, a single call
+// into the allocator: with malloc, tables of millions of slots go back
+// to the OS with munmap and that dictSet can take milliseconds. Use
+// dictReserve before a bulk load, or an arena (dictNewA), to avoid it.
+typedef struct dict_s {
+    DictEntry       *entries;  // Flat array of slots
+    uint8_t         *ctrl;     // Control byte for each slot
+    uint32_t         size;     // Number of slots (always a power of two)
+    uint32_t         count;    // Number of live entries in both tables
+    uint32_t         used;     // Live entries plus tombstones in 'entries'
+    DictEntry       *old_entries; // Table being drained (NULL if none)
+    uint8_t         *old_ctrl;    // Control bytes of the old table
+    uint32_t         old_size;    // Number of slots in the old table
+    uint32_t         rehash_idx;  // Next old slot to move
+    uint64_t         seed;     // Process-wide seed of the key hash
+    uint32_t         flags;    // DU_DICT_* flags given to dictNewEx
+    DictBlock       *blocks;   // Key arena (only with DU_DICT_COPY_KEYS)
+    const DuAllocator *alloc;  // Allocator for the tables, blocks and header
+    void           (*free_key)(void *); // Callback to free keys
+    void           (*free_val)(void *); // Callback to free values
+#ifdef DU_STATS
+    DictCounters     stats;    // Live counters, see dictStats
+#endif
+} Dictionary;
+
+
+/**
+ * dictNew:
+ *   Creates a new dictionary. The table grows automatically as
+ *   entries are added, so 'size' is only the initial capacity.
+ *
+ * Parameters:
+ *   size     - Initial number of slots (use DU_NBUCKET_*),
+ *              rounded up to a power of two
+ *   free_key - Callback to free keys when removed or replaced
+ *   free_val - Callback to free values when removed or replaced
+ *
+ * Returns:
+ *   Pointer to a new Dictionary on success.
+ *   NULL on allocation failure.
+ */
+Dictionary *dictNew(uint32_t size, void (*free_key)(void *), void (*free_val)(void *));
+
+
+/**
+ * dictNewEx:
+ *   Same as dictNew, with extra DU_DICT_* flags.
+ *
+ *   With DU_DICT_COPY_KEYS every new key is copied into blocks owned by
+ *   the dictionary, so the caller's key buffer may be reused right
+ *   after dictSet returns. free_key is never called for copied keys;
+ *   their blocks are released all at once by dictClear/dictFree.
+ *
+ * Parameters:
+ *   size     - Initial number of slots (use DU_NBUCKET_*)
+ *   flags    - Bitwise OR of DU_DICT_* flags (0 = same as dictNew)
+ *   free_key - Callback to free keys when removed or replaced
+ *   free_val - Callback to free values when removed or replaced
+ *
+ * Returns:
+ *   Pointer to a new Dictionary on success.
+ *   NULL on allocation failure.
+ */
+Dictionary *dictNewEx(uint32_t size, uint32_t flags,
+                      void (*free_key)(void *), void (*free_val)(void *));
+
+
+/**
+ * dictNewWith:
+ *   Same as dictNewEx, allocating the dictionary, its tables and its key
+ *   blocks from 'alloc'. Keys and values themselves are still the caller's.
+ *
+ * Parameters:
+ *   alloc    - Allocator to use (NULL = the global allocator);
+ *              must outlive the dictionary
+ *   size     - Initial number of slots, rounded up to a power of two
+ *   flags    - DU_DICT_* flags (0 for none)
+ *   free_key - Callback to free keys when removed or replaced
+ *   free_val - Callback to free values when removed or replaced
+ *
+ * Returns:
+ *   Pointer to a new Dictionary on success.
+ *   NULL on allocation failure.
+ */
+Dictionary *dictNewWith(const DuAllocator *alloc, uint32_t size, uint32_t flags,
+                        void (*free_key)(void *), void (*free_val)(void *));
+
+
+/**
+ * dictSet:
+ *   Inserts or updates a key/value pair in the dictionary.
+ *
+ * Parameters:
+ *   dict    - Target dictionary.
+ *   key     - Key pointer (will be copied as-is, not duplicated).
+ *   key_len - Length of the key in bytes.
+ *   val     - Value pointer.
+ */
+void dictSet(Dictionary *dict, void *key, size_t key_len, void *val);
+
+
+/**
+ * dictGet:
+ *   Retrieves a value by key.
+ *
+ * Parameters:
+ *   dict    - Target dictionary.
+ *   key     - Key pointer.
+ *   key_len - Length of the key in bytes.
+ *
+ * Returns:
+ *   Pointer to the stored value, or NULL if the key is not found.
+ */
+void *dictGet(Dictionary *dict, void *key, size_t key_len);
+
+
+/**
+ * dictHash:
+ *   Computes the hash dictSet/dictGet use for a key.
+ *   The result can be passed to the *Hashed variants to look the key
+ *   up repeatedly while hashing it only once. Every dictionary in the
+ *   process (including ConcurrentDictionary shards) shares one random
+ *   seed, so the hash can be reused with any of them, e.g. to look the
+ *   same key up in several dictionaries.
+ *
+ * Parameters:
+ *   dict    - Any dictionary (they all hash alike).
+ *   key     - Key pointer.
+ *   key_len - Length of the key in bytes.
+ *
+ * Returns:
+ *   The 64-bit hash of the key.
+ */
+uint64_t dictHash(const Dictionary *dict, const void *key, size_t key_len);
+
+
+/**
+ * dictSetHashed:
+ *   Same as dictSet, using a hash previously returned by dictHash
+ *   (asserted when DU_DICT_CHECK_HASH is defined).
+ *
+ * Parameters:
+ *   dict    - Target dictionary.
+ *   key     - Key pointer (will be copied as-is, not duplicated).
+ *   key_len - Length of the key in bytes.
+ *   hash    - dictHash(dict, key, key_len).
+ *   val     - Value pointer.
+ */
+void dictSetHashed(Dictionary *dict, void *key, size_t key_len, uint64_t hash, void *val);
+
+
+/**
+ * dictGetHashed:
+ *   Same as dictGet, using a hash previously returned by dictHash
+ *   (asserted when DU_DICT_CHECK_HASH is defined).
+ *
+ * Parameters:
+ *   dict    - Target dictionary.
+ *   key     - Key pointer.
+ *   key_len - Length of the key in bytes.
+ *   hash    - dictHash(dict, key, key_len).
+ *
+ * Returns:
+ *   Pointer to the stored value, or NULL if the key is not found.
+ */
+void *dictGetHashed(Dictionary *dict, void *key, size_t key_len, uint64_t hash);
+
+
+/**
+ * dictRemove:
+ *   Removes a key, calling free_key/free_val on the stored entry.
+ *
+ * Parameters:
+ *   dict    - Target dictionary.
+ *   key     - Key pointer.
+ *   key_len - Length of the key in bytes.
+ *
+ * Returns:
+ *   true if the key was found and removed, false otherwise.
+ */
+bool dictRemove(Dictionary *dict, void *key, size_t key_len);
+
+
+/**
+ * dictCount:
+ *   Returns the number of entries stored in the dictionary.
+ *
+ * Parameters:
+ *   dict - Target dictionary.
+ *
+ * Returns:
+ *   Number of keys
+ */
+uint32_t dictCount(const Dictionary *dict);
+
+
+/**
+ * dictReserve:
+ *   Makes room for at least 'n' entries, so a bulk load of that many
+ *   keys does not grow the table again. Existing entries are moved
+ *   incrementally as with ordinary growth, but a growth still being
+ *   drained when dictReserve is called is finished first, in one go.
+ *
+ * Parameters:
+ *   dict - Target dictionary.
+ *   n    - Number of entries to make room for.
+ *
+ * Returns:
+ *   true on success, false if allocation failed.
+ */
+bool dictReserve(Dictionary *dict, uint32_t n);
+
+
+/**
+ * dictNext:
+ *   Iterates over all entries in no particular order.
+ *
+ *       size_t cursor = 0;
+ *       DictEntry *e;
+ *       while ((e = dictNext(dict, &cursor))) { ... }
+ *
+ *   The returned entry may be removed with dictRemove (or its value
+ *   changed) during the loop. dictSet, dictReserve and dictClear move
+ *   entries and must not be called until iteration ends.
+ *
+ * Parameters:
+ *   dict   - Target dictionary.
+ *   cursor - Iteration state, set to 0 before the first call.
+ *
+ * Returns:
+ *   Pointer to the next entry, or NULL when all have been visited.
+ */
+DictEntry *dictNext(Dictionary *dict, size_t *cursor);
+
+
+/**
+ * dictClear:
+ *   Removes all entries but keeps the table and one key arena block,
+ *   so the dictionary can be refilled without allocating again.
+ *
+ * Parameters:
+ *   dict - Target dictionary.
+ */
+void dictClear(Dictionary *dict);
+
+
+/**
+ * dictFree:
+ *   Frees a dictionary and all of its contents.
+ *
+ * Parameters:
+ *   dict - Target dictionary.
+ */
+void dictFree(Dictionary *dict);
+
+
+#ifdef DU_ARENA
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// In order to use this functionality you must define DU_ARENA
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+/**
+ * dictNewA:
+ *   Creates a dictionary living entirely in 'arena': the header, the slot
+ *   tables and (DU_DICT_COPY_KEYS is implied) copies of the keys. Values
+ *   are stored as given. There is no need to call dictFree; the dictionary
+ *   is released with the arena.
+ *
+ * Parameters:
+ *   arena - Arena to allocate from.
+ *   size  - Initial number of slots, rounded up to a power of two.
+ *   flags - Extra DU_DICT_* flags (0 for none).
+ *
+ * Returns:
+ *   Pointer to a new Dictionary on success.
+ *   NULL on allocation failure.
+ */
+Dictionary *dictNewA(Arena *arena, uint32_t size, uint32_t flags);
+
+#endif // DU_ARENA
+
+
+#ifdef DU_STATS
+
+// Snapshot returned by dictStats
+typedef struct {
+    uint32_t count;       // Live entries
+    uint32_t size;        // Slots in the current table
+    uint32_t old_size;    // Slots in the table still being drained (0 if none)
+    uint32_t tombstones;  // Deleted slots in the current table
+    double   load;        // (live + tombstones) / size of the current table
+    uint32_t max_chain;   // Most slots a hit on a stored key inspects
+    double   avg_chain;   // Average of the same over all stored keys
+    uint64_t chain_hist[DU_STATS_HIST]; // Stored keys by slots a hit inspects
+    DictCounters counters; // Live counters since creation or dictStatsReset
+} DictStats;
+
+/**
+ * dictStats:
+ *   Scans the dictionary and fills 'out' with its load, tombstones and
+ *   chain-length histogram, plus the live counters. Long chains or
+ *   frequent grows from a small initial size point at a badly sized
+ *   DU_NBUCKET_* value. The scan is O(size).
+ *
+ * Parameters:
+ *   dict - Target dictionary.
+ *   out  - Receives the statistics.
+ */
+void dictStats(const Dictionary *dict, DictStats *out);
+
+/**
+ * dictStatsReset:
+ *   Zeroes the live counters of a dictionary (initial_size is kept).
+ *
+ * Parameters:
+ *   dict - Target dictionary.
+ */
+void dictStatsReset(Dictionary *dict);
+
+#endif // DU_STATS
+
+
+#ifdef DU_DICT_CONCURRENT
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// In order to use this functionality you must define
+// DU_DICT_CONCURRENT and link with pthreads.
+// Under strict ISO modes also define _POSIX_C_SOURCE >= 200112L.
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+// Strict ISO modes hide pthread_rwlock_t unless a POSIX level is requested
+#if defined(__STRICT_ANSI__) && !defined(_GNU_SOURCE) && !defined(_DEFAULT_SOURCE) \
+        && !(defined(_POSIX_C_SOURCE) && _POSIX_C_SOURCE >= 200112L) \
+        && !(defined(_XOPEN_SOURCE) && _XOPEN_SOURCE >= 600)
+#error "DU_DICT_CONCURRENT needs POSIX rwlocks: define _POSIX_C_SOURCE >= 200112L before any #include"
+#endif
+
+#include <pthread.h>
+
+#define DU_CDICT_SHARDS     64
+#ifndef DU_CACHE_LINE
+#define DU_CACHE_LINE       64
+#endif
+
+// One shard: a plain Dictionary behind its own reader/writer lock,
+// padded so neighbouring shard locks never share a cache line.
+typedef struct cdict_shard_s {
+    pthread_rwlock_t  lock;   // Readers share, writers are exclusive
+    Dictionary       *dict;   // The shard's entries
+    char              pad[DU_CACHE_LINE
+                          - (sizeof(pthread_rwlock_t) + sizeof(Dictionary *)) % DU_CACHE_LINE];
+} ConcurrentDictShard;
+
+// Thread-safe dictionary, split into shards by the top bits of the key hash
+typedef struct cdict_s {
+    ConcurrentDictShard *shards;  // Array of shards, cache-line aligned
+    void                *shards_mem; // Allocation holding 'shards'
+    uint64_t             seed;    // Hash seed (the one all dictionaries share)
+    uint32_t             nshards; // Number of shards (power of two)
+    uint32_t             shift;   // 64 - log2(nshards)
+} ConcurrentDictionary;
+
+
+/**
+ * cdictNew:
+ *   Creates a new sharded, thread-safe dictionary.
+ *
+ * Parameters:
+ *   nshards  - Number of shards (0 = DU_CDICT_SHARDS), rounded up
+ *              to a power of two
+ *   size     - Initial number of slots per shard (use DU_NBUCKET_*)
+ *   free_key - Callback to free keys when removed or replaced
+ *   free_val - Callback to free values when removed or replaced
+ *
+ * Returns:
+ *   Pointer to a new ConcurrentDictionary on success.
+ *   NULL on allocation failure.
+ */
+ConcurrentDictionary *cdictNew(uint32_t nshards, uint32_t size,
+                               void (*free_key)(void *), void (*free_val)(void *));
+
+
+/**
+ * cdictSet:
+ *   Inserts or updates a key/value pair. Only the key's shard is locked.
+ *
+ * Parameters:
+ *   cdict   - Target dictionary.
+ *   key     - Key pointer (will be copied as-is, not duplicated).
+ *   key_len - Length of the key in bytes.
+ *   val     - Value pointer.
+ */
+void cdictSet(ConcurrentDictionary *cdict, void *key, size_t key_len, void *val);
+
+
+/**
+ * cdictGet:
+ *   Retrieves a value by key. Readers of the same shard do not block
+ *   each other, only a concurrent writer to that shard does.
+ *
+ * Parameters:
+ *   cdict   - Target dictionary.
+ *   key     - Key pointer.
+ *   key_len - Length of the key in bytes.
+ *
+ * Returns:
+ *   Pointer to the stored value, or NULL if the key is not found.
+ *   NOTE: The value is not protected once returned; a concurrent
+ *         cdictSet on the same key may free it through free_val.
+ */
+void *cdictGet(ConcurrentDictionary *cdict, void *key, size_t key_len);
+
+
+/**
+ * cdictFree:
+ *   Frees the dictionary and all of its contents.
+ *   Must not be called while other threads still use it.
+ *
+ * Parameters:
+ *   cdict - Target dictionary.
+ */
+void cdictFree(ConcurrentDictionary *cdict);
+
+#endif // DU_DICT_CONCURRENT
+
+#endif // DU_DICT_H
+#endif // DU_DICT
+
+
+#ifdef DU_ARGS
+#ifndef DU_ARGS_H
+#define DU_ARGS_H
+/* =====================================================================
+ *
+ * CLI ARGUMENT PARSING
+ *
+ * =====================================================================
+ */
+
+
+/**
+ * ArgType:
+ *   Enumerates the supported argument types.
+ */
+typedef enum {
+    DU_ARG_BOL,   // Boolean flag (true if present)
+    DU_ARG_INT,   // Integer argument
+    DU_ARG_DBL,   // Double/float argument
+    DU_ARG_STR,   // String argument
+    DU_ARG_END    // Marks the end of an ArgSpec array
+} ArgType;
+
+/**
+ * ArgSpec:
+ *   Describes one command-line argument option.
+ */
+typedef struct {
+    const char *s_rep;   // Short option name (e.g., "h") or NULL
+    const char *l_rep;   // Long option name (e.g., "help") or NULL
+    const char *help;    // Help text (can be NULL)
+    void       *out;     // Pointer to storage for the parsed value
+    ArgType     type;    // Argument type
+    bool        is_req;  // Whether this argument is required
+} ArgSpec;
+
+// For the following macros:
+// - sr   = short option (e.g., "h")
+// - lr   = long option (e.g., "help")
+// - o    = pointer to storage for the value
+// - h    = help description
+// - ir   = whether the argument is required
+
+// ARG_BOOL: Define a boolean flag argument.
+#define ARG_BOOL(sr, lr, o, h, ir) \
+    ((ArgSpec){ (sr), (lr), (h), (o), DU_ARG_BOL, (ir) })
+
+// ARG_INT: Define an integer argument.
+#define ARG_INT(sr, lr, o, h, ir) \
+    ((ArgSpec){ (sr), (lr), (h), (o), DU_ARG_INT, (ir) })
+
+// ARG_DOUBLE: Define a floating-point argument.
+#define ARG_DOUBLE(sr, lr, o, h, ir) \
+    ((ArgSpec){ (sr), (lr), (h), (o), DU_ARG_DBL, (ir) })
+
+// ARG_STRING: Define a string argument.
+#define ARG_STRING(sr, lr, o, h, ir) \
+    ((ArgSpec){ (sr), (lr), (h), (o), DU_ARG_STR, (ir) })
+
+// ARG_END: Marks the end of the argument specification array.
+// Must be placed as the last element in ArgSpec array.
+#define ARG_END() \
+    ((ArgSpec){NULL, NULL, NULL, NULL, DU_ARG_END, false})
+
+
+// Lookup tables compiled from an ArgSpec array: a 256-entry table for
+// short names and an open-addressing hash table for long names, so each
+// argument is resolved in a single lookup however many options there are.
+// Build it once with argParserNew and reuse it for any number of parses.
+typedef struct arg_parser_s ArgParser;
+
+
+/**
+ * parseArgs:
+ *   Parses command-line arguments according to the given specification array.
+ *   Builds a temporary ArgParser; use argParserNew to parse repeatedly.
+ *
+ *   Accepted forms:
+ *     -x          short option (any character of s_rep)
+ *     -abc        combined short options; a value-taking option ends the
+ *                 group and takes the rest ("-n5") or the next argument
+ *     --name      long option (any comma-separated alias in l_rep)
+ *     --name=val  long option with an inline value
+ *     name        bare word equal to the whole l_rep
+ *   Unrecognized arguments are ignored.
+ *
+ * Parameters:
+ *   ctx   - Pointer to an ArgSpec array describing expected arguments.
+ *           Must be terminated with ARG_END().
+ *   argc  - Argument count from main().
+ *   argv  - Argument vector from main().
+ *
+ *
+ * Returns:
+ *   true  if parsing succeeded with all requirements met.
+ *   false if an error occurred.
+ */
+bool parseArgs(ArgSpec *ctx, int argc, char **argv);
+
+
+/**
+ * argParserNew:
+ *   Compiles the lookup tables for a specification array. When a name is
+ *   given by several specs, the first one wins.
+ *
+ * Parameters:
+ *   ctx - Pointer to an ArgSpec array (must be terminated with ARG_END()).
+ *         It must outlive the parser.
+ *
+ * Returns:
+ *   Pointer to the new parser, or NULL on allocation failure.
+ */
+ArgParser *argParserNew(ArgSpec *ctx);
+
+
+/**
+ * argParserParse:
+ *   Same as parseArgs, using a prebuilt parser.
+ *
+ * Parameters:
+ *   parser - Parser from argParserNew.
+ *   argc   - Argument count from main().
+ *   argv   - Argument vector from main().
+ *
+ * Returns:
+ *   true  if parsing succeeded with all requirements met.
+ *   false if an error occurred.
+ */
+bool argParserParse(ArgParser *parser, int argc, char **argv);
+
+
+// argParserParseEx flag: an argument "@path" is replaced by the arguments
+// read from the file at 'path'. See argParserParseEx.
+#define DU_ARGS_RESPONSE_FILES 0x1
+
+#ifdef DU_VECTOR
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// In order to use this functionality you must define DU_VECTOR
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+/**
+ * argParserParseEx:
+ *   Same as argParserParse, also collecting positional arguments (those not
+ *   consumed as options or option values, plus everything after "--") in
+ *   the same pass. Nothing is copied: the collected char * point into argv
+ *   or into a response file.
+ *
+ *   With DU_ARGS_RESPONSE_FILES, "@path" arguments are expanded in place
+ *   of the '@' argument. The file is memory-mapped copy-on-write and
+ *   tokenized in it; tokens are separated by whitespace, may be quoted
+ *   with '...' or "...", and a backslash escapes the next character
+ *   (outside single quotes). '@' tokens inside a response file are not
+ *   expanded again, and neither are arguments after "--" (given directly
+ *   or inside a response file). Strings taken from a response file stay
+ *   valid until argParserFree.
+ *
+ * Parameters:
+ *   parser     - Parser from argParserNew.
+ *   argc       - Argument count from main().
+ *   argv       - Argument vector from main().
+ *   flags      - DU_ARGS_* flags (0 for none).
+ *   positional - Vector with cells of sizeof(char *) receiving the
+ *                positional arguments in order, or NULL to ignore them.
+ *
+ * Returns:
+ *   true  if parsing succeeded with all requirements met.
+ *   false if an error occurred (including an unreadable response file).
+ */
+bool argParserParseEx(ArgParser *parser, int argc, char **argv, uint32_t flags, Vector *positional);
+
+#endif // DU_VECTOR
+
+
+/**
+ * argParserFree:
+ *   Frees a parser (not the ArgSpec array it was built from).
+ *
+ * Parameters:
+ *   parser - Parser to free (may be NULL).
+ */
+void argParserFree(ArgParser *parser);
+
+
+/**
+ * printHelp:
+ *   Prints usage information for the program based on the argument
+ *   specification array.
+ *
+ * Parameters:
+ *   progName - Name of the program (usually argv[0]).
+ *   ctx      - Pointer to an ArgSpec array (must be terminated with ARG_END()).
+ */
+void printHelp(const char *progName, ArgSpec *ctx);
+
+#endif // DU_ARGS_H
+#endif // DU_ARGS
+
+
+#ifdef DU_STRINGS
+#ifndef DU_STRINGS_H
+#define DU_STRINGS_H
+/* =====================================================================
+ *
+ * STRING UTILITIES
+ *
+ * =====================================================================
+ */
+
+
+/**
+ * strTrim:
+ *   Removes whitespace from both ends of the string in-place.
+ *
+ * Parameters:
+ *   s - string to trim
+ *
+ * Returns:
+ *   Pointer to the trimmed string (same as input)
+ */
+char *strTrim(char *s);
+
+
+/**
+ * strLTrim:
+ *   Removes whitespace from the start of the string in-place.
+ *
+ * Parameters:
+ *   s - string to trim
+ *
+ * Returns:
+ *   Pointer to the trimmed string (same as input)
+ */
+char *strLTrim(char *s);
+
+
+/**
+ * strRTrim:
+ *   Removes whitespace from the end of the string in-place.
+ *
+ * Parameters:
+ *   s - string to trim
+ *
+ * Returns:
+ *   Pointer to the trimmed string (same as input)
+ */
+char *strRTrim(char *s);
+
+
+/**
+ * strReplace:
+ *   Replaces all occurrences of `needle` in `s` with `replacement`.
+ *
+ * Parameters:
+ *   s           - input string
+ *   needle      - substring to replace
+ *   replacement - string to insert
+ *
+ * Returns:
+ *   Newly allocated string; caller must free
+ */
+char *strReplace(const char *s, const char *needle, const char *replacement);
+
+
+/**
+ * strToLower:
+ *   Converts the string to lowercase in-place.
+ *
+ * Parameters:
+ *   s - string to convert
+ *
+ * Returns:
+ *   Pointer to the converted string (same as input)
+ */
+char *strToLower(char *s);
+
+
+/**
+ * strToUpper:
+ *   Converts the string to uppercase in-place.
+ *
+ * Parameters:
+ *   s - string to convert
+ *
+ * Returns:
+ *   Pointer to the converted string (same as input)
+ */
+char *strToUpper(char *s);
+
+
+/**
+ * strStartsWith:
+ *   Checks if the string starts with the given prefix.
+ *
+ * Parameters:
+ *   s      - string to check
+ *   prefix - prefix to test
+ *
+ * Returns:
+ *   true if `s` starts with `prefix`, false otherwise
+ */
+bool strStartsWith(const char *s, const char *prefix);
+
+
+/**
+ * strEndsWith:
+ *   Checks if the string ends with the given suffix.
+ *
+ * Parameters:
+ *   s      - string to check
+ *   suffix - suffix to test
+ *
+ * Returns:
+ *   true if `s` ends with `suffix`, false otherwise
+ */
+bool strEndsWith(const char *s, const char *suffix);
+
+
+/**
+ * strSlice:
+ *   Returns a newly allocated substring from `start` to `end` (exclusive).
+ *   Negative indices count from the end of the string.
+ *
+ * Parameters:
+ *   s     - input string
+ *   start - starting index
+ *   end   - ending index (exclusive)
+ *
+ * Returns:
+ *   Newly allocated substring; caller must free
+ */
+char *strSlice(const char *s, size_t start, size_t end);
+
+
+/**
+ * strCount:
+ *   Counts the number of occurrences of `needle` in `s`.
+ *
+ * Parameters:
+ *   s      - string to search
+ *   needle - substring to count
+ *
+ * Returns:
+ *   Number of occurrences
+ */
+size_t strCount(const char *s, const char *needle);
+
+
+/**
+ * strDup:
+ *   Returns a newly allocated copy of the string.
+ *
+ * Parameters:
+ *   s - string to duplicate
+ *
+ * Returns:
+ *   Newly allocated string; caller must free
+ */
+char *strDup(const char *s);
+
+
+/**
+ * strRev:
+ *   Reverses the string in-place.
+ *
+ * Parameters:
+ *   s - string to reverse
+ *
+ * Returns:
+ *   Pointer to the reversed string (same as input)
+ */
+char *strRev(char *s);
+
+
+// Non-owning view of 'len' bytes at 'p', not necessarily NUL-terminated.
+// Views never allocate; they stay valid as long as the viewed buffer does.
+typedef struct {
+    const char *p;    // First byte of the view
+    size_t      len;  // Length of the view in bytes
+} StrView;
+
+// Iterates over the delimiter-separated tokens of a view
+typedef struct {
+    StrView rest;   // Part of the input not yet returned
+    char    delim;  // Token delimiter
+    bool    done;   // Set once the last token has been returned
+} StrTokenizer;
+
+
+/**
+ * strView:
+ *   Makes a view of a whole NUL-terminated string.
+ *
+ * Parameters:
+ *   s - string to view
+ *
+ * Returns:
+ *   View of 's' without its terminator
+ */
+StrView strView(const char *s);
+
+
+/**
+ * strViewN:
+ *   Makes a view of 'len' bytes starting at 'p'.
+ *
+ * Parameters:
+ *   p   - first byte
+ *   len - number of bytes
+ *
+ * Returns:
+ *   View of the bytes
+ */
+StrView strViewN(const char *p, size_t len);
+
+
+/**
+ * strTrimView:
+ *   Narrows a view to exclude whitespace at both ends.
+ *
+ * Parameters:
+ *   v - view to trim
+ *
+ * Returns:
+ *   Trimmed view into the same buffer
+ */
+StrView strTrimView(StrView v);
+
+
+/**
+ * strSliceView:
+ *   Returns the part of a view from `start` to `end` (exclusive).
+ *   Indices past the end of the view are clamped to it.
+ *
+ * Parameters:
+ *   v     - view to slice
+ *   start - starting index
+ *   end   - ending index (exclusive)
+ *
+ * Returns:
+ *   Sub-view into the same buffer (empty if start >= end)
+ */
+StrView strSliceView(StrView v, size_t start, size_t end);
+
+
+/**
+ * strViewEq:
+ *   Checks if two views hold the same bytes.
+ *
+ * Parameters:
+ *   a - first view
+ *   b - second view
+ *
+ * Returns:
+ *   true if the views are equal, false otherwise
+ */
+bool strViewEq(StrView a, StrView b);
+
+
+/**
+ * strViewDup:
+ *   Copies a view into a newly allocated NUL-terminated string.
+ *
+ * Parameters:
+ *   v - view to copy
+ *
+ * Returns:
+ *   Newly allocated string; caller must free (NULL on failure)
+ */
+char *strViewDup(StrView v);
+
+
+/**
+ * strTokInit:
+ *   Prepares a tokenizer over 's'. An input with N delimiters yields
+ *   N + 1 tokens, empty ones included (an empty input yields one).
+ *
+ * Parameters:
+ *   tok   - tokenizer to initialize
+ *   s     - view to split
+ *   delim - token delimiter
+ */
+void strTokInit(StrTokenizer *tok, StrView s, char delim);
+
+
+/**
+ * strTokNext:
+ *   Returns the next token as a view into the input.
+ *
+ * Parameters:
+ *   tok - initialized tokenizer
+ *   out - receives the next token
+ *
+ * Returns:
+ *   true if a token was returned, false once the input is exhausted
+ */
+bool strTokNext(StrTokenizer *tok, StrView *out);
+
+
+#include <stdarg.h>
+
+// Growable string buffer. 'buf' is NUL-terminated whenever it is non-NULL;
+// capacity at least doubles on growth so a run of appends stays amortized O(1).
+// Zero-initialize (or sbInit) before use, sbFree or sbDetach when done.
+typedef struct {
+    char   *buf;  // Contents (NULL until the first allocation)
+    size_t  len;  // Length of the contents, terminator excluded
+    size_t  cap;  // Allocated bytes, terminator included
+} StrBuilder;
+
+
+/**
+ * sbInit:
+ *   Prepares an empty builder. Nothing is allocated until the first append.
+ *
+ * Parameters:
+ *   sb - builder to initialize
+ */
+void sbInit(StrBuilder *sb);
+
+
+/**
+ * sbReserve:
+ *   Makes room for at least 'extra' more bytes without further allocation.
+ *
+ * Parameters:
+ *   sb    - builder
+ *   extra - number of bytes about to be appended
+ *
+ * Returns:
+ *   true on success, false if the buffer could not grow (contents kept)
+ */
+bool sbReserve(StrBuilder *sb, size_t extra);
+
+
+/**
+ * sbAppend:
+ *   Appends a NUL-terminated string.
+ *
+ * Parameters:
+ *   sb - builder
+ *   s  - string to append
+ *
+ * Returns:
+ *   true on success, false on allocation failure (contents kept)
+ */
+bool sbAppend(StrBuilder *sb, const char *s);
+
+
+/**
+ * sbAppendN:
+ *   Appends 'n' bytes starting at 'p'.
+ *
+ * Parameters:
+ *   sb - builder
+ *   p  - bytes to append
+ *   n  - number of bytes
+ *
+ * Returns:
+ *   true on success, false on allocation failure (contents kept)
+ */
+bool sbAppendN(StrBuilder *sb, const char *p, size_t n);
+
+
+/**
+ * sbAppendChar:
+ *   Appends a single character.
+ *
+ * Parameters:
+ *   sb - builder
+ *   c  - character to append
+ *
+ * Returns:
+ *   true on success, false on allocation failure (contents kept)
+ */
+bool sbAppendChar(StrBuilder *sb, char c);
+
+
+/**
+ * sbAppendf:
+ *   Appends printf-style formatted output, formatting straight into the
+ *   spare capacity (a second pass is needed only when it does not fit).
+ *
+ * Parameters:
+ *   sb  - builder
+ *   fmt - printf format string
+ *   ... - format arguments
+ *
+ * Returns:
+ *   true on success, false on a format or allocation error (contents kept)
+ */
+#if defined(__GNUC__)
+__attribute__((format(printf, 2, 3)))
+#endif
+bool sbAppendf(StrBuilder *sb, const char *fmt, ...);
+
+
+/**
+ * sbAppendv:
+ *   sbAppendf taking a va_list.
+ *
+ * Parameters:
+ *   sb  - builder
+ *   fmt - printf format string
+ *   ap  - format arguments
+ *
+ * Returns:
+ *   true on success, false on a format or allocation error (contents kept)
+ */
+bool sbAppendv(StrBuilder *sb, const char *fmt, va_list ap);
+
+
+/**
+ * sbReplace:
+ *   Appends 's' with every non-overlapping 'needle' replaced by 'replacement'.
+ *   An empty needle appends 's' unchanged.
+ *
+ * Parameters:
+ *   sb          - builder
+ *   s           - source string
+ *   needle      - substring to replace
+ *   replacement - replacement string
+ *
+ * Returns:
+ *   true on success, false on allocation failure (partial output kept)
+ */
+bool sbReplace(StrBuilder *sb, const char *s, const char *needle, const char *replacement);
+
+
+/**
+ * sbView:
+ *   Returns the current contents as a view (valid until the next append).
+ *
+ * Parameters:
+ *   sb - builder
+ *
+ * Returns:
+ *   View of the contents
+ */
+StrView sbView(const StrBuilder *sb);
+
+
+/**
+ * sbClear:
+ *   Empties the builder but keeps its capacity for reuse.
+ *
+ * Parameters:
+ *   sb - builder to clear
+ */
+void sbClear(StrBuilder *sb);
+
+
+/**
+ * sbDetach:
+ *   Hands the contents over to the caller and resets the builder to empty.
+ *
+ * Parameters:
+ *   sb - builder
+ *
+ * Returns:
+ *   The NUL-terminated contents; caller must free (NULL on failure).
+ *   An empty builder yields a newly allocated empty string.
+ */
+char *sbDetach(StrBuilder *sb);
+
+
+/**
+ * sbFree:
+ *   Frees the builder's buffer and resets it to empty.
+ *
+ * Parameters:
+ *   sb - builder to free
+ */
+void sbFree(StrBuilder *sb);
+
+
+#ifdef DU_VECTOR
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// In order to use this functionality you must define DU_VECTOR
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+// Splits the string 's' by delimiter 'delim'.
+// Returns a Vector of newly allocated strings; caller must free each element and the Vector.
+Vector *strSplit(const char *s, const char delim);
+
+// Splits the view 's' by delimiter 'delim', appending each token to 'out'
+// as a StrView into 's' (like strTokNext). 'out' must have cells of sizeof(StrView).
+// Returns false if 'out' could not grow.
+bool strSplitView(StrView s, const char delim, Vector *out);
+
+// Joins an array of strings 'parts' into a single string, using 'sep' as separator.
+// Returns a newly allocated string; caller must free.
+char *strJoin(const Vector *parts, const char *sep);
+
+// Appends the strings in 'parts' to 'sb', separated by 'sep'.
+// Returns false on allocation failure (partial output kept).
+bool sbJoin(StrBuilder *sb, const Vector *parts, const char *sep);
+
+#endif // DU_VECTOR
+
+#ifdef DU_ARENA
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// In order to use this functionality you must define DU_ARENA
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+// The *A variants allocate their results from an arena. The results are
+// never freed one by one; they go away with arenaReset/arenaRewind/arenaFree.
+
+// Returns a copy of 's' in 'arena' (NULL on allocation failure).
+char *strDupA(Arena *arena, const char *s);
+
+// Returns a NUL-terminated copy of the view 'v' in 'arena' (NULL on allocation failure).
+char *strViewDupA(Arena *arena, StrView v);
+
+#ifdef DU_VECTOR
+
+// Splits 's' by 'delim' like strSplit. The Vector and every token live in 'arena'.
+// Returns NULL on allocation failure.
+Vector *strSplitA(Arena *arena, const char *s, const char delim);
+
+// Joins 'parts' with 'sep' like strJoin, into 'arena'.
+// The result is built in place at the arena's top, so it is not copied as it grows.
+// Returns NULL if 'parts' is empty or on allocation failure.
+char *strJoinA(Arena *arena, const Vector *parts, const char *sep);
+
+#endif // DU_VECTOR
+
+#endif // DU_ARENA
+
+#endif // DU_STRINGS_H
+#endif // DU_STRINGS
+
+
+#ifdef DU_TUI
+#ifndef DU_TUI_H
+#define DU_TUI_H
+/* =====================================================================
+ *
+ * TERMINAL UI UTILITIES
+ *
+ * =====================================================================
+ */
+
+
+#define DU_TUI_RESET       "\x1b[0m"
+#define DU_TUI_BOLD        "\x1b[1m"
+#define DU_TUI_DIM         "\x1b[2m"
+#define DU_TUI_UNDERLINE   "\x1b[4m"
+#define DU_TUI_BLINK       "\x1b[5m"
+#define DU_TUI_REVERSE     "\x1b[7m"
+#define DU_TUI_HIDDEN      "\x1b[8m"
+
+#define DU_TUI_FG_BLACK    "\x1b[30m"
+#define DU_TUI_FG_RED      "\x1b[31m"
+#define DU_TUI_FG_GREEN    "\x1b[32m"
+#define DU_TUI_FG_YELLOW   "\x1b[33m"
+#define DU_TUI_FG_BLUE     "\x1b[34m"
+#define DU_TUI_FG_MAGENTA  "\x1b[35m"
+#define DU_TUI_FG_CYAN     "\x1b[36m"
+#define DU_TUI_FG_WHITE    "\x1b[37m"
+
+#define DU_TUI_FG_BBLACK   "\x1b[90m"
+#define DU_TUI_FG_BRED     "\x1b[91m"
+#define DU_TUI_FG_BGREEN   "\x1b[92m"
+#define DU_TUI_FG_BYELLOW  "\x1b[93m"
+#define DU_TUI_FG_BBLUE    "\x1b[94m"
+#define DU_TUI_FG_BMAGENTA "\x1b[95m"
+#define DU_TUI_FG_BCYAN    "\x1b[96m"
+#define DU_TUI_FG_BWHITE   "\x1b[97m"
+
+#define DU_TUI_BG_BLACK    "\x1b[40m"
+#define DU_TUI_BG_RED      "\x1b[41m"
+#define DU_TUI_BG_GREEN    "\x1b[42m"
+#define DU_TUI_BG_YELLOW   "\x1b[43m"
+#define DU_TUI_BG_BLUE     "\x1b[44m"
+#define DU_TUI_BG_MAGENTA  "\x1b[45m"
+#define DU_TUI_BG_CYAN     "\x1b[46m"
+#define DU_TUI_BG_WHITE    "\x1b[47m"
+
+#define DU_TUI_BG_BBLACK   "\x1b[100m"
+#define DU_TUI_BG_BRED     "\x1b[101m"
+#define DU_TUI_BG_BGREEN   "\x1b[102m"
+#define DU_TUI_BG_BYELLOW  "\x1b[103m"
+#define DU_TUI_BG_BBLUE    "\x1b[104m"
+#define DU_TUI_BG_BMAGENTA "\x1b[105m"
+#define DU_TUI_BG_BCYAN    "\x1b[106m"
+#define DU_TUI_BG_BWHITE   "\x1b[107m"
+
+
+/**
+ * tuiSetColor:
+ *   Sets the foreground and/or background color for text output.
+ *
+ * Parameters:
+ *   foreground - ANSI escape code string for foreground color (e.g., DU_TUI_RED)
+ *   background - ANSI escape code string for background color
+ */
+void tuiSetColor(const char *foreground, const char *background);
+
+/**
+ * tuiReset:
+ *   Resets text formatting and colors to defaults.
+ */
+void tuiReset(void);
+
+/**
+ * tuiCursorUp:
+ *   Moves the cursor up by `n` lines.
+ *
+ * Parameters:
+ *   n - number of lines to move up
+ */
+void tuiCursorUp(uint8_t n);
+
+/**
+ * tuiCursorDown:
+ *   Moves the cursor down by `n` lines.
+ *
+ * Parameters:
+ *   n - number of lines to move down
+ */
+void tuiCursorDown(uint8_t n);
+
+/**
+ * tuiCursorRight:
+ *   Moves the cursor right by `n` columns.
+ *
+ * Parameters:
+ *   n - number of columns to move right
+ */
+void tuiCursorRight(uint8_t n);
+
+/**
+ * tuiCursorLeft:
+ *   Moves the cursor left by `n` columns.
+ *
+ * Parameters:
+ *   n - number of columns to move left
+ */
+void tuiCursorLeft(uint8_t n);
+
+/**
+ * tuiCursorPos:
+ *   Moves the cursor to absolute position (x, y).
+ *
+ * Parameters:
+ *   x - column number (1-based)
+ *   y - row number (1-based)
+ */
+void tuiCursorPos(uint16_t x, uint16_t y);
+
+/**
+ * tuiHideCursor:
+ *   Hides the terminal cursor.
+ */
+void tuiHideCursor(void);
+
+/**
+ * tuiShowCursor:
+ *   Shows the terminal cursor if it was hidden.
+ */
+void tuiShowCursor(void);
+
+/**
+ * tuiClearScreen:
+ *   Clears the terminal screen and moves cursor to top-left.
+ */
+void tuiClearScreen(void);
+
+
+// Initial capacity of a TuiFrame buffer; it grows as needed
+#ifndef DU_TUI_FRAME_INIT
+#define DU_TUI_FRAME_INIT 4096
+#endif
+
+// Output buffer for one screen update. While a frame is active every tui*
+// call (and tuiWrite) appends to it instead of printing, and tuiFlush sends
+// the whole frame to the terminal with a single write(2).
+// Only one frame is active at a time; the tui* calls are not thread-safe.
+typedef struct {
+    char   *buf;  // Pending output
+    size_t  len;  // Pending bytes
+    size_t  cap;  // Allocated bytes
+    int     fd;   // Destination file descriptor
+} TuiFrame;
+
+/**
+ * tuiFrameBegin:
+ *   Makes 'frame' the active output buffer. Anything already buffered by
+ *   stdout is flushed first so output stays in order.
+ *
+ * Parameters:
+ *   frame - frame to activate (zero-initialized or previously used)
+ *   fd    - file descriptor the frame is written to (e.g. STDOUT_FILENO)
+ */
+void tuiFrameBegin(TuiFrame *frame, int fd);
+
+/**
+ * tuiWrite:
+ *   Outputs 'n' bytes of text, through the active frame if there is one.
+ *
+ * Parameters:
+ *   s - text to output
+ *   n - number of bytes
+ */
+void tuiWrite(const char *s, size_t n);
+
+/**
+ * tuiFlush:
+ *   Sends everything buffered in the active frame with one write(2)
+ *   (retried only if the terminal accepts a partial write). The frame stays
+ *   active and keeps its capacity for the next update.
+ *
+ * Returns:
+ *   true on success (or with no active frame), false on a write error
+ */
+bool tuiFlush(void);
+
+/**
+ * tuiFrameEnd:
+ *   Flushes and deactivates the active frame and frees its buffer.
+ *   Output goes back to unbuffered stdout.
+ *
+ * Returns:
+ *   Result of the final tuiFlush
+ */
+bool tuiFrameEnd(void);
+
+
+
+// Color values for TuiCell: 0-7 are the standard ANSI colors, 8-15 their
+// bright variants, 16-255 the rest of the 256-color palette
+#define DU_TUI_COLOR_DEFAULT 256  // Terminal's own foreground/background
+
+// TuiCell attribute bits
+#define DU_TUI_ATTR_BOLD      0x01
+#define DU_TUI_ATTR_DIM       0x02
+#define DU_TUI_ATTR_UNDERLINE 0x04
+#define DU_TUI_ATTR_BLINK     0x08
+#define DU_TUI_ATTR_REVERSE   0x10
+
+// Unchanged cells between two changed ones on a row that are rewritten
+// instead of jumping over them (a cursor move costs about as much)
+#ifndef DU_TUI_MERGE_GAP
+#define DU_TUI_MERGE_GAP 4
+#endif
+
+// One character cell. Glyphs are Unicode code points taking one column.
+typedef struct {
+    uint32_t glyph;  // Code point (0 is drawn as a space)
+    uint16_t fg;     // Foreground color (0-255 or DU_TUI_COLOR_DEFAULT)
+    uint16_t bg;     // Background color (0-255 or DU_TUI_COLOR_DEFAULT)
+    uint8_t  attr;   // DU_TUI_ATTR_* bits
+} TuiCell;
+
+// Double-buffered cell grid. Drawing goes to the back buffer; tuiScreenPresent
+// sends only the cells that differ from the front buffer (what the terminal
+// shows), then makes them the new front.
+typedef struct {
+    uint16_t  width;   // Columns
+    uint16_t  height;  // Rows
+    TuiCell  *front;   // Cells as last presented
+    TuiCell  *back;    // Cells being drawn
+    bool      full;    // Next present redraws every cell
+} TuiScreen;
+
+/**
+ * tuiScreenNew:
+ *   Creates a screen of blank cells (default colors, no attributes).
+ *   The first present draws every cell.
+ *
+ * Parameters:
+ *   width  - number of columns (> 0)
+ *   height - number of rows (> 0)
+ *
+ * Returns:
+ *   Pointer to the new screen, or NULL on allocation failure
+ */
+TuiScreen *tuiScreenNew(uint16_t width, uint16_t height);
+
+/**
+ * tuiScreenResize:
+ *   Changes the screen size. Both buffers are cleared to blank cells and
+ *   the next present redraws everything.
+ *
+ * Parameters:
+ *   scr    - screen to resize
+ *   width  - new number of columns (> 0)
+ *   height - new number of rows (> 0)
+ *
+ * Returns:
+ *   true on success, false on allocation failure (screen left unchanged)
+ */
+bool tuiScreenResize(TuiScreen *scr, uint16_t width, uint16_t height);
+
+/**
+ * tuiScreenClear:
+ *   Fills the back buffer with spaces in the given colors.
+ *
+ * Parameters:
+ *   scr - screen
+ *   fg  - foreground color
+ *   bg  - background color
+ */
+void tuiScreenClear(TuiScreen *scr, uint16_t fg, uint16_t bg);
+
+/**
+ * tuiScreenSet:
+ *   Sets one back-buffer cell. Coordinates outside the screen are ignored.
+ *
+ * Parameters:
+ *   scr   - screen
+ *   x     - column (0-based)
+ *   y     - row (0-based)
+ *   glyph - code point to draw
+ *   fg    - foreground color
+ *   bg    - background color
+ *   attr  - DU_TUI_ATTR_* bits
+ */
+void tuiScreenSet(TuiScreen *scr, uint16_t x, uint16_t y,
+                  uint32_t glyph, uint16_t fg, uint16_t bg, uint8_t attr);
+
+/**
+ * tuiScreenPrint:
+ *   Writes UTF-8 text into the back buffer starting at (x, y), one cell per
+ *   code point, clipped at the right edge. Invalid bytes become U+FFFD.
+ *
+ * Parameters:
+ *   scr  - screen
+ *   x    - starting column (0-based)
+ *   y    - row (0-based)
+ *   text - UTF-8 text
+ *   fg   - foreground color
+ *   bg   - background color
+ *   attr - DU_TUI_ATTR_* bits
+ *
+ * Returns:
+ *   Number of cells written
+ */
+size_t tuiScreenPrint(TuiScreen *scr, uint16_t x, uint16_t y, const char *text,
+                      uint16_t fg, uint16_t bg, uint8_t attr);
+
+/**
+ * tuiScreenInvalidate:
+ *   Makes the next present redraw every cell, e.g. after something else
+ *   drew over the terminal.
+ *
+ * Parameters:
+ *   scr - screen
+ */
+void tuiScreenInvalidate(TuiScreen *scr);
+
+/**
+ * tuiScreenPresent:
+ *   Draws the back buffer, emitting cursor moves and SGR changes only for
+ *   changed cells. Short gaps between changes on a row are rewritten rather
+ *   than skipped, and colors/attributes are only sent when they change.
+ *   Output goes through the active TuiFrame if there is one, so a
+ *   tuiFlush afterwards sends the update in one write.
+ *   The colors and attributes are reset at the end; the cursor is left after
+ *   the last cell drawn.
+ *
+ * Parameters:
+ *   scr - screen
+ */
+void tuiScreenPresent(TuiScreen *scr);
+
+/**
+ * tuiScreenFree:
+ *   Frees the screen and its buffers.
+ *
+ * Parameters:
+ *   scr - screen to free (may be NULL)
+ */
+void tuiScreenFree(TuiScreen *scr);
+
+#endif // DU_TUI_H
+#endif // DU_TUI
+
+
+#ifdef DU_IO
+#ifndef DU_IO_H
+#define DU_IO_H
+/* =====================================================================
+ *
+ * FILE INPUT
+ *
+ * =====================================================================
+ */
+
+#ifndef DU_STRINGS
+#error "DU_IO needs DU_STRINGS (lines are returned as StrViews)"
+#endif
+
+// Read size for files that cannot be mapped (pipes, sockets, terminals)
+#ifndef DU_IO_CHUNK
+#define DU_IO_CHUNK (1u << 20)
+#endif
+
+// Bytes of input per ioParallel chunk when 0 is passed
+#ifndef DU_IO_PARALLEL_CHUNK
+#define DU_IO_PARALLEL_CHUNK (4u << 20)
+#endif
+
+// Iterates over the lines of a view without copying. Lines end at '\n'
+// and a '\r' right before it is dropped; a last line without '\n' is
+// returned too. Newlines are found 64 bytes at a time with SSE2, AVX2
+// or AVX-512 where available.
+typedef struct {
+    const char *data;     // Text being split
+    size_t      len;      // Length of 'data'
+    size_t      pos;      // Start of the next line
+    size_t      scan;     // First byte not yet scanned for newlines
+    size_t      mask_at;  // Offset bit 0 of 'mask' refers to
+    uint64_t    mask;     // Newlines of the last scanned block not yet returned
+} IoLines;
+
+// Line reader over a file. Regular files are mapped whole and lines are
+// views into the mapping; anything else is read DU_IO_CHUNK bytes at a
+// time into a buffer that grows to fit the longest line.
+typedef struct {
+    IoLines     lines;    // Lines of the mapping, or of the filled part of 'buf'
+    int         fd;       // Descriptor being read (-1 without POSIX)
+    FILE       *fp;       // Stream being read without POSIX (else NULL)
+    bool        owns_fd;  // Close 'fd' in ioClose (opened by ioOpen)
+    bool        eof;      // Nothing more will be read into 'buf'
+    bool        error;    // A read failed, ioReadLine stopped early
+    void       *map;      // Mapping of the file, NULL when buffered
+    size_t      map_len;  // Length of the mapping
+    char       *buf;      // Buffer of the buffered mode
+    size_t      cap;      // Capacity of 'buf'
+} IoReader;
+
+
+/**
+ * ioLinesInit:
+ *   Starts iterating over the lines of 'text'.
+ *
+ * Parameters:
+ *   it   - iterator to set up
+ *   text - text to split, must outlive the iterator
+ */
+void ioLinesInit(IoLines *it, StrView text);
+
+/**
+ * ioLinesNext:
+ *   Returns the next line of the text as a view into it.
+ *
+ * Parameters:
+ *   it   - iterator
+ *   line - receives the line, without its line ending
+ *
+ * Returns:
+ *   true if a line was returned, false once the text is exhausted
+ */
+bool ioLinesNext(IoLines *it, StrView *line);
+
+/**
+ * ioOpen:
+ *   Opens a file for reading line by line.
+ *
+ * Parameters:
+ *   r    - reader to set up
+ *   path - file to open
+ *
+ * Returns:
+ *   true on success, false if the file could not be opened or on
+ *   allocation failure
+ */
+bool ioOpen(IoReader *r, const char *path);
+
+#if defined(__unix__) || defined(__APPLE__)
+/**
+ * ioOpenFd:
+ *   Same as ioOpen on an open descriptor (e.g. STDIN_FILENO), starting at
+ *   its current offset. The descriptor is not closed by ioClose.
+ *
+ * Parameters:
+ *   r  - reader to set up
+ *   fd - descriptor open for reading
+ *
+ * Returns:
+ *   true on success, false on allocation failure
+ */
+bool ioOpenFd(IoReader *r, int fd);
+#endif
+
+/**
+ * ioReadLine:
+ *   Returns the next line of the file. For mapped files the view stays
+ *   valid until ioClose; otherwise only until the next ioReadLine.
+ *   Check r->error after a false return to tell a failed read from EOF.
+ *
+ * Parameters:
+ *   r    - reader
+ *   line - receives the line, without its line ending
+ *
+ * Returns:
+ *   true if a line was returned, false at end of file or on error
+ */
+bool ioReadLine(IoReader *r, StrView *line);
+
+/**
+ * ioClose:
+ *   Unmaps or frees the reader's buffers and closes what ioOpen opened.
+ *
+ * Parameters:
+ *   r - reader to close
+ */
+void ioClose(IoReader *r);
+
+
+#ifdef DU_VECTOR
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// In order to use this functionality you must define DU_VECTOR
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+// Replaces the contents of 'fields' with the 'delim'-separated fields of
+// 'line' as views, with strSplitView semantics. Reuse one Vector (cells
+// of sizeof(StrView)) for every line and nothing is allocated once it
+// has grown to the widest line.
+// Returns false if 'fields' could not grow.
+bool ioSplitFields(StrView line, char delim, Vector *fields);
+
+#endif // DU_VECTOR
+
+
+#ifdef DU_POOL
+
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// In order to use this functionality you must define DU_POOL
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+// Called with a run of whole lines (line endings included, split them
+// with IoLines) and its index. Indices are distinct and grow with the
+// file offset.
+typedef void (*IoChunkFn)(void *ctx, size_t chunk, StrView lines);
+
+/**
+ * ioParallel:
+ *   Hands the rest of the file to 'fn' in chunks cut at line
+ *   boundaries. Chunks of a mapped file are processed on all threads of
+ *   the pool at once; a buffered file is passed one buffer of lines at a
+ *   time on the calling thread. The reader is at EOF afterwards.
+ *
+ * Parameters:
+ *   pool       - Target pool (NULL for poolDefault)
+ *   r          - reader
+ *   chunk_size - approximate bytes per chunk (0 for DU_IO_PARALLEL_CHUNK)
+ *   fn         - chunk callback, must be thread-safe for mapped files
+ *   ctx        - passed to every call to 'fn'
+ *
+ * Returns:
+ *   true on success, false if a read failed
+ */
+bool ioParallel(ThreadPool *pool, IoReader *r, size_t chunk_size, IoChunkFn fn, void *ctx);
+
+#endif // DU_POOL
+
+#endif // DU_IO_H
+#endif // DU_IO
+
+
+#ifdef DU_RING
+#ifndef DU_RING_H
+#define DU_RING_H
+/* =====================================================================
+ *
+ * RING BUFFERS
+ *
+ * =====================================================================
+ */
+
+#if !defined(__GNUC__)
+#error "DU_RING needs the GCC/Clang __atomic builtins"
+#endif
+
+#ifndef DU_CACHE_LINE
+#define DU_CACHE_LINE       64
+#endif
+
+// Flags for ringNew
+#define DU_RING_SPSC 0x0  // One producer thread and one consumer thread
+#define DU_RING_MPMC 0x1  // Any number of producers and consumers
+
+// Bounded FIFO of fixed-size records, copied in and out by value.
+// Capacity is a power of two and the producer and consumer indices sit on
+// cache lines of their own. SPSC rings need no atomic read-modify-write
+// at all; MPMC rings keep a sequence number per slot and claim a whole
+// batch of ready slots with one CAS. The Try calls never wait: a slot
+// another thread is still copying ends the batch early.
+typedef struct ring_s Ring;
+
+/**
+ * ringNew:
+ *   Creates an empty ring.
+ *
+ * Parameters:
+ *   cell_size - Size of one record in bytes
+ *   capacity  - Number of records, rounded up to a power of two
+ *   flags     - DU_RING_SPSC or DU_RING_MPMC
+ *
+ * Returns:
+ *   Pointer to the new ring, or NULL on allocation failure.
+ */
+Ring *ringNew(uint16_t cell_size, size_t capacity, uint32_t flags);
+
+/**
+ * ringNewWith:
+ *   Same as ringNew, allocating the ring from 'alloc'.
+ *
+ * Parameters:
+ *   alloc     - Allocator to use (NULL = the global allocator);
+ *               must outlive the ring
+ *   cell_size - Size of one record in bytes
+ *   capacity  - Number of records, rounded up to a power of two
+ *   flags     - DU_RING_SPSC or DU_RING_MPMC
+ *
+ * Returns:
+ *   Pointer to the new ring, or NULL on allocation failure.
+ */
+Ring *ringNewWith(const DuAllocator *alloc, uint16_t cell_size, size_t capacity, uint32_t flags);
+
+/**
+ * ringTryPushN:
+ *   Copies up to 'n' records from 'src' into the ring without waiting.
+ *   On MPMC rings the count can also be short when the next slot is
+ *   still being read by a consumer.
+ *
+ * Parameters:
+ *   ring - Target ring
+ *   src  - 'n' consecutive records of cell_size bytes
+ *   n    - Number of records
+ *
+ * Returns:
+ *   Number of records pushed (0 when the ring is full).
+ */
+size_t ringTryPushN(Ring *ring, const void *src, size_t n);
+
+/**
+ * ringTryPopN:
+ *   Copies up to 'n' of the oldest records into 'dst' without waiting.
+ *   On MPMC rings the count can also be short when the next slot is
+ *   still being written by a producer.
+ *
+ * Parameters:
+ *   ring - Target ring
+ *   dst  - Room for 'n' records of cell_size bytes
+ *   n    - Most records to pop
+ *
+ * Returns:
+ *   Number of records popped (0 when the ring is empty).
+ */
+size_t ringTryPopN(Ring *ring, void *dst, size_t n);
+
+/**
+ * ringPushN / ringPopN:
+ *   Same as the Try variants, but spin (yielding the CPU now and then)
+ *   until all 'n' records went through. Stopping a consumer blocked in
+ *   ringPopN is up to the caller, e.g. with a sentinel record.
+ */
+void ringPushN(Ring *ring, const void *src, size_t n);
+void ringPopN(Ring *ring, void *dst, size_t n);
+
+/**
+ * ringTryPush / ringTryPop / ringPush / ringPop:
+ *   Single-record forms of the above, the Try forms return false when
+ *   the ring is full / empty.
+ */
+bool ringTryPush(Ring *ring, const void *rec);
+bool ringTryPop(Ring *ring, void *out);
+void ringPush(Ring *ring, const void *rec);
+void ringPop(Ring *ring, void *out);
+
+/**
+ * ringCount:
+ *   Returns the number of records in the ring. Only a hint while other
+ *   threads are pushing or popping.
+ *
+ * Parameters:
+ *   ring - Target ring
+ */
+size_t ringCount(const Ring *ring);
+
+/**
+ * ringCapacity:
+ *   Returns the number of records the ring holds when full.
+ *
+ * Parameters:
+ *   ring - Target ring
+ */
+size_t ringCapacity(const Ring *ring);
+
+/**
+ * ringFree:
+ *   Frees the ring. No thread may be using it.
+ *
+ * Parameters:
+ *   ring - Ring to free (may be NULL)
+ */
+void ringFree(Ring *ring);
+
+#endif // DU_RING_H
+#endif // DU_RING
+
+
+/* =====================================================================
+ *
+ * Delta-Utils: IMPLEMENTATION
+ * 
+ * =====================================================================
+ */
+
+
+#ifdef DU_IMPLEMENTATION
+
+
+// __DU_STAT_ADD bumps a library-wide counter, __DU_STAT runs a statement;
+// both vanish without DU_STATS
+#ifdef DU_STATS
+
+static DuStats __du_stats;
+
+#if defined(__GNUC__)
+#define __DU_STAT_ADD(field, n) \
+    ((void)__atomic_fetch_add(&__du_stats.field, (uint64_t)(n), __ATOMIC_RELAXED))
+#else
+#define __DU_STAT_ADD(field, n) ((void)(__du_stats.field += (uint64_t)(n)))
+#endif
+#define __DU_STAT(stmt) stmt
+
+// Bucket of a probe / chain length: 1, 2, 3-4, 5-8, ..., 65+ slots
+static inline uint32_t __duStatsBucket(uint64_t n) {
+    uint32_t b = 0;
+    for (uint64_t x = n > 0 ? n - 1 : 0; x; x >>= 1) b++;
+    return b < DU_STATS_HIST - 1 ? b : DU_STATS_HIST - 1;
+}
+
+void duStatsSnapshot(DuStats *out) {
+    assert(out);
+    const uint64_t *src = (const uint64_t *)&__du_stats;
+    uint64_t *dst = (uint64_t *)out;
+    for (size_t i = 0; i < sizeof(DuStats) / sizeof(uint64_t); i++) {
+#if defined(__GNUC__)
+        dst[i] = __atomic_load_n(&src[i], __ATOMIC_RELAXED);
+#else
+        dst[i] = src[i];
+#endif
+    }
+}
+
+void duStatsReset(void) {
+    uint64_t *dst = (uint64_t *)&__du_stats;
+    for (size_t i = 0; i < sizeof(DuStats) / sizeof(uint64_t); i++) {
+#if defined(__GNUC__)
+        __atomic_store_n(&dst[i], 0, __ATOMIC_RELAXED);
+#else
+        dst[i] = 0;
+#endif
+    }
+}
+
+#else
+#define __DU_STAT_ADD(field, n) ((void)0)
+#define __DU_STAT(stmt)
+#endif // DU_STATS
+
+
+static void *__duDefaultAlloc(void *ctx, size_t size) {
+    (void)ctx;
+    return DU_MALLOC(size);
+}
+
+static void *__duDefaultRealloc(void *ctx, void *ptr, size_t size) {
+    (void)ctx;
+    return DU_REALLOC(ptr, size);
+}
+
+static void __duDefaultFree(void *ctx, void *ptr) {
+    (void)ctx;
+    DU_FREE(ptr);
+}
+
+static const DuAllocator __du_default_allocator = {
+    __duDefaultAlloc, __duDefaultRealloc, __duDefaultFree, NULL
+};
+
+static const DuAllocator *__du_allocator = &__du_default_allocator;
+
+void duSetAllocator(const DuAllocator *alloc) {
+    assert(!alloc || (alloc->alloc && alloc->realloc && alloc->free));
+    __du_allocator = alloc ? alloc : &__du_default_allocator;
+}
+
+const DuAllocator *duGetAllocator(void) {
+    return __du_allocator;
+}
+
+// Calls on a specific allocator, NULL meaning the global one
+static inline void *__duAllocA(const DuAllocator *a, size_t size) {
+    if (!a) a = __du_allocator;
+    __DU_STAT_ADD(allocs, 1);
+    __DU_STAT_ADD(alloc_bytes, size);
+    return a->alloc(a->ctx, size);
+}
+
+static inline void *__duCallocA(const DuAllocator *a, size_t count, size_t size) {
+    if (size && count > SIZE_MAX / size) return NULL;
+    void *p = __duAllocA(a, count * size);
+    if (p) memset(p, 0, count * size);
+    return p;
+}
+
+static inline void *__duReallocA(const DuAllocator *a, void *ptr, size_t size) {
+    if (!a) a = __du_allocator;
+    __DU_STAT_ADD(reallocs, 1);
+    __DU_STAT_ADD(alloc_bytes, size);
+    return a->realloc(a->ctx, ptr, size);
+}
+
+static inline void __duFreeA(const DuAllocator *a, void *ptr) {
+    if (!ptr) return;
+    if (!a) a = __du_allocator;
+    __DU_STAT_ADD(frees, 1);
+    a->free(a->ctx, ptr);
+}
+
+void *duMalloc(size_t size) {
+    return __duAllocA(NULL, size);
+}
+
+void *duCalloc(size_t count, size_t size) {
+    return __duCallocA(NULL, count, size);
+}
+
+void *duRealloc(void *ptr, size_t size) {
+    return __duReallocA(NULL, ptr, size);
+}
+
+void duFree(void *ptr) {
+    __duFreeA(NULL, ptr);
+}
+
+
+#ifdef DU_ARENA
+
+// Size header in front of allocations made through the DuAllocator interface
+#define __ARENA_HDR (DU_ARENA_ALIGN < sizeof(size_t) ? sizeof(size_t) : DU_ARENA_ALIGN)
+
+static inline char *__arenaData(ArenaBlock *b) {
+    return (char *)(b + 1);
+}
+
+// Hands out 'size' aligned bytes from 'b', or NULL if they do not fit
+static void *__arenaBump(ArenaBlock *b, size_t size) {
+    uintptr_t base = (uintptr_t)__arenaData(b);
+    uintptr_t p = (base + b->used + DU_ARENA_ALIGN - 1) & ~(uintptr_t)(DU_ARENA_ALIGN - 1);
+    size_t off = (size_t)(p - base);
+
+    if (off > b->cap || size > b->cap - off) return NULL;
+    b->used = off + size;
+    return (void *)p;
+}
+
+// True if 'ptr' (of 'size' bytes) is the last allocation in the head block
+static inline bool __arenaIsTop(const Arena *a, const void *ptr, size_t size) {
+    ArenaBlock *b = a->head;
+    return b && (const char *)ptr >= __arenaData(b)
+             && (const char *)ptr + size == __arenaData(b) + b->used;
+}
+
+static void *__arenaIfaceAlloc(void *ctx, size_t size);
+static void *__arenaIfaceRealloc(void *ctx, void *ptr, size_t size);
+static void  __arenaIfaceFree(void *ctx, void *ptr);
+
+void arenaInit(Arena *arena, size_t block_size) {
+    assert(arena);
+    arena->head = NULL;
+    arena->block_size = block_size ? block_size : DU_ARENA_BLOCK_SIZE;
+    arena->backing = duGetAllocator();
+    arena->iface = (DuAllocator){ __arenaIfaceAlloc, __arenaIfaceRealloc, __arenaIfaceFree, arena };
+}
+
+void *arenaAlloc(Arena *arena, size_t size) {
+    assert(arena);
+
+    void *p = arena->head ? __arenaBump(arena->head, size) : NULL;
+    if (p) return p;
+
+    if (size > SIZE_MAX - sizeof(ArenaBlock) - DU_ARENA_ALIGN) return NULL;
+    size_t cap = size + DU_ARENA_ALIGN > arena->block_size ? size + DU_ARENA_ALIGN : arena->block_size;
+
+    ArenaBlock *b = (ArenaBlock *)__duAllocA(arena->backing, sizeof(ArenaBlock) + cap);
+    if (!b) return NULL;
+    b->prev = arena->head;
+    b->used = 0;
+    b->cap = cap;
+    arena->head = b;
+
+    return __arenaBump(b, size);
+}
+
+void *arenaCalloc(Arena *arena, size_t size) {
+    void *p = arenaAlloc(arena, size);
+    if (p) memset(p, 0, size);
+    return p;
+}
+
+void *arenaRealloc(Arena *arena, void *ptr, size_t old_size, size_t new_size) {
+    assert(arena);
+    if (!ptr) return arenaAlloc(arena, new_size);
+
+    if (__arenaIsTop(arena, ptr, old_size)) {
+        size_t off = (size_t)((char *)ptr - __arenaData(arena->head));
+        if (new_size <= arena->head->cap - off) {
+            arena->head->used = off + new_size;
+            return ptr;
+        }
+    } else if (new_size <= old_size) {
+        return ptr;
+    }
+
+    void *moved = arenaAlloc(arena, new_size);
+    if (!moved) return NULL;
+    memcpy(moved, ptr, old_size < new_size ? old_size : new_size);
+    return moved;
+}
+
+ArenaMark arenaMark(const Arena *arena) {
+    assert(arena);
+    ArenaMark mark = { arena->head, arena->head ? arena->head->used : 0 };
+    return mark;
+}
+
+void arenaRewind(Arena *arena, ArenaMark mark) {
+    assert(arena);
+    while (arena->head && arena->head != mark.block) {
+        ArenaBlock *prev = arena->head->prev;
+        __duFreeA(arena->backing, arena->head);
+        arena->head = prev;
+    }
+    if (arena->head) arena->head->used = mark.used;
+}
+
+void arenaReset(Arena *arena) {
+    assert(arena);
+    while (arena->head && arena->head->prev) {
+        ArenaBlock *prev = arena->head->prev;
+        __duFreeA(arena->backing, arena->head);
+        arena->head = prev;
+    }
+    if (arena->head) arena->head->used = 0;
+}
+
+void arenaFree(Arena *arena) {
+    assert(arena);
+    arenaReset(arena);
+    __duFreeA(arena->backing, arena->head);
+    arena->head = NULL;
+}
+
+const DuAllocator *arenaAllocator(Arena *arena) {
+    assert(arena);
+    return &arena->iface;
+}
+
+// DuAllocator interface. Each allocation carries its size in a header,
+// since realloc and free are not told it.
+static void *__arenaIfaceAlloc(void *ctx, size_t size) {
+    if (size > SIZE_MAX - __ARENA_HDR) return NULL;
+    char *h = arenaAlloc((Arena *)ctx, __ARENA_HDR + size);
+    if (!h) return NULL;
+    *(size_t *)h = size;
+    return h + __ARENA_HDR;
+}
+
+static void *__arenaIfaceRealloc(void *ctx, void *ptr, size_t size) {
+    if (!ptr) return __arenaIfaceAlloc(ctx, size);
+    if (size > SIZE_MAX - __ARENA_HDR) return NULL;
+
+    char *h = (char *)ptr - __ARENA_HDR;
+    char *moved = arenaRealloc((Arena *)ctx, h, __ARENA_HDR + *(size_t *)h, __ARENA_HDR + size);
+    if (!moved) return NULL;
+    *(size_t *)moved = size;
+    return moved + __ARENA_HDR;
+}
+
+// Only the most recent allocation can be given back
+static void __arenaIfaceFree(void *ctx, void *ptr) {
+    if (!ptr) return;
+    Arena *arena = (Arena *)ctx;
+    char *h = (char *)ptr - __ARENA_HDR;
+    if (__arenaIsTop(arena, h, __ARENA_HDR + *(size_t *)h)) {
+        arena->head->used = (size_t)(h - __arenaData(arena->head));
+    }
+}
+
+#endif // DU_ARENA
+
+
+#if defined(DU_HASH) || defined(DU_DICT)
+
+/*
+ * This hash function is based on wyhash
+ * Author: Wang Yi
+ *
+ * Reads the input 8 bytes at a time (48 per step for long inputs) and
+ * mixes with 64x64->128 bit multiplies. Shared by the DU_HASH checksums
+ * and the DU_DICT key hash.
+ */
+static const uint64_t __du_wy_secret[4] = {
+    0x2d358dccaa6c78a5ull, 0x8bb84b93962eacc9ull,
+    0x4b33a62ed433d4a3ull, 0x4d5a2da51de1aa47ull
+};
+
+// Folds the 128-bit product back into both inputs ('a ^= lo, b ^= hi')
+// rather than replacing them, so an input that happens to be zero (e.g.
+// a key word equal to the secret) cannot wipe out the other one and the
+// seed along with it.
+static inline void __duMum(uint64_t *a, uint64_t *b) {
+#if defined(__SIZEOF_INT128__)
+    __uint128_t r = (__uint128_t)*a * *b;
+    *a ^= (uint64_t)r;
+    *b ^= (uint64_t)(r >> 64);
+#else
+    uint64_t ha = *a >> 32, hb = *b >> 32;
+    uint64_t la = (uint32_t)*a, lb = (uint32_t)*b;
+    uint64_t rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+    uint64_t t = rl + (rm0 << 32), c = t < rl;
+    uint64_t lo = t + (rm1 << 32);
+    c += lo < t;
+    *a ^= lo;
+    *b ^= rh + (rm0 >> 32) + (rm1 >> 32) + c;
+#endif
+}
+
+static inline uint64_t __duMix(uint64_t a, uint64_t b) {
+    __duMum(&a, &b);
+    return a ^ b;
+}
+
+static inline uint64_t __duRead8(const uint8_t *p) {
+    uint64_t v;
+    memcpy(&v, p, 8);
+    return v;
+}
+
+static inline uint64_t __duRead4(const uint8_t *p) {
+    uint32_t v;
+    memcpy(&v, p, 4);
+    return v;
+}
+
+// Reads the 'a' and 'b' words of an input of at most 16 bytes
+static inline void __duWyShort(const uint8_t *p, size_t len, uint64_t *a, uint64_t *b) {
+    if (len >= 4) {
+        size_t q = (len >> 3) << 2;
+        *a = (__duRead4(p) << 32) | __duRead4(p + q);
+        *b = (__duRead4(p + len - 4) << 32) | __duRead4(p + len - 4 - q);
+    } else if (len > 0) {
+        *a = ((uint64_t)p[0] << 16) | ((uint64_t)p[len >> 1] << 8) | p[len - 1];
+        *b = 0;
+    } else {
+        *a = *b = 0;
+    }
+}
+
+static inline uint64_t __duWyFinish(uint64_t a, uint64_t b, uint64_t seed, uint64_t len, const uint64_t s[4]) {
+    a ^= s[1];
+    b ^= seed;
+    __duMum(&a, &b);
+    return __duMix(a ^ s[0] ^ len, b ^ s[1]);
+}
+
+static uint64_t __duWyhash(const void *data, size_t len, uint64_t seed, const uint64_t s[4]) {
+    const uint8_t *p = (const uint8_t *)data;
+    uint64_t a, b;
+
+    seed ^= __duMix(seed ^ s[0], s[1]);
+
+    if (len <= 16) {
+        __duWyShort(p, len, &a, &b);
+    } else {
+        size_t i = len;
+        if (i > 48) {
+            uint64_t see1 = seed, see2 = seed;
+            do {
+                seed = __duMix(__duRead8(p)      ^ s[1], __duRead8(p + 8)  ^ seed);
+                see1 = __duMix(__duRead8(p + 16) ^ s[2], __duRead8(p + 24) ^ see1);
+                see2 = __duMix(__duRead8(p + 32) ^ s[3], __duRead8(p + 40) ^ see2);
+                p += 48;
+                i -= 48;
+            } while (i > 48);
+            seed ^= see1 ^ see2;
+        }
+        while (i > 16) {
+            seed = __duMix(__duRead8(p) ^ s[1], __duRead8(p + 8) ^ seed);
+            p += 16;
+            i -= 16;
+        }
+        a = __duRead8(p + i - 16);
+        b = __duRead8(p + i - 8);
+    }
+
+    return __duWyFinish(a, b, seed, len, s);
+}
+
+#endif // DU_HASH || DU_DICT
+
+
+#ifdef DU_POOL
+
+#include <unistd.h>
+
+// One thread's share of the running loop, padded to its own cache line
+typedef struct {
+    pthread_mutex_t lock;
+    size_t          lo;    // Next item not yet handed out
+    size_t          hi;    // One past the last item of this share
+    char            pad[DU_CACHE_LINE
+                        - (sizeof(pthread_mutex_t) + 2 * sizeof(size_t)) % DU_CACHE_LINE];
+} __PoolSlot;
+
+struct thread_pool_s {
+    pthread_t       *threads;  // Workers (nthreads - 1, the caller is the last)
+    __PoolSlot      *slots;    // One per participating thread
+    size_t           nthreads; // Threads taking part in each loop
+    pthread_mutex_t  run;      // Serializes parallelFor calls
+    pthread_mutex_t  lock;     // Protects the fields below
+    pthread_cond_t   wake;     // Signalled when a loop starts or on shutdown
+    pthread_cond_t   done;     // Signalled when the last worker finishes
+    uint64_t         epoch;    // Incremented for every loop
+    size_t           busy;     // Workers still in the current loop
+    bool             stop;     // Set by poolFree
+    PoolTaskFn       fn;       // Current loop
+    void            *arg;
+    size_t           grain;
+};
+
+typedef struct {
+    ThreadPool *pool;
+    size_t      self;  // Index of this worker's slot
+} __PoolWorkerArg;
+
+// Pool whose loop the current thread is running, to catch nested loops
+static _Thread_local ThreadPool *__pool_current = NULL;
+
+// Takes up to 'grain' items from the front of a slot
+static bool __poolTake(__PoolSlot *slot, size_t grain, size_t *b, size_t *e) {
+    pthread_mutex_lock(&slot->lock);
+    bool got = slot->lo < slot->hi;
+    if (got) {
+        *b = slot->lo;
+        *e = (slot->hi - slot->lo > grain) ? slot->lo + grain : slot->hi;
+        slot->lo = *e;
+    }
+    pthread_mutex_unlock(&slot->lock);
+    return got;
+}
+
+// Moves the back half of the busiest-looking other slot into our own
+static bool __poolSteal(ThreadPool *pool, size_t self) {
+    for (size_t k = 1; k < pool->nthreads; k++) {
+        __PoolSlot *victim = &pool->slots[(self + k) % pool->nthreads];
+        size_t lo = 0, hi = 0;
+
+        pthread_mutex_lock(&victim->lock);
+        if (victim->lo < victim->hi) {
+            hi = victim->hi;
+            lo = victim->lo + (victim->hi - victim->lo) / 2;
+            if (hi - lo < pool->grain) lo = victim->lo;
+            victim->hi = lo;
+        }
+        pthread_mutex_unlock(&victim->lock);
+
+        if (lo < hi) {
+            __PoolSlot *own = &pool->slots[self];
+            pthread_mutex_lock(&own->lock);
+            own->lo = lo;
+            own->hi = hi;
+            pthread_mutex_unlock(&own->lock);
+            return true;
+        }
+    }
+    return false;
+}
+
+// Runs the current loop from one thread until no slot has work left
+static void __poolWork(ThreadPool *pool, size_t self) {
+    ThreadPool *outer = __pool_current;
+    __pool_current = pool;
+
+    size_t b, e;
+    do {
+        while (__poolTake(&pool->slots[self], pool->grain, &b, &e)) {
+            pool->fn(pool->arg, b, e);
+        }
+    } while (__poolSteal(pool, self));
+
+    __pool_current = outer;
+}
+
+static void *__poolWorker(void *arg) {
+    __PoolWorkerArg *wa = arg;
+    ThreadPool *pool = wa->pool;
+    size_t self = wa->self;
+    duFree(wa);
+
+    uint64_t seen = 0;
+    pthread_mutex_lock(&pool->lock);
+    for (;;) {
+        while (!pool->stop && pool->epoch == seen) pthread_cond_wait(&pool->wake, &pool->lock);
+        if (pool->stop) break;
+        seen = pool->epoch;
+        pthread_mutex_unlock(&pool->lock);
+
+        __poolWork(pool, self);
+
+        pthread_mutex_lock(&pool->lock);
+        if (--pool->busy == 0) pthread_cond_signal(&pool->done);
+    }
+    pthread_mutex_unlock(&pool->lock);
+    return NULL;
+}
+
+static size_t __poolOnlineCpus(void) {
+#ifdef _SC_NPROCESSORS_ONLN
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    if (n > 0) return (size_t)n;
+#endif
+    return 1;
+}
+
+// Stops and joins the first 'started' workers, then frees the pool
+static void __poolDestroy(ThreadPool *pool, size_t started) {
+    pthread_mutex_lock(&pool->lock);
+    pool->stop = true;
+    pthread_cond_broadcast(&pool->wake);
+    pthread_mutex_unlock(&pool->lock);
+
+    for (size_t i = 0; i < started; i++) pthread_join(pool->threads[i], NULL);
+    for (size_t i = 0; i < pool->nthreads; i++) pthread_mutex_destroy(&pool->slots[i].lock);
+
+    pthread_cond_destroy(&pool->done);
+    pthread_cond_destroy(&pool->wake);
+    pthread_mutex_destroy(&pool->lock);
+    pthread_mutex_destroy(&pool->run);
+    duFree(pool->threads);
+    duFree(pool->slots);
+    duFree(pool);
+}
+
+ThreadPool *poolNew(size_t nthreads) {
+    if (nthreads == 0) nthreads = __poolOnlineCpus();
+
+    ThreadPool *pool = (ThreadPool *)duCalloc(1, sizeof(ThreadPool));
+    if (!pool) return NULL;
+
+    pool->nthreads = nthreads;
+    pool->threads = (pthread_t *)duMalloc(nthreads * sizeof(pthread_t));
+    pool->slots = (__PoolSlot *)duCalloc(nthreads, sizeof(__PoolSlot));
+    if (!pool->threads || !pool->slots) {
+        duFree(pool->threads);
+        duFree(pool->slots);
+        duFree(pool);
+        return NULL;
+    }
+
+    pthread_mutex_init(&pool->run, NULL);
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->wake, NULL);
+    pthread_cond_init(&pool->done, NULL);
+    for (size_t i = 0; i < nthreads; i++) pthread_mutex_init(&pool->slots[i].lock, NULL);
+
+    for (size_t i = 0; i + 1 < nthreads; i++) {
+        __PoolWorkerArg *wa = (__PoolWorkerArg *)duMalloc(sizeof(__PoolWorkerArg));
+        if (wa) *wa = (__PoolWorkerArg){ pool, i };
+        if (!wa || pthread_create(&pool->threads[i], NULL, __poolWorker, wa) != 0) {
+            duFree(wa);
+            __poolDestroy(pool, i);
+            return NULL;
+        }
+    }
+
+    return pool;
+}
+
+static ThreadPool     *__pool_default = NULL;
+static pthread_once_t  __pool_default_once = PTHREAD_ONCE_INIT;
+
+static void __poolDefaultInit(void) {
+    size_t n = __poolOnlineCpus();
+    __pool_default = poolNew(n < DU_POOL_MAX_THREADS ? n : DU_POOL_MAX_THREADS);
+}
+
+ThreadPool *poolDefault(void) {
+    pthread_once(&__pool_default_once, __poolDefaultInit);
+    return __pool_default;
+}
+
+size_t poolThreads(ThreadPool *pool) {
+    if (!pool) pool = poolDefault();
+    return pool ? pool->nthreads : 1;
+}
+
+void parallelFor(ThreadPool *pool, size_t begin, size_t end, size_t grain,
+                 PoolTaskFn fn, void *arg) {
+    assert(fn != NULL);
+    if (begin >= end) return;
+    if (grain == 0) grain = 1;
+    if (!pool) pool = poolDefault();
+
+    // No pool, a nested loop, or too little work to split
+    size_t n = end - begin;
+    if (!pool || pool->nthreads == 1 || __pool_current == pool || n <= grain) {
+        fn(arg, begin, end);
+        return;
+    }
+
+    pthread_mutex_lock(&pool->run);
+
+    size_t t = pool->nthreads;
+    for (size_t i = 0; i < t; i++) {
+        pool->slots[i].lo = begin + n * i / t;
+        pool->slots[i].hi = begin + n * (i + 1) / t;
+    }
+
+    pthread_mutex_lock(&pool->lock);
+    pool->fn = fn;
+    pool->arg = arg;
+    pool->grain = grain;
+    pool->busy = t - 1;
+    pool->epoch++;
+    pthread_cond_broadcast(&pool->wake);
+    pthread_mutex_unlock(&pool->lock);
+
+    // The caller works the last slot
+    __poolWork(pool, t - 1);
+
+    pthread_mutex_lock(&pool->lock);
+    while (pool->busy > 0) pthread_cond_wait(&pool->done, &pool->lock);
+    pthread_mutex_unlock(&pool->lock);
+
+    pthread_mutex_unlock(&pool->run);
+}
+
+void poolFree(ThreadPool *pool) {
+    if (!pool || pool == __pool_default) return;
+    __poolDestroy(pool, pool->nthreads - 1);
+}
+
+#endif // DU_POOL
+
+
+#ifdef DU_BASE64
+
+static const uint8_t b64_dt[256] = {
+    ['A'] =  0, ['B'] =  1, ['C'] =  2, ['D'] =  3,
+    ['E'] =  4, ['F'] =  5, ['G'] =  6, ['H'] =  7,
+    ['I'] =  8, ['J'] =  9, ['K'] = 10, ['L'] = 11,
+    ['M'] = 12, ['N'] = 13, ['O'] = 14, ['P'] = 15,
+    ['Q'] = 16, ['R'] = 17, ['S'] = 18, ['T'] = 19,
+    ['U'] = 20, ['V'] = 21, ['W'] = 22, ['X'] = 23,
+    ['Y'] = 24, ['Z'] = 25,
+    ['a'] = 26, ['b'] = 27, ['c'] = 28, ['d'] = 29,
+    ['e'] = 30, ['f'] = 31, ['g'] = 32, ['h'] = 33,
+    ['i'] = 34, ['j'] = 35, ['k'] = 36, ['l'] = 37,
+    ['m'] = 38, ['n'] = 39, ['o'] = 40, ['p'] = 41,
+    ['q'] = 42, ['r'] = 43, ['s'] = 44, ['t'] = 45,
+    ['u'] = 46, ['v'] = 47, ['w'] = 48, ['x'] = 49,
+    ['y'] = 50, ['z'] = 51,
+    ['0'] = 52, ['1'] = 53, ['2'] = 54, ['3'] = 55,
+    ['4'] = 56, ['5'] = 57, ['6'] = 58, ['7'] = 59,
+    ['8'] = 60, ['9'] = 61,
+    ['+'] = 62, ['/'] = 63
+};
+
+/*
+ * Character classes for b64DecodeEx. Alphabet characters hold their
+ * sextet in the low 6 bits, so the hot loop is one lookup and one test.
+ */
+#define __B64_ALPHA 0x80  // A sextet follows in the low 6 bits
+#define __B64_URL   0x40  // Only valid with DU_B64_URL_SAFE
+#define __B64_PAD   0x20  // '='
+#define __B64_SPACE 0x10  // Only valid with DU_B64_SKIP_SPACE
+
+static const uint8_t b64_xt[256] = {
+    ['A'] = __B64_ALPHA| 0, ['B'] = __B64_ALPHA| 1, ['C'] = __B64_ALPHA| 2, ['D'] = __B64_ALPHA| 3,
+    ['E'] = __B64_ALPHA| 4, ['F'] = __B64_ALPHA| 5, ['G'] = __B64_ALPHA| 6, ['H'] = __B64_ALPHA| 7,
+    ['I'] = __B64_ALPHA| 8, ['J'] = __B64_ALPHA| 9, ['K'] = __B64_ALPHA|10, ['L'] = __B64_ALPHA|11,
+    ['M'] = __B64_ALPHA|12, ['N'] = __B64_ALPHA|13, ['O'] = __B64_ALPHA|14, ['P'] = __B64_ALPHA|15,
+    ['Q'] = __B64_ALPHA|16, ['R'] = __B64_ALPHA|17, ['S'] = __B64_ALPHA|18, ['T'] = __B64_ALPHA|19,
+    ['U'] = __B64_ALPHA|20, ['V'] = __B64_ALPHA|21, ['W'] = __B64_ALPHA|22, ['X'] = __B64_ALPHA|23,
+    ['Y'] = __B64_ALPHA|24, ['Z'] = __B64_ALPHA|25,
+    ['a'] = __B64_ALPHA|26, ['b'] = __B64_ALPHA|27, ['c'] = __B64_ALPHA|28, ['d'] = __B64_ALPHA|29,
+    ['e'] = __B64_ALPHA|30, ['f'] = __B64_ALPHA|31, ['g'] = __B64_ALPHA|32, ['h'] = __B64_ALPHA|33,
+    ['i'] = __B64_ALPHA|34, ['j'] = __B64_ALPHA|35, ['k'] = __B64_ALPHA|36, ['l'] = __B64_ALPHA|37,
+    ['m'] = __B64_ALPHA|38, ['n'] = __B64_ALPHA|39, ['o'] = __B64_ALPHA|40, ['p'] = __B64_ALPHA|41,
+    ['q'] = __B64_ALPHA|42, ['r'] = __B64_ALPHA|43, ['s'] = __B64_ALPHA|44, ['t'] = __B64_ALPHA|45,
+    ['u'] = __B64_ALPHA|46, ['v'] = __B64_ALPHA|47, ['w'] = __B64_ALPHA|48, ['x'] = __B64_ALPHA|49,
+    ['y'] = __B64_ALPHA|50, ['z'] = __B64_ALPHA|51,
+    ['0'] = __B64_ALPHA|52, ['1'] = __B64_ALPHA|53, ['2'] = __B64_ALPHA|54, ['3'] = __B64_ALPHA|55,
+    ['4'] = __B64_ALPHA|56, ['5'] = __B64_ALPHA|57, ['6'] = __B64_ALPHA|58, ['7'] = __B64_ALPHA|59,
+    ['8'] = __B64_ALPHA|60, ['9'] = __B64_ALPHA|61,
+    ['+'] = __B64_ALPHA|62, ['/'] = __B64_ALPHA|63,
+    ['-'] = __B64_ALPHA|__B64_URL|62, ['_'] = __B64_ALPHA|__B64_URL|63,
+    ['='] = __B64_PAD,
+    [' '] = __B64_SPACE, ['\t'] = __B64_SPACE, ['\n'] = __B64_SPACE,
+    ['\v'] = __B64_SPACE, ['\f'] = __B64_SPACE, ['\r'] = __B64_SPACE
+};
+
+static const char b64_et[65] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZ"
+    "abcdefghijklmnopqrstuvwxyz"
+    "0123456789+/";
+
+/*
+ * SIMD kernels. Each one handles the largest prefix of the input it can
+ * and returns how many input bytes it consumed (a multiple of 3 for
+ * encoding, of 4 for decoding). The scalar loops finish the rest, so
+ * the output is byte-for-byte the same as the scalar code alone.
+ *
+ * Decoders stop at the first block holding anything but the 64
+ * alphabet characters (padding included) and leave it to the scalar
+ * loop. On x86 the widest supported kernel is picked once at startup.
+ * Define DU_BASE64_NO_SIMD to build the scalar code only.
+ */
+typedef size_t (*__B64EncodeKernel)(const uint8_t *in, size_t len, char *out);
+typedef size_t (*__B64DecodeKernel)(const char *in, size_t len, uint8_t *out);
+
+static size_t __b64EncodeNone(const uint8_t *in, size_t len, char *out) {
+    (void)in; (void)len; (void)out;
+    return 0;
+}
+
+static size_t __b64DecodeNone(const char *in, size_t len, uint8_t *out) {
+    (void)in; (void)len; (void)out;
+    return 0;
+}
+
+#if !defined(DU_BASE64_NO_SIMD) && defined(__GNUC__) \
+        && (defined(__x86_64__) || defined(__i386__))
+#define DU_BASE64_X86
+
+#include <immintrin.h>
+
+#define DU_B64_TARGET(t) __attribute__((target(t)))
+
+// Reorders 12 input bytes so each 32-bit lane holds one 3-byte group
+// as [b1 b0 b2 b1], ready for the multiply-shift split into 4 sextets
+DU_B64_TARGET("ssse3")
+static inline __m128i __b64SplitSse(__m128i in) {
+    in = _mm_shuffle_epi8(in, _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1));
+    __m128i t0 = _mm_and_si128(in, _mm_set1_epi32(0x0fc0fc00));
+    __m128i t1 = _mm_mulhi_epu16(t0, _mm_set1_epi32(0x04000040));
+    __m128i t2 = _mm_and_si128(in, _mm_set1_epi32(0x003f03f0));
+    __m128i t3 = _mm_mullo_epi16(t2, _mm_set1_epi32(0x01000010));
+    return _mm_or_si128(t1, t3);
+}
+
+// Maps sextets 0..63 to the alphabet by adding a per-range offset
+DU_B64_TARGET("ssse3")
+static inline __m128i __b64ToAsciiSse(__m128i idx) {
+    const __m128i shift_lut = _mm_setr_epi8(
+        'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+        '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62,
+        '/' - 63, 'A', 0, 0);
+    __m128i r = _mm_subs_epu8(idx, _mm_set1_epi8(51));
+    __m128i less = _mm_cmpgt_epi8(_mm_set1_epi8(26), idx);
+    r = _mm_or_si128(r, _mm_and_si128(less, _mm_set1_epi8(13)));
+    return _mm_add_epi8(_mm_shuffle_epi8(shift_lut, r), idx);
+}
+
+// Maps alphabet characters to sextets; 'ok' has a set byte for every
+// character that belongs to the alphabet
+DU_B64_TARGET("ssse3")
+static inline __m128i __b64FromAsciiSse(__m128i c, __m128i *ok) {
+    __m128i up = _mm_and_si128(_mm_cmpgt_epi8(c, _mm_set1_epi8('A' - 1)),
+                               _mm_cmpgt_epi8(_mm_set1_epi8('Z' + 1), c));
+    __m128i lo = _mm_and_si128(_mm_cmpgt_epi8(c, _mm_set1_epi8('a' - 1)),
+                               _mm_cmpgt_epi8(_mm_set1_epi8('z' + 1), c));
+    __m128i dg = _mm_and_si128(_mm_cmpgt_epi8(c, _mm_set1_epi8('0' - 1)),
+                               _mm_cmpgt_epi8(_mm_set1_epi8('9' + 1), c));
+    __m128i pl = _mm_cmpeq_epi8(c, _mm_set1_epi8('+'));
+    __m128i sl = _mm_cmpeq_epi8(c, _mm_set1_epi8('/'));
+
+    *ok = _mm_or_si128(_mm_or_si128(up, lo), _mm_or_si128(dg, _mm_or_si128(pl, sl)));
+
+    __m128i shift = _mm_and_si128(up, _mm_set1_epi8(-65));
+    shift = _mm_or_si128(shift, _mm_and_si128(lo, _mm_set1_epi8(-71)));
+    shift = _mm_or_si128(shift, _mm_and_si128(dg, _mm_set1_epi8(4)));
+    shift = _mm_or_si128(shift, _mm_and_si128(pl, _mm_set1_epi8(19)));
+    shift = _mm_or_si128(shift, _mm_and_si128(sl, _mm_set1_epi8(16)));
+    return _mm_add_epi8(c, shift);
+}
+
+// Packs 4 sextets per 32-bit lane into 3 bytes at the lane's low end
+DU_B64_TARGET("ssse3")
+static inline __m128i __b64PackSse(__m128i v) {
+    v = _mm_maddubs_epi16(v, _mm_set1_epi32(0x01400140));
+    v = _mm_madd_epi16(v, _mm_set1_epi32(0x00011000));
+    return _mm_shuffle_epi8(v, _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+}
+
+// 12 bytes -> 16 characters per step
+DU_B64_TARGET("ssse3")
+static size_t __b64EncodeSsse3(const uint8_t *in, size_t len, char *out) {
+    size_t i = 0;
+    for (; i + 16 <= len; i += 12, out += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i *)(in + i));
+        _mm_storeu_si128((__m128i *)out, __b64ToAsciiSse(__b64SplitSse(v)));
+    }
+    return i;
+}
+
+// 16 characters -> 12 bytes per step
+DU_B64_TARGET("ssse3")
+static size_t __b64DecodeSsse3(const char *in, size_t len, uint8_t *out) {
+    size_t i = 0;
+    for (; i + 16 <= len; i += 16, out += 12) {
+        __m128i ok;
+        __m128i v = __b64FromAsciiSse(_mm_loadu_si128((const __m128i *)(in + i)), &ok);
+        if (_mm_movemask_epi8(ok) != 0xFFFF) break;
+
+        uint8_t tmp[16];
+        _mm_storeu_si128((__m128i *)tmp, __b64PackSse(v));
+        memcpy(out, tmp, 12);
+    }
+    return i;
+}
+
+// 24 bytes -> 32 characters per step, the same math on two 128-bit lanes
+DU_B64_TARGET("avx2")
+static size_t __b64EncodeAvx2(const uint8_t *in, size_t len, char *out) {
+    const __m256i shuf = _mm256_set_epi8(
+        10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1,
+        10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1);
+    const __m256i shift_lut = _mm256_setr_epi8(
+        'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+        '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62,
+        '/' - 63, 'A', 0, 0,
+        'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+        '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62,
+        '/' - 63, 'A', 0, 0);
+
+    size_t i = 0;
+    for (; i + 28 <= len; i += 24, out += 32) {
+        __m256i v = _mm256_inserti128_si256(
+            _mm256_castsi128_si256(_mm_loadu_si128((const __m128i *)(in + i))),
+            _mm_loadu_si128((const __m128i *)(in + i + 12)), 1);
+
+        v = _mm256_shuffle_epi8(v, shuf);
+        __m256i t0 = _mm256_and_si256(v, _mm256_set1_epi32(0x0fc0fc00));
+        __m256i t1 = _mm256_mulhi_epu16(t0, _mm256_set1_epi32(0x04000040));
+        __m256i t2 = _mm256_and_si256(v, _mm256_set1_epi32(0x003f03f0));
+        __m256i t3 = _mm256_mullo_epi16(t2, _mm256_set1_epi32(0x01000010));
+        __m256i idx = _mm256_or_si256(t1, t3);
+
+        __m256i r = _mm256_subs_epu8(idx, _mm256_set1_epi8(51));
+        __m256i less = _mm256_cmpgt_epi8(_mm256_set1_epi8(26), idx);
+        r = _mm256_or_si256(r, _mm256_and_si256(less, _mm256_set1_epi8(13)));
+        r = _mm256_add_epi8(_mm256_shuffle_epi8(shift_lut, r), idx);
+
+        _mm256_storeu_si256((__m256i *)out, r);
+    }
+    return i;
+}
+
+// 32 characters -> 24 bytes per step
+DU_B64_TARGET("avx2")
+static size_t __b64DecodeAvx2(const char *in, size_t len, uint8_t *out) {
+    const __m256i pack = _mm256_setr_epi8(
+        2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1,
+        2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+
+    size_t i = 0;
+    for (; i + 32 <= len; i += 32, out += 24) {
+        __m256i c = _mm256_loadu_si256((const __m256i *)(in + i));
+
+        __m256i up = _mm256_and_si256(_mm256_cmpgt_epi8(c, _mm256_set1_epi8('A' - 1)),
+                                      _mm256_cmpgt_epi8(_mm256_set1_epi8('Z' + 1), c));
+        __m256i lo = _mm256_and_si256(_mm256_cmpgt_epi8(c, _mm256_set1_epi8('a' - 1)),
+                                      _mm256_cmpgt_epi8(_mm256_set1_epi8('z' + 1), c));
+        __m256i dg = _mm256_and_si256(_mm256_cmpgt_epi8(c, _mm256_set1_epi8('0' - 1)),
+                                      _mm256_cmpgt_epi8(_mm256_set1_epi8('9' + 1), c));
+        __m256i pl = _mm256_cmpeq_epi8(c, _mm256_set1_epi8('+'));
+        __m256i sl = _mm256_cmpeq_epi8(c, _mm256_set1_epi8('/'));
+
+        __m256i ok = _mm256_or_si256(_mm256_or_si256(up, lo),
+                                     _mm256_or_si256(dg, _mm256_or_si256(pl, sl)));
+        if ((uint32_t)_mm256_movemask_epi8(ok) != 0xFFFFFFFFu) break;
+
+        __m256i shift = _mm256_and_si256(up, _mm256_set1_epi8(-65));
+        shift = _mm256_or_si256(shift, _mm256_and_si256(lo, _mm256_set1_epi8(-71)));
+        shift = _mm256_or_si256(shift, _mm256_and_si256(dg, _mm256_set1_epi8(4)));
+        shift = _mm256_or_si256(shift, _mm256_and_si256(pl, _mm256_set1_epi8(19)));
+        shift = _mm256_or_si256(shift, _mm256_and_si256(sl, _mm256_set1_epi8(16)));
+        __m256i v = _mm256_add_epi8(c, shift);
+
+        v = _mm256_maddubs_epi16(v, _mm256_set1_epi32(0x01400140));
+        v = _mm256_madd_epi16(v, _mm256_set1_epi32(0x00011000));
+        v = _mm256_shuffle_epi8(v, pack);
+        v = _mm256_permutevar8x32_epi32(v, _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 3, 7));
+
+        uint8_t tmp[32];
+        _mm256_storeu_si256((__m256i *)tmp, v);
+        memcpy(out, tmp, 24);
+    }
+    return i;
+}
+
+// 48 bytes -> 64 characters per step: a byte permute spreads each group
+// over a 32-bit lane, multishift pulls out the sextets, and a second
+// permute looks them up in the 64-entry alphabet
+DU_B64_TARGET("avx512f,avx512bw,avx512vbmi")
+static size_t __b64EncodeAvx512(const uint8_t *in, size_t len, char *out) {
+    const __m512i shuf = _mm512_setr_epi32(
+        0x01020001, 0x04050304, 0x07080607, 0x0a0b090a,
+        0x0d0e0c0d, 0x10110f10, 0x13141213, 0x16171516,
+        0x191a1819, 0x1c1d1b1c, 0x1f201e1f, 0x22232122,
+        0x25262425, 0x28292728, 0x2b2c2a2b, 0x2e2f2d2e);
+    const __m512i shifts = _mm512_set1_epi64(0x3036242a1016040aLL);
+    const __m512i lut = _mm512_loadu_si512((const void *)b64_et);
+
+    size_t i = 0;
+    for (; i + 64 <= len; i += 48, out += 64) {
+        __m512i v = _mm512_loadu_si512((const void *)(in + i));
+        v = _mm512_permutexvar_epi8(shuf, v);
+        v = _mm512_multishift_epi64_epi8(shifts, v);
+        _mm512_storeu_si512((void *)out, _mm512_permutexvar_epi8(v, lut));
+    }
+    return i;
+}
+
+// 64 characters -> 48 bytes per step
+DU_B64_TARGET("avx512f,avx512bw,avx512vbmi")
+static size_t __b64DecodeAvx512(const char *in, size_t len, uint8_t *out) {
+    const __m512i pack = _mm512_setr_epi32(
+        0x06000102, 0x090a0405, 0x0c0d0e08, 0x16101112,
+        0x191a1415, 0x1c1d1e18, 0x26202122, 0x292a2425,
+        0x2c2d2e28, 0x36303132, 0x393a3435, 0x3c3d3e38,
+        0, 0, 0, 0);
+
+    size_t i = 0;
+    for (; i + 64 <= len; i += 64, out += 48) {
+        __m512i c = _mm512_loadu_si512((const void *)(in + i));
+
+        __mmask64 up = _mm512_cmpgt_epi8_mask(c, _mm512_set1_epi8('A' - 1))
+                     & _mm512_cmplt_epi8_mask(c, _mm512_set1_epi8('Z' + 1));
+        __mmask64 lo = _mm512_cmpgt_epi8_mask(c, _mm512_set1_epi8('a' - 1))
+                     & _mm512_cmplt_epi8_mask(c, _mm512_set1_epi8('z' + 1));
+        __mmask64 dg = _mm512_cmpgt_epi8_mask(c, _mm512_set1_epi8('0' - 1))
+                     & _mm512_cmplt_epi8_mask(c, _mm512_set1_epi8('9' + 1));
+        __mmask64 pl = _mm512_cmpeq_epi8_mask(c, _mm512_set1_epi8('+'));
+        __mmask64 sl = _mm512_cmpeq_epi8_mask(c, _mm512_set1_epi8('/'));
+        if ((up | lo | dg | pl | sl) != ~(__mmask64)0) break;
+
+        __m512i v = _mm512_mask_add_epi8(c, up, c, _mm512_set1_epi8(-65));
+        v = _mm512_mask_add_epi8(v, lo, c, _mm512_set1_epi8(-71));
+        v = _mm512_mask_add_epi8(v, dg, c, _mm512_set1_epi8(4));
+        v = _mm512_mask_add_epi8(v, pl, c, _mm512_set1_epi8(19));
+        v = _mm512_mask_add_epi8(v, sl, c, _mm512_set1_epi8(16));
+
+        v = _mm512_maddubs_epi16(v, _mm512_set1_epi32(0x01400140));
+        v = _mm512_madd_epi16(v, _mm512_set1_epi32(0x00011000));
+        v = _mm512_permutexvar_epi8(pack, v);
+        _mm512_mask_storeu_epi8(out, (__mmask64)0xFFFFFFFFFFFFull, v);
+    }
+    return i;
+}
+
+static __B64EncodeKernel __b64_encode_kernel = __b64EncodeNone;
+static __B64DecodeKernel __b64_decode_kernel = __b64DecodeNone;
+
+__attribute__((constructor))
+static void __b64SelectKernels(void) {
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512vbmi") && __builtin_cpu_supports("avx512bw")) {
+        __b64_encode_kernel = __b64EncodeAvx512;
+        __b64_decode_kernel = __b64DecodeAvx512;
+    } else if (__builtin_cpu_supports("avx2")) {
+        __b64_encode_kernel = __b64EncodeAvx2;
+        __b64_decode_kernel = __b64DecodeAvx2;
+    } else if (__builtin_cpu_supports("ssse3")) {
+        __b64_encode_kernel = __b64EncodeSsse3;
+        __b64_decode_kernel = __b64DecodeSsse3;
+    }
+}
+
+#undef DU_B64_TARGET
+
+#elif !defined(DU_BASE64_NO_SIMD) && defined(__aarch64__) && defined(__ARM_NEON)
+#define DU_BASE64_NEON
+
+#include <arm_neon.h>
+
+// 48 bytes -> 64 characters per step, de-interleaved by vld3/vst4
+static size_t __b64EncodeNeon(const uint8_t *in, size_t len, char *out) {
+    const uint8x16x4_t lut = {{
+        vld1q_u8((const uint8_t *)b64_et),      vld1q_u8((const uint8_t *)b64_et + 16),
+        vld1q_u8((const uint8_t *)b64_et + 32), vld1q_u8((const uint8_t *)b64_et + 48)
+    }};
+    const uint8x16_t m6 = vdupq_n_u8(0x3F);
+
+    size_t i = 0;
+    for (; i + 48 <= len; i += 48, out += 64) {
+        uint8x16x3_t v = vld3q_u8(in + i);
+        uint8x16x4_t r;
+        r.val[0] = vshrq_n_u8(v.val[0], 2);
+        r.val[1] = vandq_u8(vorrq_u8(vshlq_n_u8(v.val[0], 4), vshrq_n_u8(v.val[1], 4)), m6);
+        r.val[2] = vandq_u8(vorrq_u8(vshlq_n_u8(v.val[1], 2), vshrq_n_u8(v.val[2], 6)), m6);
+        r.val[3] = vandq_u8(v.val[2], m6);
+
+        r.val[0] = vqtbl4q_u8(lut, r.val[0]);
+        r.val[1] = vqtbl4q_u8(lut, r.val[1]);
+        r.val[2] = vqtbl4q_u8(lut, r.val[2]);
+        r.val[3] = vqtbl4q_u8(lut, r.val[3]);
+        vst4q_u8((uint8_t *)out, r);
+    }
+    return i;
+}
+
+// Maps alphabet characters to sextets, clearing 'ok' lanes that are not
+static inline uint8x16_t __b64FromAsciiNeon(uint8x16_t c, uint8x16_t *ok) {
+    uint8x16_t up = vandq_u8(vcgeq_u8(c, vdupq_n_u8('A')), vcleq_u8(c, vdupq_n_u8('Z')));
+    uint8x16_t lo = vandq_u8(vcgeq_u8(c, vdupq_n_u8('a')), vcleq_u8(c, vdupq_n_u8('z')));
+    uint8x16_t dg = vandq_u8(vcgeq_u8(c, vdupq_n_u8('0')), vcleq_u8(c, vdupq_n_u8('9')));
+    uint8x16_t pl = vceqq_u8(c, vdupq_n_u8('+'));
+    uint8x16_t sl = vceqq_u8(c, vdupq_n_u8('/'));
+
+    *ok = vandq_u8(*ok, vorrq_u8(vorrq_u8(up, lo), vorrq_u8(dg, vorrq_u8(pl, sl))));
+
+    uint8x16_t shift = vandq_u8(up, vdupq_n_u8((uint8_t)-65));
+    shift = vorrq_u8(shift, vandq_u8(lo, vdupq_n_u8((uint8_t)-71)));
+    shift = vorrq_u8(shift, vandq_u8(dg, vdupq_n_u8(4)));
+    shift = vorrq_u8(shift, vandq_u8(pl, vdupq_n_u8(19)));
+    shift = vorrq_u8(shift, vandq_u8(sl, vdupq_n_u8(16)));
+    return vaddq_u8(c, shift);
+}
+
+// 64 characters -> 48 bytes per step
+static size_t __b64DecodeNeon(const char *in, size_t len, uint8_t *out) {
+    size_t i = 0;
+    for (; i + 64 <= len; i += 64, out += 48) {
+        uint8x16x4_t c = vld4q_u8((const uint8_t *)in + i);
+        uint8x16_t ok = vdupq_n_u8(0xFF);
+
+        uint8x16_t a = __b64FromAsciiNeon(c.val[0], &ok);
+        uint8x16_t b = __b64FromAsciiNeon(c.val[1], &ok);
+        uint8x16_t d = __b64FromAsciiNeon(c.val[2], &ok);
+        uint8x16_t e = __b64FromAsciiNeon(c.val[3], &ok);
+        if (vminvq_u8(ok) != 0xFF) break;
+
+        uint8x16x3_t r;
+        r.val[0] = vorrq_u8(vshlq_n_u8(a, 2), vshrq_n_u8(b, 4));
+        r.val[1] = vorrq_u8(vshlq_n_u8(b, 4), vshrq_n_u8(d, 2));
+        r.val[2] = vorrq_u8(vshlq_n_u8(d, 6), e);
+        vst3q_u8(out, r);
+    }
+    return i;
+}
+
+static const __B64EncodeKernel __b64_encode_kernel = __b64EncodeNeon;
+static const __B64DecodeKernel __b64_decode_kernel = __b64DecodeNeon;
+
+#else
+
+static const __B64EncodeKernel __b64_encode_kernel = __b64EncodeNone;
+static const __B64DecodeKernel __b64_decode_kernel = __b64DecodeNone;
+
+#endif
+
+// Encodes the whole 3-byte groups of 'in', returns bytes written
+static size_t __b64EncodeGroups(const uint8_t *in, size_t len, char *out) {
+    size_t i = len >= 3 ? __b64_encode_kernel(in, len, out) : 0;
+    size_t idx = i / 3 * 4;
+    while (i+2 < len) {
+        uint32_t g = (in[i] << 16) | (in[i+1] << 8) | in[i+2];
+        i += 3;
+
+        out[idx++] = b64_et[(g >> 18) & 0x3F];
+        out[idx++] = b64_et[(g >> 12) & 0x3F];
+        out[idx++] = b64_et[(g >> 6 ) & 0x3F];
+        out[idx++] = b64_et[g & 0x3F];
+    }
+    return idx;
+}
+
+// Encodes the final 0-2 bytes with padding, returns bytes written
+static size_t __b64EncodeTail(const uint8_t *in, size_t rem, char *out) {
+    size_t idx = 0;
+
+    if (rem == 1) {
+        uint32_t g = in[0] << 16;
+        out[idx++] = b64_et[(g >> 18) & 0x3F];
+        out[idx++] = b64_et[(g >> 12) & 0x3F];
+        out[idx++] = '=';
+        out[idx++] = '=';
+    }
+    if (rem == 2) {
+        uint32_t g = (in[0] << 16) | (in[1] << 8);
+        out[idx++] = b64_et[(g >> 18) & 0x3F];
+        out[idx++] = b64_et[(g >> 12) & 0x3F];
+        out[idx++] = b64_et[(g >> 6 ) & 0x3F];
         out[idx++] = '=';
     }
-    if (rem == 2) {
-        uint32_t g = (in[i] << 16) | (in[i+1] << 8);
-        out[idx++] = b64_et[(g >> 18) & 0xF];
-        out[idx++] = b64_et[(g >> 12) & 0xF];
-        out[idx++] = b64_et[(g >> 6 ) & 0xF];
-        out[idx++] = '=';
+
+    return idx;
+}
+
+// Decodes one 4-character group, padding included, returns bytes written
+static size_t __b64DecodeGroup(const char *in, uint8_t *out) {
+    uint8_t c1 = in[0] == '=' ? 0 : b64_dt[(uint8_t)in[0]];
+    uint8_t c2 = in[1] == '=' ? 0 : b64_dt[(uint8_t)in[1]];
+    uint8_t c3 = in[2] == '=' ? 0 : b64_dt[(uint8_t)in[2]];
+    uint8_t c4 = in[3] == '=' ? 0 : b64_dt[(uint8_t)in[3]];
+
+    uint32_t g = (c1 << 18) | (c2 << 12) | (c3 << 6) | c4;
+    size_t idx = 0;
+
+    out[idx++] = (g >> 16) & 0xFF;
+
+    if (in[2] != '=') out[idx++] = (g >> 8) & 0xFF;
+    if (in[3] != '=') out[idx++] = g & 0xFF;
+
+    return idx;
+}
+
+// Decodes the whole 4-character groups of 'in', returns bytes written
+static size_t __b64DecodeGroups(const char *in, size_t len, uint8_t *out) {
+    size_t start = len >= 4 ? __b64_decode_kernel(in, len, out) : 0;
+    size_t idx = start / 4 * 3;
+    for (size_t i = start; i+3 < len; i += 4) {
+        idx += __b64DecodeGroup(in + i, out + idx);
+    }
+    return idx;
+}
+
+size_t b64Encode(uint8_t *in, size_t len, char *out) {
+    assert(in != NULL && out != NULL);
+
+    __DU_STAT_ADD(b64_encoded, len);
+    size_t idx = __b64EncodeGroups(in, len, out);
+    size_t rem = len % 3;
+    return idx + __b64EncodeTail(in + len - rem, rem, out + idx);
+}
+
+size_t b64Decode(char *in, size_t len, uint8_t *out) {
+    assert(in != NULL && out != NULL);
+
+    size_t n = __b64DecodeGroups(in, len, out);
+    __DU_STAT_ADD(b64_decoded, n);
+    return n;
+}
+
+// Writes the 1 or 2 bytes of a final group of 'n' sextets
+static size_t __b64FlushPartial(uint32_t acc, size_t n, uint8_t *out) {
+    acc <<= 6 * (4 - n);
+    out[0] = (acc >> 16) & 0xFF;
+    if (n == 3) out[1] = (acc >> 8) & 0xFF;
+    return n - 1;
+}
+
+bool b64DecodeEx(const char *in, size_t len, uint8_t *out, uint32_t flags, size_t *written) {
+    assert((in != NULL || len == 0) && out != NULL);
+
+    // Classes that cannot appear as sextets or be skipped with these flags
+    uint8_t reject = (flags & DU_B64_URL_SAFE) ? 0 : __B64_URL;
+    bool skip_space = (flags & DU_B64_SKIP_SPACE) != 0;
+
+    size_t i = 0, idx = 0, n = 0;
+    uint32_t acc = 0;
+    bool ok = false, bulk = true;
+
+    while (i < len) {
+        // Runs of plain alphabet characters (e.g. each MIME line) go to the
+        // SIMD kernel, retried only after whitespace so a failed attempt
+        // is not repeated for every group
+        if (bulk && n == 0) {
+            size_t k = __b64_decode_kernel(in + i, len - i, out + idx);
+            i += k;
+            idx += k / 4 * 3;
+            bulk = false;
+            if (i == len) break;
+        }
+
+        uint8_t t = b64_xt[(uint8_t)in[i]];
+        if ((t & __B64_ALPHA) && !(t & reject)) {
+            acc = (acc << 6) | (t & 0x3F);
+            if (++n == 4) {
+                out[idx++] = (acc >> 16) & 0xFF;
+                out[idx++] = (acc >> 8 ) & 0xFF;
+                out[idx++] = acc & 0xFF;
+                n = 0;
+            }
+            i++;
+            continue;
+        }
+        if (t == __B64_SPACE && skip_space) {
+            bulk = true;
+            i++;
+            continue;
+        }
+        if (t != __B64_PAD || n < 2) goto done;
+
+        // Padding ends the data, only more padding and whitespace may follow
+        idx += __b64FlushPartial(acc, n, out + idx);
+        size_t pads = 4 - n;
+        n = 0;
+        for (; i < len; i++) {
+            t = b64_xt[(uint8_t)in[i]];
+            if (t == __B64_PAD && pads > 0) pads--;
+            else if (!(t == __B64_SPACE && skip_space)) goto done;
+        }
+        ok = pads == 0 || (flags & DU_B64_NO_PAD);
+        goto done;
+    }
+
+    if (n == 0) ok = true;
+    else if (n >= 2 && (flags & DU_B64_NO_PAD)) {
+        idx += __b64FlushPartial(acc, n, out + idx);
+        ok = true;
+    }
+
+done:
+    if (written) *written = idx;
+    return ok;
+}
+
+size_t b64EncodedLen(size_t len) {
+    return (len + 2) / 3 * 4;
+}
+
+size_t b64DecodedMaxLen(size_t len) {
+    return len / 4 * 3;
+}
+
+void b64EncoderInit(B64Encoder *enc) {
+    assert(enc != NULL);
+    enc->carry_len = 0;
+}
+
+size_t b64EncoderUpdate(B64Encoder *enc, const uint8_t *in, size_t len, char *out) {
+    assert(enc != NULL && (in != NULL || len == 0) && out != NULL);
+
+    size_t idx = 0;
+    __DU_STAT_ADD(b64_encoded, len);
+
+    // Complete the carried group first
+    if (enc->carry_len > 0) {
+        while (enc->carry_len < 3 && len > 0) {
+            enc->carry[enc->carry_len++] = *in++;
+            len--;
+        }
+        if (enc->carry_len < 3) return 0;
+        idx += __b64EncodeGroups(enc->carry, 3, out);
+        enc->carry_len = 0;
+    }
+
+    size_t rem = len % 3;
+    idx += __b64EncodeGroups(in, len - rem, out + idx);
+
+    if (rem > 0) memcpy(enc->carry, in + len - rem, rem);
+    enc->carry_len = (uint8_t)rem;
+    return idx;
+}
+
+size_t b64EncoderFinal(B64Encoder *enc, char *out) {
+    assert(enc != NULL && out != NULL);
+
+    size_t idx = __b64EncodeTail(enc->carry, enc->carry_len, out);
+    enc->carry_len = 0;
+    return idx;
+}
+
+void b64DecoderInit(B64Decoder *dec) {
+    assert(dec != NULL);
+    dec->carry_len = 0;
+}
+
+size_t b64DecoderUpdate(B64Decoder *dec, const char *in, size_t len, uint8_t *out) {
+    assert(dec != NULL && (in != NULL || len == 0) && out != NULL);
+
+    size_t idx = 0;
+
+    // Complete the carried group first
+    if (dec->carry_len > 0) {
+        while (dec->carry_len < 4 && len > 0) {
+            dec->carry[dec->carry_len++] = *in++;
+            len--;
+        }
+        if (dec->carry_len < 4) return 0;
+        idx += __b64DecodeGroup(dec->carry, out);
+        dec->carry_len = 0;
+    }
+
+    size_t rem = len % 4;
+    idx += __b64DecodeGroups(in, len - rem, out + idx);
+
+    if (rem > 0) memcpy(dec->carry, in + len - rem, rem);
+    dec->carry_len = (uint8_t)rem;
+    __DU_STAT_ADD(b64_decoded, idx);
+    return idx;
+}
+
+size_t b64DecoderFinal(B64Decoder *dec, uint8_t *out) {
+    assert(dec != NULL && out != NULL);
+
+    size_t idx = 0;
+    if (dec->carry_len >= 2) {
+        for (size_t i = dec->carry_len; i < 4; i++) dec->carry[i] = '=';
+        idx = __b64DecodeGroup(dec->carry, out);
+    }
+    dec->carry_len = 0;
+    __DU_STAT_ADD(b64_decoded, idx);
+    return idx;
+}
+
+#ifdef DU_POOL
+
+// Groups handed to a thread at once (192 KiB of input when encoding)
+#define DU_B64_PARALLEL_GRAIN (64u << 10)
+
+typedef struct {
+    const void *in;
+    void       *out;
+} __B64ParallelJob;
+
+static void __b64EncodeTask(void *arg, size_t begin, size_t end) {
+    __B64ParallelJob *j = arg;
+    __b64EncodeGroups((const uint8_t *)j->in + begin * 3, (end - begin) * 3, (char *)j->out + begin * 4);
+}
+
+static void __b64DecodeTask(void *arg, size_t begin, size_t end) {
+    __B64ParallelJob *j = arg;
+    __b64DecodeGroups((const char *)j->in + begin * 4, (end - begin) * 4, (uint8_t *)j->out + begin * 3);
+}
+
+size_t b64EncodeParallel(ThreadPool *pool, const uint8_t *in, size_t len, char *out) {
+    assert((in != NULL || len == 0) && out != NULL);
+
+    size_t groups = len / 3;
+    __DU_STAT_ADD(b64_encoded, len);
+    __B64ParallelJob job = { in, out };
+    parallelFor(pool, 0, groups, DU_B64_PARALLEL_GRAIN, __b64EncodeTask, &job);
+
+    size_t idx = groups * 4;
+    return idx + __b64EncodeTail(in + groups * 3, len % 3, out + idx);
+}
+
+size_t b64DecodeParallel(ThreadPool *pool, const char *in, size_t len, uint8_t *out) {
+    assert((in != NULL || len == 0) && out != NULL);
+
+    size_t groups = len / 4;
+    if (groups == 0) return 0;
+
+    // Every group but the last decodes to exactly 3 bytes
+    __B64ParallelJob job = { in, out };
+    parallelFor(pool, 0, groups - 1, DU_B64_PARALLEL_GRAIN, __b64DecodeTask, &job);
+
+    size_t idx = (groups - 1) * 3;
+    idx += __b64DecodeGroup(in + idx / 3 * 4, out + idx);
+    __DU_STAT_ADD(b64_decoded, idx);
+    return idx;
+}
+
+#endif // DU_POOL
+
+
+#endif // DU_BASE64
+
+
+#ifdef DU_HASH
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#define AI 0x67452301
+#define BI 0xefcdab89
+#define CI 0x98badcfe
+#define DI 0x10325476
+
+static const uint32_t S[64] = {
+    7,12,17,22,7,12,17,22,7,12,17,22,7,12,17,22,
+        5,9,14,20,5,9,14,20,5,9,14,20,5,9,14,20,
+    4,11,16,23,4,11,16,23,4,11,16,23,4,11,16,23,
+    6,10,15,21,6,10,15,21,6,10,15,21,6,10,15,21
+};
+
+static const uint32_t T[64] = {
+    0xd76aa478, 0xe8c7b756, 0x242070db, 0xc1bdceee,
+    0xf57c0faf, 0x4787c62a, 0xa8304613, 0xfd469501,
+    0x698098d8, 0x8b44f7af, 0xffff5bb1, 0x895cd7be,
+    0x6b901122, 0xfd987193, 0xa679438e, 0x49b40821,
+    0xf61e2562, 0xc040b340, 0x265e5a51, 0xe9b6c7aa,
+    0xd62f105d, 0x02441453, 0xd8a1e681, 0xe7d3fbc8,
+    0x21e1cde6, 0xc33707d6, 0xf4d50d87, 0x455a14ed,
+    0xa9e3e905, 0xfcefa3f8, 0x676f02d9, 0x8d2a4c8a,
+    0xfffa3942, 0x8771f681, 0x6d9d6122, 0xfde5380c,
+    0xa4beea44, 0x4bdecfa9, 0xf6bb4b60, 0xbebfbc70,
+    0x289b7ec6, 0xeaa127fa, 0xd4ef3085, 0x04881d05,
+    0xd9d4d039, 0xe6db99e5, 0x1fa27cf8, 0xc4ac5665,
+    0xf4292244, 0x432aff97, 0xab9423a7, 0xfc93a039,
+    0x655b59c3, 0x8f0ccc92, 0xffeff47d, 0x85845dd1,
+    0x6fa87e4f, 0xfe2ce6e0, 0xa3014314, 0x4e0811a1,
+    0xf7537e82, 0xbd3af235, 0x2ad7d2bb, 0xeb86d391
+};
+
+#define LR32(x,b) (((x) << ((b) & 31)) | ((x) >> (32 - ((b) & 31))))
+#define RR32(x,b) (((x) >> ((b) & 31)) | ((x) << (32 - ((b) & 31))))
+
+#define F(x,y,z)  (((x) & (y)) | ((~(x)) & (z)))
+#define G(x,y,z)  (((x) & (z)) | ((y) & (~z))  )
+#define H(x,y,z)  ((x) ^ (y) ^ (z)             )
+#define I(x,y,z)  ((y) ^ ((x) | (~z))          )
+
+#define FF(a, b, c, d, x, s, ac) \
+    a += F(b, c, d) + x + ac; \
+    a = LR32(a, s); \
+    a += b;
+
+#define GG(a, b, c, d, x, s, ac) \
+    a += G(b, c, d) + x + ac; \
+    a = LR32(a, s); \
+    a += b;
+
+#define HH(a, b, c, d, x, s, ac) \
+    a += H(b, c, d) + x + ac; \
+    a = LR32(a, s); \
+    a += b;
+
+#define II(a, b, c, d, x, s, ac) \
+    a += I(b, c, d) + x + ac; \
+    a = LR32(a, s); \
+    a += b;
+
+void md5Init(Md5Ctx *ctx) {
+    assert(ctx != NULL);
+    memset(ctx, 0, sizeof(Md5Ctx));
+    ctx->a = AI;
+    ctx->b = BI;
+    ctx->c = CI;
+    ctx->d = DI;
+}
+
+// The 64 MD5 steps on state a..d and message words M[0..15]. Only uses
+// + ^ & | ~ and shifts, so the same steps run on GCC vector types.
+#define __MD5_ROUNDS(a, b, c, d, M) \
+    /* Round 1 */                    \
+    FF(a, b, c, d, M[ 0],  7, T[ 0]); \
+    FF(d, a, b, c, M[ 1], 12, T[ 1]); \
+    FF(c, d, a, b, M[ 2], 17, T[ 2]); \
+    FF(b, c, d, a, M[ 3], 22, T[ 3]); \
+    FF(a, b, c, d, M[ 4],  7, T[ 4]); \
+    FF(d, a, b, c, M[ 5], 12, T[ 5]); \
+    FF(c, d, a, b, M[ 6], 17, T[ 6]); \
+    FF(b, c, d, a, M[ 7], 22, T[ 7]); \
+    FF(a, b, c, d, M[ 8],  7, T[ 8]); \
+    FF(d, a, b, c, M[ 9], 12, T[ 9]); \
+    FF(c, d, a, b, M[10], 17, T[10]); \
+    FF(b, c, d, a, M[11], 22, T[11]); \
+    FF(a, b, c, d, M[12],  7, T[12]); \
+    FF(d, a, b, c, M[13], 12, T[13]); \
+    FF(c, d, a, b, M[14], 17, T[14]); \
+    FF(b, c, d, a, M[15], 22, T[15]); \
+                                      \
+    /* Round 2 */                    \
+    GG(a, b, c, d, M[ 1],  5, T[16]); \
+    GG(d, a, b, c, M[ 6],  9, T[17]); \
+    GG(c, d, a, b, M[11], 14, T[18]); \
+    GG(b, c, d, a, M[ 0], 20, T[19]); \
+    GG(a, b, c, d, M[ 5],  5, T[20]); \
+    GG(d, a, b, c, M[10],  9, T[21]); \
+    GG(c, d, a, b, M[15], 14, T[22]); \
+    GG(b, c, d, a, M[ 4], 20, T[23]); \
+    GG(a, b, c, d, M[ 9],  5, T[24]); \
+    GG(d, a, b, c, M[14],  9, T[25]); \
+    GG(c, d, a, b, M[ 3], 14, T[26]); \
+    GG(b, c, d, a, M[ 8], 20, T[27]); \
+    GG(a, b, c, d, M[13],  5, T[28]); \
+    GG(d, a, b, c, M[ 2],  9, T[29]); \
+    GG(c, d, a, b, M[ 7], 14, T[30]); \
+    GG(b, c, d, a, M[12], 20, T[31]); \
+                                      \
+    /* Round 3 */                    \
+    HH(a, b, c, d, M[ 5],  4, T[32]); \
+    HH(d, a, b, c, M[ 8], 11, T[33]); \
+    HH(c, d, a, b, M[11], 16, T[34]); \
+    HH(b, c, d, a, M[14], 23, T[35]); \
+    HH(a, b, c, d, M[ 1],  4, T[36]); \
+    HH(d, a, b, c, M[ 4], 11, T[37]); \
+    HH(c, d, a, b, M[ 7], 16, T[38]); \
+    HH(b, c, d, a, M[10], 23, T[39]); \
+    HH(a, b, c, d, M[13],  4, T[40]); \
+    HH(d, a, b, c, M[ 0], 11, T[41]); \
+    HH(c, d, a, b, M[ 3], 16, T[42]); \
+    HH(b, c, d, a, M[ 6], 23, T[43]); \
+    HH(a, b, c, d, M[ 9],  4, T[44]); \
+    HH(d, a, b, c, M[12], 11, T[45]); \
+    HH(c, d, a, b, M[15], 16, T[46]); \
+    HH(b, c, d, a, M[ 2], 23, T[47]); \
+                                      \
+    /* Round 4 */                    \
+    II(a, b, c, d, M[ 0],  6, T[48]); \
+    II(d, a, b, c, M[ 7], 10, T[49]); \
+    II(c, d, a, b, M[14], 15, T[50]); \
+    II(b, c, d, a, M[ 5], 21, T[51]); \
+    II(a, b, c, d, M[12],  6, T[52]); \
+    II(d, a, b, c, M[ 3], 10, T[53]); \
+    II(c, d, a, b, M[10], 15, T[54]); \
+    II(b, c, d, a, M[ 1], 21, T[55]); \
+    II(a, b, c, d, M[ 8],  6, T[56]); \
+    II(d, a, b, c, M[15], 10, T[57]); \
+    II(c, d, a, b, M[ 6], 15, T[58]); \
+    II(b, c, d, a, M[13], 21, T[59]); \
+    II(a, b, c, d, M[ 4],  6, T[60]); \
+    II(d, a, b, c, M[11], 10, T[61]); \
+    II(c, d, a, b, M[ 2], 15, T[62]); \
+    II(b, c, d, a, M[ 9], 21, T[63]);
+
+// Loads message word i of a block as little-endian
+static inline uint32_t __md5Word(const uint8_t *block, int i) {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    uint32_t w;
+    memcpy(&w, block + i * 4, sizeof(w));
+    return w;
+#else
+    return ((uint32_t)block[i * 4]       )
+    | ((uint32_t)block[(i * 4) + 1] <<  8)
+    | ((uint32_t)block[(i * 4) + 2] << 16)
+    | ((uint32_t)block[(i * 4) + 3] << 24);
+#endif
+}
+
+static void __md5HandleBlock(Md5Ctx *ctx, const uint8_t block[64]) {
+    assert(ctx != NULL && block != NULL);
+
+    uint32_t M[16];
+    for (int i = 0; i < 16; i++) M[i] = __md5Word(block, i);
+
+    uint32_t a = ctx->a;
+    uint32_t b = ctx->b;
+    uint32_t c = ctx->c;
+    uint32_t d = ctx->d;
+
+    __MD5_ROUNDS(a, b, c, d, M);
+
+    ctx->a += a;
+    ctx->b += b;
+    ctx->c += c;
+    ctx->d += d;
+}
+
+static void __md5UpdateLen(Md5Ctx *ctx, const uint8_t *in, size_t len, int update_len) {
+    assert(ctx != NULL && (in != NULL || len == 0));
+
+    if (update_len) ctx->size += len;
+
+    size_t offset = 0;
+    if (ctx->blen > 0) {
+        size_t copy = 64 - ctx->blen;
+        if (copy > len) copy = len;
+
+        memcpy(ctx->buff + ctx->blen, in, copy);
+        ctx->blen += copy;
+        offset += copy;
+
+        if (ctx->blen < 64) return;
+        __md5HandleBlock(ctx, ctx->buff);
+        ctx->blen = 0;
+    }
+
+    // Whole blocks are hashed straight from the caller's buffer
+    while (len - offset >= 64) {
+        __md5HandleBlock(ctx, in + offset);
+        offset += 64;
+    }
+
+    if (len > offset) {
+        ctx->blen = len - offset;
+        memcpy(ctx->buff, in + offset, ctx->blen);
+    }
+}
+
+void md5Update(Md5Ctx *ctx, const void *data, size_t len) {
+    __DU_STAT_ADD(md5_bytes, len);
+    __md5UpdateLen(ctx, (const uint8_t *)data, len, 1);
+}
+
+void md5Final(Md5Ctx *ctx, uint8_t out[16]) {
+    assert(ctx != NULL && out != NULL);
+
+    uint8_t padding[64] = {0x80};
+    size_t pad_len = (ctx->blen < 56) ? (56 - ctx->blen) : (120 - ctx->blen);
+    __md5UpdateLen(ctx, padding, pad_len, 0);
+
+    uint8_t length_bytes[8];
+    uint64_t size_bits = ctx->size * 8;
+    for (int i = 0; i < 8; i++) {
+        length_bytes[i] = (uint8_t)((size_bits >> (8 * i)) & 0xFF);
+    }
+    __md5UpdateLen(ctx, length_bytes, 8, 0);
+
+    uint32_t state[4] = { ctx->a, ctx->b, ctx->c, ctx->d };
+    for (int i = 0; i < 4; i++) {
+        out[(i * 4)    ] = (state[i] >>  0) & 0xFF;
+        out[(i * 4) + 1] = (state[i] >>  8) & 0xFF;
+        out[(i * 4) + 2] = (state[i] >> 16) & 0xFF;
+        out[(i * 4) + 3] = (state[i] >> 24) & 0xFF;
+    }
+
+    ctx->blen = 0;
+    ctx->size = 0;
+    memset(ctx->buff, 0, 64);
+}
+
+void md5Digest(uint8_t *data, size_t len, uint8_t out[16]) {
+    Md5Ctx ctx;
+    md5Init(&ctx);
+    md5Update(&ctx, data, len);
+    md5Final(&ctx, out);
+}
+
+// Chunk size for hashing files that cannot be mapped
+#define DU_MD5_READ_CHUNK (1u << 20)
+
+#if defined(__unix__) || defined(__APPLE__)
+
+bool md5File(const char *path, uint8_t out[16]) {
+    assert(path != NULL && out != NULL);
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return false;
+
+    Md5Ctx ctx;
+    md5Init(&ctx);
+
+    struct stat st;
+    if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode)
+            && st.st_size > 0 && (uint64_t)st.st_size <= SIZE_MAX) {
+        size_t size = (size_t)st.st_size;
+        void *map = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (map != MAP_FAILED) {
+#if defined(POSIX_MADV_SEQUENTIAL)
+            posix_madvise(map, size, POSIX_MADV_SEQUENTIAL);
+#elif defined(MADV_SEQUENTIAL)
+            madvise(map, size, MADV_SEQUENTIAL);
+#endif
+            md5Update(&ctx, map, size);
+            munmap(map, size);
+            close(fd);
+            md5Final(&ctx, out);
+            return true;
+        }
+    }
+
+    // Pipes, empty or special files, or a failed mmap
+    uint8_t *buf = (uint8_t *)duMalloc(DU_MD5_READ_CHUNK);
+    if (!buf) {
+        close(fd);
+        return false;
+    }
+
+    bool ok = true;
+    for (;;) {
+        ssize_t n = read(fd, buf, DU_MD5_READ_CHUNK);
+        if (n > 0) md5Update(&ctx, buf, (size_t)n);
+        else if (n == 0) break;
+        else if (errno != EINTR) {
+            ok = false;
+            break;
+        }
+    }
+
+    duFree(buf);
+    close(fd);
+    if (ok) md5Final(&ctx, out);
+    return ok;
+}
+
+#else
+
+bool md5File(const char *path, uint8_t out[16]) {
+    assert(path != NULL && out != NULL);
+
+    FILE *f = fopen(path, "rb");
+    if (!f) return false;
+
+    uint8_t *buf = (uint8_t *)duMalloc(DU_MD5_READ_CHUNK);
+    if (!buf) {
+        fclose(f);
+        return false;
+    }
+
+    Md5Ctx ctx;
+    md5Init(&ctx);
+
+    size_t n;
+    while ((n = fread(buf, 1, DU_MD5_READ_CHUNK, f)) > 0) md5Update(&ctx, buf, n);
+    bool ok = !ferror(f);
+
+    duFree(buf);
+    fclose(f);
+    if (ok) md5Final(&ctx, out);
+    return ok;
+}
+
+#endif
+
+
+// Widest multi-buffer kernel, in lanes
+#define DU_MD5_LANES 16
+
+// One lane of md5DigestMany: the message it is hashing and its padded tail
+typedef struct {
+    const uint8_t *data;      // Next whole block of the message
+    size_t         blocks;    // Whole blocks left at 'data'
+    const uint8_t *tail_at;   // Next tail block, once 'blocks' runs out
+    const uint8_t *tail_end;  // End of the padded tail
+    size_t         msg;       // Index of the message in this lane
+    uint8_t        tail[128]; // Last partial block plus padding and length
+} __Md5Lane;
+
+// Hashes one block for each of the first W lanes of the (lane-major) state
+typedef void (*__Md5ManyKernel)(uint32_t st[4][DU_MD5_LANES], const uint8_t *const blk[DU_MD5_LANES]);
+
+#if !defined(DU_HASH_NO_SIMD) && defined(__GNUC__)
+
+/*
+ * Generates a W-lane kernel. The state and message words are GCC vector
+ * types, so the shared __MD5_ROUNDS steps compile to one vector op per
+ * scalar op. Message words are transposed into lanes on load.
+ */
+#define __MD5_MANY_KERNEL(name, W, attr)                                       \
+    attr static void name(uint32_t st[4][DU_MD5_LANES],                       \
+                          const uint8_t *const blk[DU_MD5_LANES]) {           \
+        typedef uint32_t __v __attribute__((vector_size(4 * (W))));           \
+        __v M[16], a, b, c, d, a0, b0, c0, d0;                                \
+        for (int i = 0; i < 16; i++) {                                        \
+            uint32_t w[W];                                                    \
+            for (int l = 0; l < (W); l++) w[l] = __md5Word(blk[l], i);        \
+            memcpy(&M[i], w, sizeof(w));                                      \
+        }                                                                     \
+        memcpy(&a, st[0], sizeof(a));                                         \
+        memcpy(&b, st[1], sizeof(b));                                         \
+        memcpy(&c, st[2], sizeof(c));                                         \
+        memcpy(&d, st[3], sizeof(d));                                         \
+        a0 = a; b0 = b; c0 = c; d0 = d;                                       \
+                                                                              \
+        __MD5_ROUNDS(a, b, c, d, M);                                          \
+                                                                              \
+        a += a0; b += b0; c += c0; d += d0;                                   \
+        memcpy(st[0], &a, sizeof(a));                                         \
+        memcpy(st[1], &b, sizeof(b));                                         \
+        memcpy(st[2], &c, sizeof(c));                                         \
+        memcpy(st[3], &d, sizeof(d));                                         \
+    }
+
+#if defined(__x86_64__) || defined(__i386__)
+
+__MD5_MANY_KERNEL(__md5ManySse2,    4, __attribute__((target("sse2"))))
+__MD5_MANY_KERNEL(__md5ManyAvx2,    8, __attribute__((target("avx2"))))
+__MD5_MANY_KERNEL(__md5ManyAvx512, 16, __attribute__((target("avx512f"))))
+
+static __Md5ManyKernel __md5_many_kernel = __md5ManySse2;
+static size_t          __md5_many_lanes  = 4;
+
+__attribute__((constructor))
+static void __md5SelectKernel(void) {
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) {
+        __md5_many_kernel = __md5ManyAvx512;
+        __md5_many_lanes  = 16;
+    } else if (__builtin_cpu_supports("avx2")) {
+        __md5_many_kernel = __md5ManyAvx2;
+        __md5_many_lanes  = 8;
+    }
+}
+
+#else
+
+// 128-bit vectors map onto NEON and other targets' native SIMD
+__MD5_MANY_KERNEL(__md5ManyVec, 4, )
+
+static const __Md5ManyKernel __md5_many_kernel = __md5ManyVec;
+static const size_t          __md5_many_lanes  = 4;
+
+#endif
+
+#undef __MD5_MANY_KERNEL
+
+// Points a lane at message 'm' and resets its state
+static void __md5LaneStart(__Md5Lane *lane, uint32_t st[4][DU_MD5_LANES], size_t l,
+                           const uint8_t *data, size_t len, size_t m) {
+    size_t rem = len % 64;
+
+    lane->data = data;
+    lane->blocks = len / 64;
+    lane->msg = m;
+
+    size_t tail_len = rem < 56 ? 64 : 128;
+    memset(lane->tail, 0, tail_len);
+    if (rem > 0) memcpy(lane->tail, data + len - rem, rem);
+    lane->tail[rem] = 0x80;
+    lane->tail_at = lane->tail;
+    lane->tail_end = lane->tail + tail_len;
+
+    uint64_t size_bits = (uint64_t)len * 8;
+    for (int i = 0; i < 8; i++) {
+        lane->tail[tail_len - 8 + i] = (uint8_t)((size_bits >> (8 * i)) & 0xFF);
+    }
+
+    st[0][l] = AI;
+    st[1][l] = BI;
+    st[2][l] = CI;
+    st[3][l] = DI;
+}
+
+void md5DigestMany(const uint8_t *const inputs[], const size_t lens[], uint8_t outs[][16], size_t n) {
+    assert((inputs != NULL && lens != NULL && outs != NULL) || n == 0);
+
+    size_t lanes = __md5_many_lanes;
+    if (n < 2) {
+        if (n == 1) md5Digest((uint8_t *)inputs[0], lens[0], outs[0]);
+        return;
+    }
+    __DU_STAT(for (size_t i = 0; i < n; i++) __DU_STAT_ADD(md5_bytes, lens[i]));
+
+    // Idle lanes hash this block and their results are never stored
+    static const uint8_t idle[64] = {0};
+
+    __Md5Lane lane[DU_MD5_LANES];
+    uint32_t st[4][DU_MD5_LANES];
+    const uint8_t *blk[DU_MD5_LANES];
+    bool busy[DU_MD5_LANES] = {0};
+    size_t next = 0, active = 0;
+
+    for (size_t l = 0; l < lanes && next < n; l++, next++, active++) {
+        __md5LaneStart(&lane[l], st, l, inputs[next], lens[next], next);
+        busy[l] = true;
+    }
+
+    while (active > 0) {
+        for (size_t l = 0; l < lanes; l++) {
+            if (!busy[l]) blk[l] = idle;
+            else blk[l] = lane[l].blocks > 0 ? lane[l].data : lane[l].tail_at;
+        }
+
+        __md5_many_kernel(st, blk);
+
+        for (size_t l = 0; l < lanes; l++) {
+            if (!busy[l]) continue;
+
+            __Md5Lane *ln = &lane[l];
+            if (ln->blocks > 0) {
+                ln->data += 64;
+                ln->blocks--;
+                continue;
+            }
+            ln->tail_at += 64;
+            if (ln->tail_at < ln->tail_end) continue;
+
+            // Message done, store its digest and refill the lane
+            for (int k = 0; k < 4; k++) {
+                outs[ln->msg][(k * 4)    ] = (st[k][l] >>  0) & 0xFF;
+                outs[ln->msg][(k * 4) + 1] = (st[k][l] >>  8) & 0xFF;
+                outs[ln->msg][(k * 4) + 2] = (st[k][l] >> 16) & 0xFF;
+                outs[ln->msg][(k * 4) + 3] = (st[k][l] >> 24) & 0xFF;
+            }
+            if (next < n) {
+                __md5LaneStart(ln, st, l, inputs[next], lens[next], next);
+                next++;
+            } else {
+                busy[l] = false;
+                active--;
+            }
+        }
+    }
+}
+
+#else
+
+void md5DigestMany(const uint8_t *const inputs[], const size_t lens[], uint8_t outs[][16], size_t n) {
+    assert((inputs != NULL && lens != NULL && outs != NULL) || n == 0);
+
+    for (size_t i = 0; i < n; i++) md5Digest((uint8_t *)inputs[i], lens[i], outs[i]);
+}
+
+#endif
+
+#undef F
+#undef G
+#undef H
+#undef I
+#undef FF
+#undef GG
+#undef HH
+#undef II
+#undef __MD5_ROUNDS
+
+/*
+ * Second hash128 lane: wyhash with an independent secret, so the two
+ * 64-bit halves do not collide together.
+ */
+static const uint64_t __du_wy_secret2[4] = {
+    0xa0761d6478bd642full, 0xe7037ed1a0b428dbull,
+    0x8ebc6af09c88c6e3ull, 0x589965cc75374cc3ull
+};
+
+static const uint64_t *const __hash_secrets[2] = { __du_wy_secret, __du_wy_secret2 };
+
+uint64_t hash64(const void *data, size_t len, uint64_t seed) {
+    assert(data != NULL || len == 0);
+    return __duWyhash(data, len, seed, __du_wy_secret);
+}
+
+// Stores a 64-bit value little-endian
+static inline void __hashStore64(uint8_t *out, uint64_t v) {
+    for (int i = 0; i < 8; i++) out[i] = (uint8_t)((v >> (8 * i)) & 0xFF);
+}
+
+void hash128(const void *data, size_t len, uint64_t seed, uint8_t out[16]) {
+    assert((data != NULL || len == 0) && out != NULL);
+    __hashStore64(out,     __duWyhash(data, len, seed, __du_wy_secret));
+    __hashStore64(out + 8, __duWyhash(data, len, seed, __du_wy_secret2));
+}
+
+static void __hashInit(HashCtx *ctx, uint64_t seed, uint8_t lanes) {
+    assert(ctx != NULL);
+    memset(ctx, 0, sizeof(HashCtx));
+    ctx->lanes = lanes;
+    for (int l = 0; l < lanes; l++) {
+        const uint64_t *s = __hash_secrets[l];
+        ctx->seed[l] = seed ^ __duMix(seed ^ s[0], s[1]);
+        ctx->see1[l] = ctx->seed[l];
+        ctx->see2[l] = ctx->seed[l];
+    }
+}
+
+void hash64Init(HashCtx *ctx, uint64_t seed) {
+    __hashInit(ctx, seed, 1);
+}
+
+void hash128Init(HashCtx *ctx, uint64_t seed) {
+    __hashInit(ctx, seed, 2);
+}
+
+// One 48-byte step of the long-input loop, on every lane
+static inline void __hashStripe(HashCtx *ctx, const uint8_t *p) {
+    for (int l = 0; l < ctx->lanes; l++) {
+        const uint64_t *s = __hash_secrets[l];
+        ctx->seed[l] = __duMix(__duRead8(p)      ^ s[1], __duRead8(p + 8)  ^ ctx->seed[l]);
+        ctx->see1[l] = __duMix(__duRead8(p + 16) ^ s[2], __duRead8(p + 24) ^ ctx->see1[l]);
+        ctx->see2[l] = __duMix(__duRead8(p + 32) ^ s[3], __duRead8(p + 40) ^ ctx->see2[l]);
+    }
+}
+
+/*
+ * The one-shot loop only takes a 48-byte step while more than 48 bytes
+ * remain, and its last read may reach back up to 15 bytes before the
+ * remainder. So 1..48 bytes are always held back as pending, preceded
+ * by the 16 bytes that came before them.
+ */
+void hashUpdate(HashCtx *ctx, const void *data, size_t len) {
+    assert(ctx != NULL && (data != NULL || len == 0));
+
+    const uint8_t *in = (const uint8_t *)data;
+    uint8_t *pending = ctx->buff + 16;
+    ctx->size += len;
+
+    if (ctx->blen + len <= 48) {
+        if (len > 0) memcpy(pending + ctx->blen, in, len);
+        ctx->blen += len;
+        return;
+    }
+
+    if (ctx->blen > 0) {
+        size_t fill = 48 - ctx->blen;
+        memcpy(pending + ctx->blen, in, fill);
+        __hashStripe(ctx, pending);
+        memcpy(ctx->buff, pending + 32, 16);
+        in += fill;
+        len -= fill;
+        ctx->blen = 0;
+    }
+
+    // Whole steps are hashed straight from the caller's buffer
+    if (len > 48) {
+        do {
+            __hashStripe(ctx, in);
+            in += 48;
+            len -= 48;
+        } while (len > 48);
+        memcpy(ctx->buff, in - 16, 16);
+    }
+
+    memcpy(pending, in, len);
+    ctx->blen = len;
+}
+
+static uint64_t __hashFinal(const HashCtx *ctx, int l) {
+    const uint64_t *s = __hash_secrets[l];
+    const uint8_t *p = ctx->buff + 16;
+    uint64_t seed = ctx->seed[l], a, b;
+
+    if (ctx->size <= 16) {
+        __duWyShort(p, ctx->blen, &a, &b);
+    } else {
+        size_t i = ctx->blen;
+        if (ctx->size > 48) seed ^= ctx->see1[l] ^ ctx->see2[l];
+        while (i > 16) {
+            seed = __duMix(__duRead8(p) ^ s[1], __duRead8(p + 8) ^ seed);
+            p += 16;
+            i -= 16;
+        }
+        a = __duRead8(p + i - 16);
+        b = __duRead8(p + i - 8);
+    }
+
+    return __duWyFinish(a, b, seed, ctx->size, s);
+}
+
+uint64_t hash64Final(HashCtx *ctx) {
+    assert(ctx != NULL && ctx->lanes == 1);
+    return __hashFinal(ctx, 0);
+}
+
+void hash128Final(HashCtx *ctx, uint8_t out[16]) {
+    assert(ctx != NULL && ctx->lanes == 2 && out != NULL);
+    __hashStore64(out,     __hashFinal(ctx, 0));
+    __hashStore64(out + 8, __hashFinal(ctx, 1));
+}
+
+static const uint32_t __sha256_k[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5,
+    0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3,
+    0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc,
+    0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7,
+    0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13,
+    0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3,
+    0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5,
+    0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208,
+    0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+static const uint32_t __sha256_iv[8] = {
+    0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+    0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+};
+
+// Hashes 'n' consecutive 64-byte blocks into the state
+typedef void (*__Sha256Kernel)(uint32_t st[8], const uint8_t *p, size_t n);
+
+static inline uint32_t __sha256Load(const uint8_t *p) {
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+#define __SHA_ROR(x, n)  (((x) >> (n)) | ((x) << (32 - (n))))
+
+static void __sha256Scalar(uint32_t st[8], const uint8_t *p, size_t n) {
+    for (; n > 0; n--, p += 64) {
+        uint32_t w[64];
+        for (int i = 0; i < 16; i++) w[i] = __sha256Load(p + i * 4);
+        for (int i = 16; i < 64; i++) {
+            uint32_t s0 = __SHA_ROR(w[i-15], 7) ^ __SHA_ROR(w[i-15], 18) ^ (w[i-15] >> 3);
+            uint32_t s1 = __SHA_ROR(w[i-2], 17) ^ __SHA_ROR(w[i-2], 19)  ^ (w[i-2] >> 10);
+            w[i] = w[i-16] + s0 + w[i-7] + s1;
+        }
+
+        uint32_t a = st[0], b = st[1], c = st[2], d = st[3];
+        uint32_t e = st[4], f = st[5], g = st[6], h = st[7];
+
+        for (int i = 0; i < 64; i++) {
+            uint32_t S1 = __SHA_ROR(e, 6) ^ __SHA_ROR(e, 11) ^ __SHA_ROR(e, 25);
+            uint32_t ch = (e & f) ^ (~e & g);
+            uint32_t t1 = h + S1 + ch + __sha256_k[i] + w[i];
+            uint32_t S0 = __SHA_ROR(a, 2) ^ __SHA_ROR(a, 13) ^ __SHA_ROR(a, 22);
+            uint32_t maj = (a & b) ^ (a & c) ^ (b & c);
+            uint32_t t2 = S0 + maj;
+
+            h = g; g = f; f = e; e = d + t1;
+            d = c; c = b; b = a; a = t1 + t2;
+        }
+
+        st[0] += a; st[1] += b; st[2] += c; st[3] += d;
+        st[4] += e; st[5] += f; st[6] += g; st[7] += h;
+    }
+}
+
+#undef __SHA_ROR
+
+#if !defined(DU_HASH_NO_SIMD) && defined(__GNUC__) \
+        && (defined(__x86_64__) || defined(__i386__))
+
+#include <immintrin.h>
+
+// SHA-NI: the state lives as ABEF/CDGH, each sha256rnds2 does 2 rounds
+__attribute__((target("sha,sse4.1")))
+static void __sha256Shani(uint32_t st[8], const uint8_t *p, size_t n) {
+    const __m128i bswap = _mm_set_epi64x(0x0c0d0e0f08090a0bull, 0x0405060700010203ull);
+
+    __m128i tmp = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i *)&st[0]), 0xB1);
+    __m128i s1  = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i *)&st[4]), 0x1B);
+    __m128i s0  = _mm_alignr_epi8(tmp, s1, 8);
+    s1 = _mm_blend_epi16(s1, tmp, 0xF0);
+
+    for (; n > 0; n--, p += 64) {
+        __m128i abef = s0, cdgh = s1;
+        __m128i w[4];
+        for (int i = 0; i < 4; i++) {
+            w[i] = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(p + i * 16)), bswap);
+        }
+
+        // Rounds 4k..4k+3, scheduling the message words 16 rounds ahead.
+        // Unrolled so the words stay in registers and the branches fold.
+        #pragma GCC unroll 16
+        for (int k = 0; k < 16; k++) {
+            __m128i cur = w[k & 3];
+            __m128i msg = _mm_add_epi32(cur, _mm_loadu_si128((const __m128i *)&__sha256_k[k * 4]));
+            s1 = _mm_sha256rnds2_epu32(s1, s0, msg);
+            if (k >= 3 && k < 15) {
+                __m128i next = _mm_add_epi32(w[(k + 1) & 3], _mm_alignr_epi8(cur, w[(k + 3) & 3], 4));
+                w[(k + 1) & 3] = _mm_sha256msg2_epu32(next, cur);
+            }
+            s0 = _mm_sha256rnds2_epu32(s0, s1, _mm_shuffle_epi32(msg, 0x0E));
+            if (k >= 1 && k < 13) w[(k + 3) & 3] = _mm_sha256msg1_epu32(w[(k + 3) & 3], cur);
+        }
+
+        s0 = _mm_add_epi32(s0, abef);
+        s1 = _mm_add_epi32(s1, cdgh);
+    }
+
+    tmp = _mm_shuffle_epi32(s0, 0x1B);
+    s1  = _mm_shuffle_epi32(s1, 0xB1);
+    _mm_storeu_si128((__m128i *)&st[0], _mm_blend_epi16(tmp, s1, 0xF0));
+    _mm_storeu_si128((__m128i *)&st[4], _mm_alignr_epi8(s1, tmp, 8));
+}
+
+static __Sha256Kernel __sha256_kernel = __sha256Scalar;
+
+__attribute__((constructor))
+static void __sha256SelectKernel(void) {
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("sha") && __builtin_cpu_supports("sse4.1")) {
+        __sha256_kernel = __sha256Shani;
+    }
+}
+
+#elif !defined(DU_HASH_NO_SIMD) && defined(__aarch64__) \
+        && (defined(__ARM_FEATURE_SHA2) || defined(__ARM_FEATURE_CRYPTO))
+
+#include <arm_neon.h>
+
+// ARMv8 SHA-2: each vsha256h/h2 pair does 4 rounds
+static void __sha256Arm(uint32_t st[8], const uint8_t *p, size_t n) {
+    uint32x4_t s0 = vld1q_u32(&st[0]);
+    uint32x4_t s1 = vld1q_u32(&st[4]);
+
+    for (; n > 0; n--, p += 64) {
+        uint32x4_t abcd = s0, efgh = s1;
+        uint32x4_t w[4];
+        for (int i = 0; i < 4; i++) w[i] = vreinterpretq_u32_u8(vrev32q_u8(vld1q_u8(p + i * 16)));
+
+        for (int k = 0; k < 16; k++) {
+            uint32x4_t msg = vaddq_u32(w[k & 3], vld1q_u32(&__sha256_k[k * 4]));
+            if (k < 12) {
+                w[k & 3] = vsha256su1q_u32(vsha256su0q_u32(w[k & 3], w[(k + 1) & 3]),
+                                           w[(k + 2) & 3], w[(k + 3) & 3]);
+            }
+            uint32x4_t prev = s0;
+            s0 = vsha256hq_u32(s0, s1, msg);
+            s1 = vsha256h2q_u32(s1, prev, msg);
+        }
+
+        s0 = vaddq_u32(s0, abcd);
+        s1 = vaddq_u32(s1, efgh);
+    }
+
+    vst1q_u32(&st[0], s0);
+    vst1q_u32(&st[4], s1);
+}
+
+static const __Sha256Kernel __sha256_kernel = __sha256Arm;
+
+#else
+
+static const __Sha256Kernel __sha256_kernel = __sha256Scalar;
+
+#endif
+
+void sha256Init(Sha256Ctx *ctx) {
+    assert(ctx != NULL);
+    memset(ctx, 0, sizeof(Sha256Ctx));
+    memcpy(ctx->state, __sha256_iv, sizeof(ctx->state));
+}
+
+void sha256Update(Sha256Ctx *ctx, const void *data, size_t len) {
+    assert(ctx != NULL && (data != NULL || len == 0));
+
+    const uint8_t *in = (const uint8_t *)data;
+    ctx->size += len;
+    __DU_STAT_ADD(sha256_bytes, len);
+
+    if (ctx->blen > 0) {
+        size_t copy = 64 - ctx->blen;
+        if (copy > len) copy = len;
+
+        memcpy(ctx->buff + ctx->blen, in, copy);
+        ctx->blen += copy;
+        in += copy;
+        len -= copy;
+
+        if (ctx->blen < 64) return;
+        __sha256_kernel(ctx->state, ctx->buff, 1);
+        ctx->blen = 0;
+    }
+
+    // Whole blocks are hashed straight from the caller's buffer
+    if (len >= 64) {
+        __sha256_kernel(ctx->state, in, len / 64);
+        in += len & ~(size_t)63;
+        len &= 63;
+    }
+
+    if (len > 0) {
+        memcpy(ctx->buff, in, len);
+        ctx->blen = len;
+    }
+}
+
+void sha256Final(Sha256Ctx *ctx, uint8_t out[32]) {
+    assert(ctx != NULL && out != NULL);
+
+    uint64_t size_bits = ctx->size * 8;
+    ctx->buff[ctx->blen++] = 0x80;
+    if (ctx->blen > 56) {
+        memset(ctx->buff + ctx->blen, 0, 64 - ctx->blen);
+        __sha256_kernel(ctx->state, ctx->buff, 1);
+        ctx->blen = 0;
+    }
+    memset(ctx->buff + ctx->blen, 0, 56 - ctx->blen);
+    for (int i = 0; i < 8; i++) ctx->buff[56 + i] = (uint8_t)((size_bits >> (56 - 8 * i)) & 0xFF);
+    __sha256_kernel(ctx->state, ctx->buff, 1);
+
+    for (int i = 0; i < 8; i++) {
+        out[(i * 4)    ] = (ctx->state[i] >> 24) & 0xFF;
+        out[(i * 4) + 1] = (ctx->state[i] >> 16) & 0xFF;
+        out[(i * 4) + 2] = (ctx->state[i] >>  8) & 0xFF;
+        out[(i * 4) + 3] = (ctx->state[i]      ) & 0xFF;
+    }
+
+    ctx->blen = 0;
+    ctx->size = 0;
+    memset(ctx->buff, 0, 64);
+}
+
+void sha256Digest(const uint8_t *data, size_t len, uint8_t out[32]) {
+    Sha256Ctx ctx;
+    sha256Init(&ctx);
+    sha256Update(&ctx, data, len);
+    sha256Final(&ctx, out);
+}
+
+#ifdef DU_POOL
+
+typedef struct {
+    const uint8_t *data;
+    size_t         len;
+    size_t         chunk;
+    uint8_t       *leaves;  // 32 bytes per chunk
+} __Sha256TreeJob;
+
+static void __sha256TreeTask(void *arg, size_t begin, size_t end) {
+    __Sha256TreeJob *j = arg;
+    for (size_t i = begin; i < end; i++) {
+        size_t off = i * j->chunk;
+        size_t n = (j->len - off < j->chunk) ? j->len - off : j->chunk;
+        sha256Digest(j->data + off, n, j->leaves + i * 32);
+    }
+}
+
+bool sha256Tree(ThreadPool *pool, const uint8_t *data, size_t len, size_t chunk, uint8_t out[32]) {
+    assert((data != NULL || len == 0) && out != NULL);
+    if (chunk == 0) chunk = DU_HASH_TREE_CHUNK;
+
+    size_t leaves = len / chunk + (len % chunk != 0 || len == 0);
+    __Sha256TreeJob job = { data, len, chunk, (uint8_t *)duMalloc(leaves * 32) };
+    if (!job.leaves) return false;
+
+    parallelFor(pool, 0, leaves, 1, __sha256TreeTask, &job);
+
+    uint8_t sizes[16];
+    __hashStore64(sizes, (uint64_t)len);
+    __hashStore64(sizes + 8, (uint64_t)chunk);
+
+    Sha256Ctx ctx;
+    sha256Init(&ctx);
+    sha256Update(&ctx, job.leaves, leaves * 32);
+    sha256Update(&ctx, sizes, sizeof(sizes));
+    sha256Final(&ctx, out);
+
+    duFree(job.leaves);
+    return true;
+}
+
+#endif // DU_POOL
+
+
+
+#endif // DU_HASH
+
+
+#ifdef DU_VECTOR
+
+void __vecPurge(Vector *vec) {
+    assert(vec);
+    memset(vec->data, 0, (size_t)vec->cell_size * vec->capacity);
+}
+
+static inline bool __vecIsInline(const Vector *vec) {
+    return vec->data == (const void *)vec->inline_buf.bytes;
+}
+
+// Moves the cells into a heap buffer of exactly 'cap' cells.
+// Inline storage is copied out, heap storage is realloc'd.
+static bool __vecRealloc(Vector *vec, size_t cap) {
+    if (cap > SIZE_MAX / vec->cell_size) return false;
+    size_t bytes = (size_t)vec->cell_size * cap;
+
+    void *temp;
+    __DU_STAT(uintptr_t old = (uintptr_t)vec->data);
+    if (__vecIsInline(vec)) {
+        temp = __duAllocA(vec->alloc, bytes);
+        if (temp) memcpy(temp, vec->data, (size_t)vec->cell_size * vec->length);
+    } else {
+        temp = __duReallocA(vec->alloc, vec->data, bytes);
+    }
+    if (!temp) return false;
+
+    __DU_STAT_ADD(vec_grows, 1);
+    __DU_STAT(if ((uintptr_t)temp != old) __DU_STAT_ADD(vec_bytes_copied, (size_t)vec->cell_size * vec->length));
+
+    vec->data = temp;
+    vec->capacity = cap;
+    return true;
+}
+
+// Grows the buffer geometrically until it holds at least 'min_cap' cells
+static bool __vecGrow(Vector *vec, size_t min_cap) {
+    if (min_cap <= vec->capacity) return true;
+
+    size_t cap = vec->capacity ? vec->capacity : 4;
+    while (cap < min_cap) cap = (cap > SIZE_MAX / 2) ? min_cap : cap * 2;
+
+    return __vecRealloc(vec, cap) || __vecRealloc(vec, min_cap);
+}
+
+// Sets up storage for 'capacity' cells, inline if they fit
+static bool __vecSetup(Vector *vec, uint16_t cell_size, size_t capacity, bool do_clear) {
+    vec->length = 0;
+    vec->cell_size = cell_size;
+
+    size_t inline_cap = DU_VEC_INLINE_BYTES / cell_size;
+    if (capacity <= inline_cap) {
+        vec->capacity = inline_cap;
+        vec->data = vec->inline_buf.bytes;
+    } else {
+        if (capacity > SIZE_MAX / cell_size) return false;
+        vec->capacity = capacity;
+        vec->data = __duAllocA(vec->alloc, (size_t)cell_size * capacity);
+        if (!vec->data) return false;
+    }
+
+    if (do_clear) __vecPurge(vec);
+    return true;
+}
+
+Vector *vecNewWith(const DuAllocator *alloc, uint16_t cell_size, size_t capacity_opt, bool do_clear) {
+    assert(cell_size > 0);
+    if (capacity_opt == 0) capacity_opt = 4;
+    if (!alloc) alloc = duGetAllocator();
+
+    Vector *v = (Vector *)__duAllocA(alloc, sizeof(Vector));
+    if (!v) return NULL;
+
+    v->flags = DU_VEC_HEAP_HEADER;
+    v->alloc = alloc;
+    if (!__vecSetup(v, cell_size, capacity_opt, do_clear)) {
+        __duFreeA(alloc, v);
+        return NULL;
+    }
+
+    return v;
+}
+
+Vector *vecNew(uint16_t cell_size, size_t capacity_opt, bool do_clear) {
+    return vecNewWith(NULL, cell_size, capacity_opt, do_clear);
+}
+
+bool vecInit(Vector *vec, uint16_t cell_size, size_t capacity_opt, bool do_clear) {
+    assert(vec && cell_size > 0);
+
+    vec->flags = 0;
+    vec->alloc = duGetAllocator();
+    if (!__vecSetup(vec, cell_size, capacity_opt, do_clear)) {
+        vec->capacity = 0;
+        vec->data = NULL;
+        return false;
+    }
+
+    return true;
+}
+
+void vecFree(Vector *vec, bool purge_data) {
+    if (!vec) return;
+    if (purge_data && vec->data) __vecPurge(vec);
+    if (!__vecIsInline(vec)) __duFreeA(vec->alloc, vec->data);
+
+    if (vec->flags & DU_VEC_HEAP_HEADER) {
+        __duFreeA(vec->alloc, vec);
+        return;
+    }
+
+    vec->data = vec->inline_buf.bytes;
+    vec->capacity = DU_VEC_INLINE_BYTES / vec->cell_size;
+    vec->length = 0;
+}
+
+size_t vecLength(const Vector *vec) {
+    assert(vec);
+    return vec->length;
+}
+
+uint16_t vecCellSize(const Vector *vec) {
+    assert(vec);
+    return vec->cell_size;
+}
+
+size_t vecCapacity(const Vector *vec) {
+    assert(vec);
+    return vec->capacity;
+}
+
+void vecSet(Vector *vec, size_t idx, const void *val) {
+    assert(vec && idx < vec->length);
+    memcpy((char *)vec->data + ((size_t)vec->cell_size * idx), val, vec->cell_size);
+}
+
+void *vecAt(Vector *vec, size_t idx) {
+    assert(vec && idx < vec->length);
+    return (void *)((char *)vec->data + ((size_t)vec->cell_size * idx));
+}
+
+bool vecPush(Vector *vec, const void *val) {
+    assert(vec);
+
+    // Handle resizing
+    if (vec->length == vec->capacity && !__vecGrow(vec, vec->length + 1)) {
+        return false;
+    }
+
+    vec->length++;
+    vecSet(vec, vec->length-1, val);
+    return true;
+}
+
+void *vecPushUninit(Vector *vec, size_t n) {
+    assert(vec);
+    if (n > SIZE_MAX - vec->length || !__vecGrow(vec, vec->length + n)) return NULL;
+
+    void *slot = (char *)vec->data + (size_t)vec->cell_size * vec->length;
+    vec->length += n;
+    return slot;
+}
+
+bool vecExtend(Vector *vec, const void *src, size_t n) {
+    assert(vec && (src || n == 0));
+
+    void *dst = vecPushUninit(vec, n);
+    if (!dst) return false;
+
+    memcpy(dst, src, (size_t)vec->cell_size * n);
+    return true;
+}
+
+bool vecInsertRange(Vector *vec, size_t idx, const void *src, size_t n) {
+    assert(vec && idx <= vec->length && (src || n == 0));
+    if (n > SIZE_MAX - vec->length || !__vecGrow(vec, vec->length + n)) return false;
+
+    size_t cs = vec->cell_size;
+    char *at = (char *)vec->data + cs * idx;
+    memmove(at + cs * n, at, cs * (vec->length - idx));
+    memcpy(at, src, cs * n);
+    vec->length += n;
+
+    return true;
+}
+
+void vecRemoveRange(Vector *vec, size_t idx, size_t n) {
+    assert(vec && idx <= vec->length && n <= vec->length - idx);
+
+    size_t cs = vec->cell_size;
+    char *at = (char *)vec->data + cs * idx;
+    memmove(at, at + cs * n, cs * (vec->length - idx - n));
+    vec->length -= n;
+}
+
+void vecSwapRemove(Vector *vec, size_t idx) {
+    assert(vec && idx < vec->length);
+
+    vec->length--;
+    if (idx != vec->length) {
+        size_t cs = vec->cell_size;
+        memcpy((char *)vec->data + cs * idx, (char *)vec->data + cs * vec->length, cs);
+    }
+}
+
+void *vecPop(Vector *vec) {
+    assert(vec && vec->length > 0);
+
+    void *val = vecAt(vec, vec->length-1);
+    vec->length--;
+
+    return val;
+}
+
+bool vecReserve(Vector *vec, size_t new_capacity, bool do_clear) {
+    assert(vec);
+    if (new_capacity <= vec->capacity) return true;
+
+    size_t old_capacity = vec->capacity;
+    if (!__vecRealloc(vec, new_capacity)) return false;
+    
+    if (do_clear) memset(
+        (char *)vec->data + old_capacity * vec->cell_size,
+        0, (new_capacity - old_capacity) * vec->cell_size
+    );
+    
+    return true;
+}
+
+void vecSort(Vector *vec, int (*cmp)(const void *, const void *)) {
+    assert(vec && cmp);
+    if (vec->length > 1) qsort(vec->data, vec->length, vec->cell_size, cmp);
+}
+
+static int __vecCmpU32(const void *a, const void *b) {
+    uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+static int __vecCmpU64(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+    return (x > y) - (x < y);
+}
+
+/*
+ * LSD radix sort over 8-bit digits. All digit histograms are built in
+ * one read of the input; digits where every key falls in the same
+ * bucket are skipped. 'tmp' must hold 'n' keys. The sorted keys end
+ * up back in 'keys'.
+ */
+#define DU_VEC_RADIX_IMPL(NAME, T)                                            \
+static void NAME(T *keys, T *tmp, size_t n) {                                 \
+    size_t counts[sizeof(T)][256];                                            \
+    memset(counts, 0, sizeof(counts));                                        \
+    for (size_t i = 0; i < n; i++) {                                          \
+        T k = keys[i];                                                        \
+        for (size_t d = 0; d < sizeof(T); d++) counts[d][(k >> (d * 8)) & 0xFF]++; \
+    }                                                                         \
+                                                                              \
+    T *src = keys, *dst = tmp;                                                \
+    for (size_t d = 0; d < sizeof(T); d++) {                                  \
+        size_t *c = counts[d];                                                \
+        if (c[(src[0] >> (d * 8)) & 0xFF] == n) continue;                     \
+                                                                              \
+        size_t sum = 0;                                                       \
+        for (int b = 0; b < 256; b++) {                                       \
+            size_t t = c[b];                                                  \
+            c[b] = sum;                                                       \
+            sum += t;                                                         \
+        }                                                                     \
+        for (size_t i = 0; i < n; i++) {                                      \
+            T k = src[i];                                                     \
+            dst[c[(k >> (d * 8)) & 0xFF]++] = k;                              \
+        }                                                                     \
+                                                                              \
+        T *t = src; src = dst; dst = t;                                       \
+    }                                                                         \
+                                                                              \
+    if (src != keys) memcpy(keys, src, n * sizeof(T));                        \
+}
+
+DU_VEC_RADIX_IMPL(__vecRadixU32, uint32_t)
+DU_VEC_RADIX_IMPL(__vecRadixU64, uint64_t)
+
+#undef DU_VEC_RADIX_IMPL
+
+#ifdef DU_VECTOR_PARALLEL
+
+/*
+ * Parallel sort: the keys are cut into one chunk per thread, each chunk
+ * is radix sorted on its own thread, then neighbouring runs are merged
+ * pairwise (each merge on its own thread) until one run is left.
+ */
+typedef struct {
+    void   *src;     // Input: whole buffer, runs start here
+    void   *dst;     // Output buffer for merges / scratch for chunk sorts
+    size_t  lo;      // First key of the job
+    size_t  mid;     // Split point between the two runs being merged
+    size_t  hi;      // One past the last key of the job
+    int     width;   // 4 or 8 byte keys
+} __VecSortJob;
+
+static void __vecMergeRuns(__VecSortJob *j) {
+    size_t a = j->lo, b = j->mid, o = j->lo;
+    if (j->width == 4) {
+        const uint32_t *s = j->src;
+        uint32_t *d = j->dst;
+        while (a < j->mid && b < j->hi) d[o++] = (s[b] < s[a]) ? s[b++] : s[a++];
+        while (a < j->mid) d[o++] = s[a++];
+        while (b < j->hi) d[o++] = s[b++];
+    } else {
+        const uint64_t *s = j->src;
+        uint64_t *d = j->dst;
+        while (a < j->mid && b < j->hi) d[o++] = (s[b] < s[a]) ? s[b++] : s[a++];
+        while (a < j->mid) d[o++] = s[a++];
+        while (b < j->hi) d[o++] = s[b++];
+    }
+}
+
+static void *__vecSortChunk(void *arg) {
+    __VecSortJob *j = arg;
+    if (j->width == 4) {
+        __vecRadixU32((uint32_t *)j->src + j->lo, (uint32_t *)j->dst + j->lo, j->hi - j->lo);
+    } else {
+        __vecRadixU64((uint64_t *)j->src + j->lo, (uint64_t *)j->dst + j->lo, j->hi - j->lo);
+    }
+    return NULL;
+}
+
+static void *__vecMergeChunk(void *arg) {
+    __vecMergeRuns(arg);
+    return NULL;
+}
+
+#ifdef DU_POOL
+
+typedef struct {
+    __VecSortJob  *jobs;
+    void        *(*fn)(void *);
+} __VecPoolJobs;
+
+static void __vecPoolTask(void *arg, size_t begin, size_t end) {
+    __VecPoolJobs *p = arg;
+    for (size_t i = begin; i < end; i++) p->fn(&p->jobs[i]);
+}
+
+// Runs jobs on the default thread pool instead of fresh threads
+static void __vecRunJobs(__VecSortJob *jobs, size_t n, void *(*fn)(void *)) {
+    __VecPoolJobs p = { jobs, fn };
+    parallelFor(NULL, 0, n, 1, __vecPoolTask, &p);
+}
+
+#else
+
+// Runs jobs on their own threads, falling back to the calling thread
+// for any job whose thread could not be started
+static void __vecRunJobs(__VecSortJob *jobs, size_t n, void *(*fn)(void *)) {
+    pthread_t th[DU_VEC_SORT_THREADS];
+    bool started[DU_VEC_SORT_THREADS];
+
+    for (size_t i = 0; i < n; i++) {
+        started[i] = pthread_create(&th[i], NULL, fn, &jobs[i]) == 0;
+        if (!started[i]) fn(&jobs[i]);
+    }
+    for (size_t i = 0; i < n; i++) {
+        if (started[i]) pthread_join(th[i], NULL);
+    }
+}
+
+#endif // DU_POOL
+
+static void __vecParallelRadix(void *keys, void *tmp, size_t n, int width) {
+    __VecSortJob jobs[DU_VEC_SORT_THREADS];
+    size_t bounds[DU_VEC_SORT_THREADS + 1];
+    size_t runs = DU_VEC_SORT_THREADS;
+
+    for (size_t i = 0; i <= runs; i++) bounds[i] = n * i / runs;
+    for (size_t i = 0; i < runs; i++) {
+        jobs[i] = (__VecSortJob){ keys, tmp, bounds[i], 0, bounds[i + 1], width };
+    }
+    __vecRunJobs(jobs, runs, __vecSortChunk);
+
+    void *src = keys, *dst = tmp;
+    while (runs > 1) {
+        size_t pairs = 0;
+        for (size_t i = 0; i < runs; i += 2) {
+            size_t hi = (i + 2 <= runs) ? bounds[i + 2] : bounds[i + 1];
+            size_t mid = (i + 2 <= runs) ? bounds[i + 1] : hi;
+            jobs[pairs] = (__VecSortJob){ src, dst, bounds[i], mid, hi, width };
+            bounds[pairs++] = bounds[i];
+        }
+        bounds[pairs] = n;
+        __vecRunJobs(jobs, pairs, __vecMergeChunk);
+
+        void *t = src; src = dst; dst = t;
+        runs = pairs;
+    }
+
+    if (src != keys) memcpy(keys, src, n * (size_t)width);
+}
+
+#endif // DU_VECTOR_PARALLEL
+
+static bool __vecRadixSort(Vector *vec, int width) {
+    size_t n = vec->length;
+    if (n < 2) return true;
+
+    void *tmp = __duAllocA(vec->alloc, n * (size_t)width);
+    if (!tmp) {
+        vecSort(vec, width == 4 ? __vecCmpU32 : __vecCmpU64);
+        return false;
+    }
+
+#ifdef DU_VECTOR_PARALLEL
+    if (n >= DU_VEC_PARALLEL_MIN) {
+        __vecParallelRadix(vec->data, tmp, n, width);
+        __duFreeA(vec->alloc, tmp);
+        return true;
+    }
+#endif
+
+    if (width == 4) __vecRadixU32((uint32_t *)vec->data, (uint32_t *)tmp, n);
+    else __vecRadixU64((uint64_t *)vec->data, (uint64_t *)tmp, n);
+
+    __duFreeA(vec->alloc, tmp);
+    return true;
+}
+
+bool vecSortU32(Vector *vec) {
+    assert(vec && vec->cell_size == sizeof(uint32_t));
+    return __vecRadixSort(vec, 4);
+}
+
+bool vecSortU64(Vector *vec) {
+    assert(vec && vec->cell_size == sizeof(uint64_t));
+    return __vecRadixSort(vec, 8);
+}
+
+// Maps doubles to unsigned keys with the same order: flip every bit of
+// negatives, only the sign bit of positives. The mapping is its own
+// inverse once 'to_key' tells which direction to test the sign in.
+static void __vecF64Keys(uint64_t *k, size_t n, bool to_key) {
+    for (size_t i = 0; i < n; i++) {
+        uint64_t neg = to_key ? (k[i] >> 63) : !(k[i] >> 63);
+        k[i] ^= neg ? UINT64_MAX : (1ull << 63);
+    }
+}
+
+bool vecSortF64(Vector *vec) {
+    assert(vec && vec->cell_size == sizeof(double));
+
+    __vecF64Keys((uint64_t *)vec->data, vec->length, true);
+    bool ok = __vecRadixSort(vec, 8);
+    __vecF64Keys((uint64_t *)vec->data, vec->length, false);
+
+    return ok;
+}
+
+size_t vecLowerBound(const Vector *vec, const void *key, int (*cmp)(const void *, const void *)) {
+    assert(vec && key && cmp);
+
+    size_t lo = 0, hi = vec->length;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (cmp((const char *)vec->data + (size_t)vec->cell_size * mid, key) < 0) lo = mid + 1;
+        else hi = mid;
+    }
+
+    return lo;
+}
+
+void *vecBinarySearch(Vector *vec, const void *key, int (*cmp)(const void *, const void *)) {
+    size_t idx = vecLowerBound(vec, key, cmp);
+    if (idx == vec->length) return NULL;
+
+    void *cell = vecAt(vec, idx);
+    return cmp(cell, key) == 0 ? cell : NULL;
+}
+
+#endif // DU_VECTOR
+
+
+#ifdef DU_DICT
+
+#define DU_DICT_CTRL_EMPTY   0x80
+#define DU_DICT_CTRL_DELETED 0xFE
+#define DU_DICT_MIN_SIZE        8
+
+// Dictionary keys use the wyhash core above with the process seed fed
+// into every step, so a collision found for one seed is no use against
+// another.
+static inline uint64_t __dictHashBytes(uint64_t seed, const void *key, size_t key_len) {
+    return __duWyhash(key, key_len, seed, __du_wy_secret);
+}
+
+// Reads the seed from the OS. Where /dev/urandom is unavailable (non-POSIX
+// systems, chroots without /dev) it falls back to mixing the clock with
+// heap and stack addresses, which is far easier to predict.
+static uint64_t __dictNewSeed(const void *owner) {
+#if defined(__unix__) || defined(__APPLE__)
+    FILE *f = fopen("/dev/urandom", "rb");
+    if (f) {
+        uint64_t seed = 0;
+        size_t got = fread(&seed, sizeof(seed), 1, f);
+        fclose(f);
+        if (got == 1) return seed;
+    }
+#endif
+
+    uint64_t t = (uint64_t)time(NULL);
+    uint64_t c = (uint64_t)clock();
+    uint64_t addr = (uint64_t)(uintptr_t)owner;
+    uint64_t stack = (uint64_t)(uintptr_t)&t;
+    return __duMix(addr ^ t ^ __du_wy_secret[0], stack ^ c ^ __du_wy_secret[3]);
+}
+
+// One seed for every dictionary, so dictHash results can be shared
+// between them. Created by the first dictNew; a thread that loses the
+// race adopts the winner's seed. Never 0, which marks "not yet chosen".
+static uint64_t __dict_seed = 0;
+
+static uint64_t __dictSeed(void) {
+#if defined(__GNUC__)
+    uint64_t seed = __atomic_load_n(&__dict_seed, __ATOMIC_ACQUIRE);
+    if (seed) return seed;
+
+    uint64_t expected = 0;
+    seed = __dictNewSeed(&expected) | 1;
+    if (!__atomic_compare_exchange_n(&__dict_seed, &expected, seed, false,
+                                     __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+        seed = expected;
+    }
+    return seed;
+#else
+    if (!__dict_seed) __dict_seed = __dictNewSeed(&__dict_seed) | 1;
+    return __dict_seed;
+#endif
+}
+
+// The low 7 bits of the hash are kept in the control byte, the bits
+// above them select the home slot.
+static inline uint8_t __dictCtrlOf(uint64_t hash) {
+    return (uint8_t)(hash & 0x7F);
+}
+
+static inline uint32_t __dictHomeOf(uint64_t hash, uint32_t mask) {
+    return (uint32_t)(hash >> 7) & mask;
+}
+
+static bool __dictIsKeyEqual(const void *k1, size_t l1, const void *k2, size_t l2) {
+    if (l1 != l2) return false;
+    return (memcmp(k1, k2, l1) == 0);
+}
+
+static uint32_t __dictRoundSize(uint32_t size) {
+    uint32_t n = DU_DICT_MIN_SIZE;
+    while (n < size && n < (1u << 31)) n <<= 1;
+    return n;
+}
+
+static inline bool __dictIsFull(uint8_t c) {
+    return c < DU_DICT_CTRL_EMPTY;
+}
+
+#ifdef DU_STATS
+// Records one probe of 'n' slots in a DictCounters
+static inline void __dictCountProbe(void *st, uint32_t n) {
+    DictCounters *c = st;
+    if (!c) return;
+    c->lookups++;
+    c->probes += n;
+    c->probe_hist[__duStatsBucket(n)]++;
+}
+#endif // DU_STATS
+
+// Probes one table for 'key'. Returns the slot holding it and sets
+// 'found', or returns the slot where it should be inserted: the first
+// tombstone on the probe path, else the empty slot that ended it.
+// Tables are never full, so the probe always terminates.
+// Only entries whose full hash matches reach the memcmp.
+// With DU_STATS the probe is recorded in 'st' (NULL to skip).
+static uint32_t __dictProbe(const uint8_t *ctrl, const DictEntry *entries, uint32_t size,
+                            const void *key, size_t key_len,
+                            uint64_t hash, bool *found, void *st) {
+    uint32_t mask = size - 1;
+    uint8_t  tag  = __dictCtrlOf(hash);
+    uint32_t idx  = __dictHomeOf(hash, mask);
+    uint32_t slot = UINT32_MAX;
+    __DU_STAT(uint32_t home = idx);
+    (void)st;
+
+    while (ctrl[idx] != DU_DICT_CTRL_EMPTY) {
+        if (ctrl[idx] == tag) {
+            const DictEntry *e = &entries[idx];
+            if (e->hash == hash
+                    && __dictIsKeyEqual(e->key, e->key_len, key, key_len)) {
+                *found = true;
+                __DU_STAT(__dictCountProbe(st, ((idx - home) & mask) + 1));
+                return idx;
+            }
+        } else if (ctrl[idx] == DU_DICT_CTRL_DELETED && slot == UINT32_MAX) {
+            slot = idx;
+        }
+        idx = (idx + 1) & mask;
+    }
+
+    *found = false;
+    __DU_STAT(__dictCountProbe(st, ((idx - home) & mask) + 1));
+    return slot == UINT32_MAX ? idx : slot;
+}
+
+#ifdef DU_STATS
+#define __DICT_STATS(dict) (&(dict)->stats)
+#else
+#define __DICT_STATS(dict) NULL
+#endif
+
+// Looks a key up in both tables, returning its entry or NULL.
+// 'in_old' tells whether the entry still sits in the table being drained.
+static DictEntry *__dictLookup(Dictionary *dict, const void *key, size_t key_len,
+                               uint64_t hash, uint32_t *slot, bool *in_old) {
+    bool found;
+
+    *in_old = false;
+    *slot = __dictProbe(dict->ctrl, dict->entries, dict->size,
+                        key, key_len, hash, &found, __DICT_STATS(dict));
+    if (found) return &dict->entries[*slot];
+
+    if (dict->old_ctrl) {
+        uint32_t old_slot = __dictProbe(dict->old_ctrl, dict->old_entries, dict->old_size,
+                                        key, key_len, hash, &found, __DICT_STATS(dict));
+        if (found) {
+            *in_old = true;
+            *slot = old_slot;
+            return &dict->old_entries[old_slot];
+        }
+    }
+
+    return NULL;
+}
+
+static bool __dictAllocTable(const DuAllocator *a, DictEntry **entries, uint8_t **ctrl, uint32_t size) {
+    *entries = (DictEntry *)__duAllocA(a, size * sizeof(DictEntry));
+    *ctrl = (uint8_t *)__duAllocA(a, size);
+    if (!*entries || !*ctrl) {
+        __duFreeA(a, *entries);
+        __duFreeA(a, *ctrl);
+        return false;
+    }
+
+    memset(*ctrl, DU_DICT_CTRL_EMPTY, size);
+    return true;
+}
+
+static void __dictDropOldTable(Dictionary *dict) {
+    __duFreeA(dict->alloc, dict->old_entries);
+    __duFreeA(dict->alloc, dict->old_ctrl);
+    dict->old_entries = NULL;
+    dict->old_ctrl = NULL;
+    dict->old_size = 0;
+    dict->rehash_idx = 0;
+}
+
+// Moves up to 'n' slots of the old table into the current one.
+// The stored hash is reused, the key bytes are never touched.
+static void __dictRehashStep(Dictionary *dict, uint32_t n) {
+    if (!dict->old_ctrl) return;
+
+    uint32_t mask = dict->size - 1;
+    while (n-- > 0 && dict->rehash_idx < dict->old_size) {
+        uint32_t i = dict->rehash_idx++;
+        if (!__dictIsFull(dict->old_ctrl[i])) continue;
+
+        DictEntry *e = &dict->old_entries[i];
+        uint32_t idx = __dictHomeOf(e->hash, mask);
+        while (__dictIsFull(dict->ctrl[idx])) idx = (idx + 1) & mask;
+
+        if (dict->ctrl[idx] == DU_DICT_CTRL_EMPTY) dict->used++;
+        dict->ctrl[idx] = dict->old_ctrl[i];
+        dict->entries[idx] = *e;
+        dict->old_ctrl[i] = DU_DICT_CTRL_DELETED;
+    }
+
+    if (dict->rehash_idx == dict->old_size) __dictDropOldTable(dict);
+}
+
+// Swaps in a fresh table of 'new_size' slots and starts draining the
+// current one into it. Any rehash already in progress is finished first;
+// dictSet never gets here with one pending (a drain of old_size slots at
+// DU_DICT_REHASH_STEP per insert ends long before the new table, at most
+// half full when it starts, reaches the load factor), so that full drain
+// is only reachable from dictReserve.
+static bool __dictStartRehash(Dictionary *dict, uint32_t new_size) {
+    if (dict->old_ctrl) __dictRehashStep(dict, UINT32_MAX);
+
+    DictEntry *entries;
+    uint8_t *ctrl;
+    if (!__dictAllocTable(dict->alloc, &entries, &ctrl, new_size)) return false;
+
+    if (new_size > dict->size) {
+        __DU_STAT(dict->stats.grows++);
+        __DU_STAT_ADD(dict_grows, 1);
+    } else {
+        __DU_STAT(dict->stats.purges++);
+        __DU_STAT_ADD(dict_purges, 1);
+    }
+
+    dict->old_entries = dict->entries;
+    dict->old_ctrl = dict->ctrl;
+    dict->old_size = dict->size;
+    dict->rehash_idx = 0;
+
+    dict->entries = entries;
+    dict->ctrl = ctrl;
+    dict->size = new_size;
+    dict->used = 0;
+
+    if (dict->count == 0) __dictRehashStep(dict, UINT32_MAX);
+    return true;
+}
+
+static inline bool __dictOverLoad(uint64_t used, uint64_t size) {
+    return used * DU_DICT_LOAD_DEN > size * DU_DICT_LOAD_NUM;
+}
+
+// Copies a key into the arena, starting a new block when the current one is full
+static void *__dictCopyKey(Dictionary *dict, const void *key, size_t key_len) {
+    size_t need = (key_len + 7) & ~(size_t)7;
+    DictBlock *b = dict->blocks;
+
+    if (!b || b->cap - b->used < need) {
+        size_t cap = need > DU_DICT_BLOCK_SIZE ? need : DU_DICT_BLOCK_SIZE;
+        b = (DictBlock *)__duAllocA(dict->alloc, sizeof(DictBlock) + cap);
+        if (!b) return NULL;
+        b->cap = cap;
+        b->used = 0;
+        b->next = dict->blocks;
+        dict->blocks = b;
+    }
+
+    void *dst = (char *)(b + 1) + b->used;
+    b->used += need;
+    memcpy(dst, key, key_len);
+    return dst;
+}
+
+static void __dictFreeBlocks(const DuAllocator *a, DictBlock *b) {
+    while (b) {
+        DictBlock *next = b->next;
+        __duFreeA(a, b);
+        b = next;
+    }
+}
+
+static void __dictReleaseEntry(Dictionary *dict, DictEntry *e) {
+    if (dict->free_key && !(dict->flags & DU_DICT_COPY_KEYS)) dict->free_key(e->key);
+    if (dict->free_val) dict->free_val(e->val);
+}
+
+// Calls the free callbacks on every entry, copied keys are left to their blocks
+static void __dictReleaseEntries(Dictionary *dict) {
+    if ((!dict->free_key || (dict->flags & DU_DICT_COPY_KEYS)) && !dict->free_val) return;
+
+    for (uint32_t i = 0; i < dict->size; i++) {
+        if (__dictIsFull(dict->ctrl[i])) __dictReleaseEntry(dict, &dict->entries[i]);
+    }
+
+    for (uint32_t i = 0; dict->old_ctrl && i < dict->old_size; i++) {
+        if (__dictIsFull(dict->old_ctrl[i])) __dictReleaseEntry(dict, &dict->old_entries[i]);
+    }
+}
+
+Dictionary *dictNew(uint32_t size, void (*free_key)(void *), void (*free_val)(void *)) {
+    return dictNewEx(size, 0, free_key, free_val);
+}
+
+Dictionary *dictNewEx(uint32_t size, uint32_t flags,
+                      void (*free_key)(void *), void (*free_val)(void *)) {
+    return dictNewWith(NULL, size, flags, free_key, free_val);
+}
+
+Dictionary *dictNewWith(const DuAllocator *alloc, uint32_t size, uint32_t flags,
+                        void (*free_key)(void *), void (*free_val)(void *)) {
+    if (!alloc) alloc = duGetAllocator();
+
+    Dictionary *d = (Dictionary *)__duAllocA(alloc, sizeof(Dictionary));
+    if (!d) return NULL;
+
+    d->size = __dictRoundSize(size);
+    d->count = 0;
+    d->used = 0;
+    d->old_entries = NULL;
+    d->old_ctrl = NULL;
+    d->old_size = 0;
+    d->rehash_idx = 0;
+    d->seed = __dictSeed();
+    d->flags = flags;
+    d->blocks = NULL;
+    d->alloc = alloc;
+    d->free_key = free_key;
+    d->free_val = free_val;
+#ifdef DU_STATS
+    memset(&d->stats, 0, sizeof(d->stats));
+    d->stats.initial_size = d->size;
+#endif
+
+    if (!__dictAllocTable(alloc, &d->entries, &d->ctrl, d->size)) {
+        __duFreeA(alloc, d);
+        return NULL;
+    }
+
+    return d;
+}
+
+uint64_t dictHash(const Dictionary *dict, const void *key, size_t key_len) {
+    assert(dict && key);
+    return __dictHashBytes(dict->seed, key, key_len);
+}
+
+void dictSet(Dictionary *dict, void *key, size_t key_len, void *val) {
+    if (!dict || !key) return;
+    dictSetHashed(dict, key, key_len, __dictHashBytes(dict->seed, key, key_len), val);
+}
+
+void dictSetHashed(Dictionary *dict, void *key, size_t key_len, uint64_t hash, void *val) {
+    if (!dict || !key) return;
+#ifdef DU_DICT_CHECK_HASH
+    assert(hash == __dictHashBytes(dict->seed, key, key_len));
+#endif
+
+    __dictRehashStep(dict, DU_DICT_REHASH_STEP);
+
+    uint32_t idx;
+    bool in_old;
+    DictEntry *e = __dictLookup(dict, key, key_len, hash, &idx, &in_old);
+    if (e) {
+        if (dict->free_val) dict->free_val(e->val);
+        e->val = val;
+        return;
+    }
+
+    // Filling an empty slot may push us past the load factor; tombstones
+    // count too. Grow if live entries need the room, otherwise rebuild at
+    // the same size to purge tombstones. If that fails we can still insert
+    // as long as one slot stays empty.
+    bool fills_empty = dict->ctrl[idx] == DU_DICT_CTRL_EMPTY;
+    if (fills_empty && __dictOverLoad((uint64_t)dict->used + 1, dict->size)) {
+        uint32_t new_size = dict->size;
+        if (__dictOverLoad(((uint64_t)dict->count + 1) * 2, dict->size) && new_size < (1u << 31)) {
+            new_size *= 2;
+        }
+
+        if (__dictStartRehash(dict, new_size)) {
+            // The key is in neither table, so only the insert slot moves
+            bool found;
+            idx = __dictProbe(dict->ctrl, dict->entries, dict->size,
+                              key, key_len, hash, &found, NULL);
+            fills_empty = dict->ctrl[idx] == DU_DICT_CTRL_EMPTY;
+        } else if (dict->used + 1 >= dict->size) {
+            return;
+        }
+    }
+
+    if (dict->flags & DU_DICT_COPY_KEYS) {
+        key = __dictCopyKey(dict, key, key_len);
+        if (!key) return;
+    }
+
+    dict->ctrl[idx] = __dictCtrlOf(hash);
+    __DU_STAT(dict->stats.inserts++);
+    __DU_STAT(if (idx != __dictHomeOf(hash, dict->size - 1)) dict->stats.collisions++);
+    dict->entries[idx].key = key;
+    dict->entries[idx].key_len = key_len;
+    dict->entries[idx].hash = hash;
+    dict->entries[idx].val = val;
+    dict->count++;
+    if (fills_empty) dict->used++;
+}
+
+void *dictGet(Dictionary *dict, void *key, size_t key_len) {
+    if (!dict || !key) return NULL;
+    return dictGetHashed(dict, key, key_len, __dictHashBytes(dict->seed, key, key_len));
+}
+
+void *dictGetHashed(Dictionary *dict, void *key, size_t key_len, uint64_t hash) {
+    if (!dict || !key) return NULL;
+#ifdef DU_DICT_CHECK_HASH
+    assert(hash == __dictHashBytes(dict->seed, key, key_len));
+#endif
+
+    uint32_t idx;
+    bool in_old;
+    DictEntry *e = __dictLookup(dict, key, key_len, hash, &idx, &in_old);
+
+    return e ? e->val : NULL;
+}
+
+bool dictRemove(Dictionary *dict, void *key, size_t key_len) {
+    if (!dict || !key) return false;
+
+    uint32_t idx;
+    bool in_old;
+    DictEntry *e = __dictLookup(dict, key, key_len, __dictHashBytes(dict->seed, key, key_len), &idx, &in_old);
+    if (!e) return false;
+
+    __dictReleaseEntry(dict, e);
+    if (in_old) dict->old_ctrl[idx] = DU_DICT_CTRL_DELETED;
+    else dict->ctrl[idx] = DU_DICT_CTRL_DELETED;
+    dict->count--;
+
+    return true;
+}
+
+uint32_t dictCount(const Dictionary *dict) {
+    assert(dict);
+    return dict->count;
+}
+
+bool dictReserve(Dictionary *dict, uint32_t n) {
+    assert(dict);
+
+    uint64_t need = (uint64_t)n * DU_DICT_LOAD_DEN / DU_DICT_LOAD_NUM + 1;
+    uint32_t new_size = __dictRoundSize(need > (1u << 31) ? (1u << 31) : (uint32_t)need);
+    if (new_size <= dict->size) return true;
+
+    return __dictStartRehash(dict, new_size);
+}
+
+DictEntry *dictNext(Dictionary *dict, size_t *cursor) {
+    assert(dict && cursor);
+
+    // The cursor walks the table being drained first, then the current one
+    size_t old_size = dict->old_ctrl ? dict->old_size : 0;
+    while (*cursor < old_size) {
+        size_t i = (*cursor)++;
+        if (__dictIsFull(dict->old_ctrl[i])) return &dict->old_entries[i];
+    }
+
+    while (*cursor < old_size + dict->size) {
+        size_t i = (*cursor)++ - old_size;
+        if (__dictIsFull(dict->ctrl[i])) return &dict->entries[i];
+    }
+
+    return NULL;
+}
+
+void dictClear(Dictionary *dict) {
+    if (!dict) return;
+
+    __dictReleaseEntries(dict);
+    __dictDropOldTable(dict);
+    memset(dict->ctrl, DU_DICT_CTRL_EMPTY, dict->size);
+    dict->count = 0;
+    dict->used = 0;
+
+    // Keep the newest block for reuse, drop the rest
+    if (dict->blocks) {
+        __dictFreeBlocks(dict->alloc, dict->blocks->next);
+        dict->blocks->next = NULL;
+        dict->blocks->used = 0;
+    }
+}
+
+void dictFree(Dictionary *dict) {
+    if (!dict) return;
+
+    __dictReleaseEntries(dict);
+    __dictDropOldTable(dict);
+    __dictFreeBlocks(dict->alloc, dict->blocks);
+    __duFreeA(dict->alloc, dict->entries);
+    __duFreeA(dict->alloc, dict->ctrl);
+    __duFreeA(dict->alloc, dict);
+}
+
+#ifdef DU_ARENA
+
+Dictionary *dictNewA(Arena *arena, uint32_t size, uint32_t flags) {
+    assert(arena);
+    return dictNewWith(arenaAllocator(arena), size, flags | DU_DICT_COPY_KEYS, NULL, NULL);
+}
+
+#endif // DU_ARENA
+
+#ifdef DU_STATS
+
+// Adds the chain length of every stored key in one table to 'out'
+static void __dictScanChains(const uint8_t *ctrl, const DictEntry *entries,
+                             uint32_t size, DictStats *out, uint64_t *total) {
+    uint32_t mask = size - 1;
+    for (uint32_t i = 0; i < size; i++) {
+        if (!__dictIsFull(ctrl[i])) continue;
+
+        uint32_t home = __dictHomeOf(entries[i].hash, mask);
+        uint32_t n = ((i - home) & mask) + 1;
+        if (n > out->max_chain) out->max_chain = n;
+        out->chain_hist[__duStatsBucket(n)]++;
+        *total += n;
+    }
+}
+
+void dictStats(const Dictionary *dict, DictStats *out) {
+    assert(dict && out);
+    memset(out, 0, sizeof(*out));
+
+    out->count = dict->count;
+    out->size = dict->size;
+    out->old_size = dict->old_ctrl ? dict->old_size : 0;
+    out->counters = dict->stats;
+
+    for (uint32_t i = 0; i < dict->size; i++) {
+        out->tombstones += dict->ctrl[i] == DU_DICT_CTRL_DELETED;
+    }
+    out->load = (double)dict->used / dict->size;
+
+    uint64_t total = 0;
+    __dictScanChains(dict->ctrl, dict->entries, dict->size, out, &total);
+    if (dict->old_ctrl) {
+        __dictScanChains(dict->old_ctrl, dict->old_entries, dict->old_size, out, &total);
+    }
+    out->avg_chain = dict->count ? (double)total / dict->count : 0;
+}
+
+void dictStatsReset(Dictionary *dict) {
+    assert(dict);
+    uint32_t initial = dict->stats.initial_size;
+    memset(&dict->stats, 0, sizeof(dict->stats));
+    dict->stats.initial_size = initial;
+}
+
+#endif // DU_STATS
+
+#ifdef DU_DICT_CONCURRENT
+
+ConcurrentDictionary *cdictNew(uint32_t nshards, uint32_t size,
+                               void (*free_key)(void *), void (*free_val)(void *)) {
+    if (nshards == 0) nshards = DU_CDICT_SHARDS;
+
+    uint32_t bits = 0;
+    while ((1u << bits) < nshards && bits < 16) bits++;
+
+    ConcurrentDictionary *cd = (ConcurrentDictionary *)duMalloc(sizeof(ConcurrentDictionary));
+    if (!cd) return NULL;
+
+    cd->seed = __dictSeed();
+    cd->nshards = 1u << bits;
+    cd->shift = 64 - bits;
+
+    // Over-allocated by a line so the shards can start on a line boundary
+    void *mem = duMalloc(cd->nshards * sizeof(ConcurrentDictShard) + DU_CACHE_LINE);
+    if (!mem) {
+        duFree(cd);
+        return NULL;
+    }
+    cd->shards_mem = mem;
+    cd->shards = (ConcurrentDictShard *)(((uintptr_t)mem + DU_CACHE_LINE - 1)
+                                         & ~(uintptr_t)(DU_CACHE_LINE - 1));
+
+    for (uint32_t i = 0; i < cd->nshards; i++) {
+        ConcurrentDictShard *sh = &cd->shards[i];
+        sh->dict = dictNew(size, free_key, free_val);
+        if (!sh->dict || pthread_rwlock_init(&sh->lock, NULL) != 0) {
+            dictFree(sh->dict);
+            for (uint32_t j = 0; j < i; j++) {
+                pthread_rwlock_destroy(&cd->shards[j].lock);
+                dictFree(cd->shards[j].dict);
+            }
+            duFree(cd->shards_mem);
+            duFree(cd);
+            return NULL;
+        }
+    }
+
+    return cd;
+}
+
+// A single shard has no hash bits to spare, shifting by 64 would be undefined
+static inline ConcurrentDictShard *__cdictShardOf(ConcurrentDictionary *cdict, uint64_t hash) {
+    if (cdict->nshards == 1) return cdict->shards;
+    return &cdict->shards[hash >> cdict->shift];
+}
+
+void cdictSet(ConcurrentDictionary *cdict, void *key, size_t key_len, void *val) {
+    if (!cdict || !key) return;
+
+    uint64_t hash = __dictHashBytes(cdict->seed, key, key_len);
+    ConcurrentDictShard *sh = __cdictShardOf(cdict, hash);
+
+    pthread_rwlock_wrlock(&sh->lock);
+    dictSetHashed(sh->dict, key, key_len, hash, val);
+    pthread_rwlock_unlock(&sh->lock);
+}
+
+void *cdictGet(ConcurrentDictionary *cdict, void *key, size_t key_len) {
+    if (!cdict || !key) return NULL;
+
+    uint64_t hash = __dictHashBytes(cdict->seed, key, key_len);
+    ConcurrentDictShard *sh = __cdictShardOf(cdict, hash);
+
+    pthread_rwlock_rdlock(&sh->lock);
+    void *val = dictGetHashed(sh->dict, key, key_len, hash);
+    pthread_rwlock_unlock(&sh->lock);
+
+    return val;
+}
+
+void cdictFree(ConcurrentDictionary *cdict) {
+    if (!cdict) return;
+
+    for (uint32_t i = 0; i < cdict->nshards; i++) {
+        pthread_rwlock_destroy(&cdict->shards[i].lock);
+        dictFree(cdict->shards[i].dict);
+    }
+
+    duFree(cdict->shards_mem);
+    duFree(cdict);
+}
+
+#endif // DU_DICT_CONCURRENT
+
+#endif // DU_DICT
+
+
+#ifdef DU_ARGS
+
+#include <limits.h>
+#if defined(__unix__) || defined(__APPLE__)
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+// Kinds of names in the long-name table
+#define __ARG_LONG 1  // Alias matched after "--"
+#define __ARG_BARE 2  // Whole l_rep matched as a bare word
+
+typedef struct {
+    const char *name;  // Points into the spec's l_rep, not NUL-terminated
+    size_t      len;
+    uint32_t    hash;
+    int32_t     spec;  // Index into the specs, -1 for an empty slot
+    uint8_t     kind;  // __ARG_LONG or __ARG_BARE
+} __ArgName;
+
+// Response file contents, tokenized in place
+typedef struct {
+    char   *data;
+    size_t  len;     // Bytes to unmap or free
+    bool    mapped;  // data is an mmap rather than malloc
+} __ArgFile;
+
+struct arg_parser_s {
+    ArgSpec   *specs;
+    int32_t    count;       // Number of specs before ARG_END
+    int32_t    shorts[256]; // Spec index per short option character, -1 if none
+    __ArgName *names;       // Long-name table, power-of-two sized
+    size_t     mask;        // Table size - 1
+    bool      *found;       // Per spec, set while parsing
+    char     **args;        // argv with response files expanded
+    size_t     nargs;
+    size_t     args_cap;
+    __ArgFile *files;       // Response files backing strings in 'args'
+    size_t     nfiles;
+};
+
+// FNV-1a; option names are short, so a heavier hash would not pay off
+static uint32_t __argHash(const char *s, size_t len) {
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < len; i++) h = (h ^ (uint8_t)s[i]) * 16777619u;
+    return h;
+}
+
+static int32_t __argFindName(const ArgParser *p, const char *name, size_t len, uint8_t kind) {
+    uint32_t h = __argHash(name, len);
+    for (size_t i = h & p->mask; p->names[i].spec >= 0; i = (i + 1) & p->mask) {
+        const __ArgName *n = &p->names[i];
+        if (n->hash == h && n->kind == kind && n->len == len && memcmp(n->name, name, len) == 0) {
+            return n->spec;
+        }
+    }
+    return -1;
+}
+
+static void __argAddName(ArgParser *p, const char *name, size_t len, uint8_t kind, int32_t spec) {
+    if (len == 0 || __argFindName(p, name, len, kind) >= 0) return;
+
+    uint32_t h = __argHash(name, len);
+    size_t i = h & p->mask;
+    while (p->names[i].spec >= 0) i = (i + 1) & p->mask;
+    p->names[i] = (__ArgName){ name, len, h, spec, kind };
+}
+
+ArgParser *argParserNew(ArgSpec *ctx) {
+    assert(ctx);
+
+    ArgParser *p = (ArgParser *)duCalloc(1, sizeof(ArgParser));
+    if (!p) return NULL;
+    p->specs = ctx;
+
+    // One slot per alias plus one per bare l_rep, kept at most half full
+    size_t names = 0;
+    for (ArgSpec *spec = ctx; spec->type != DU_ARG_END; spec++, p->count++) {
+        if (!spec->l_rep) continue;
+        names += 2;
+        for (const char *c = spec->l_rep; *c; c++) names += *c == ',';
+    }
+    size_t size = 16;
+    while (size < names * 2) size *= 2;
+
+    p->names = (__ArgName *)duMalloc(size * sizeof(__ArgName));
+    p->found = (bool *)duCalloc(p->count ? (size_t)p->count : 1, sizeof(bool));
+    if (!p->names || !p->found) {
+        argParserFree(p);
+        return NULL;
+    }
+    p->mask = size - 1;
+    for (size_t i = 0; i < size; i++) p->names[i].spec = -1;
+    for (size_t i = 0; i < 256; i++) p->shorts[i] = -1;
+
+    for (int32_t idx = 0; idx < p->count; idx++) {
+        const ArgSpec *spec = &ctx[idx];
+
+        if (spec->s_rep) {
+            for (const char *c = spec->s_rep; *c; c++) {
+                if (p->shorts[(uint8_t)*c] < 0) p->shorts[(uint8_t)*c] = idx;
+            }
+        }
+
+        if (spec->l_rep) {
+            const char *alias = spec->l_rep;
+            while (alias) {
+                const char *next = strchr(alias, ',');
+                size_t len = next ? (size_t)(next - alias) : strlen(alias);
+                __argAddName(p, alias, len, __ARG_LONG, idx);
+                alias = next ? next + 1 : NULL;
+            }
+            __argAddName(p, spec->l_rep, strlen(spec->l_rep), __ARG_BARE, idx);
+        }
+    }
+
+    return p;
+}
+
+void argParserFree(ArgParser *parser) {
+    if (!parser) return;
+    for (size_t i = 0; i < parser->nfiles; i++) {
+        __ArgFile *f = &parser->files[i];
+#if defined(__unix__) || defined(__APPLE__)
+        if (f->mapped) {
+            munmap(f->data, f->len);
+            continue;
+        }
+#endif
+        duFree(f->data);
+    }
+    duFree(parser->files);
+    duFree(parser->args);
+    duFree(parser->names);
+    duFree(parser->found);
+    duFree(parser);
+}
+
+#ifdef DU_VECTOR
+
+static bool __argPushArg(ArgParser *p, char *arg) {
+    if (p->nargs == p->args_cap) {
+        size_t cap = p->args_cap ? p->args_cap * 2 : 64;
+        char **grown = (char **)duRealloc(p->args, cap * sizeof(char *));
+        if (!grown) return false;
+        p->args = grown;
+        p->args_cap = cap;
+    }
+    p->args[p->nargs++] = arg;
+    return true;
+}
+
+// Reads a whole file into a NUL-terminated writable buffer. Regular files
+// are mapped copy-on-write; the bytes after EOF up to the page end read as
+// zero, which terminates the last token, unless the file fills its last
+// page exactly.
+static bool __argLoadFile(const char *path, __ArgFile *out) {
+#if defined(__unix__) || defined(__APPLE__)
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat st;
+    long page = sysconf(_SC_PAGESIZE);
+    if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0
+            && (uint64_t)st.st_size < SIZE_MAX && page > 0 && st.st_size % page != 0) {
+        size_t size = (size_t)st.st_size;
+        void *map = mmap(NULL, size + 1, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+        if (map != MAP_FAILED) {
+            close(fd);
+            *out = (__ArgFile){ map, size + 1, true };
+            return true;
+        }
+    }
+
+    // Pipes, page-sized files, or a failed mmap
+    size_t len = 0, cap = 4096;
+    char *buf = (char *)duMalloc(cap);
+    while (buf) {
+        if (cap - len < 2) {
+            char *grown = (char *)duRealloc(buf, cap * 2);
+            if (!grown) break;
+            buf = grown;
+            cap *= 2;
+        }
+        ssize_t n = read(fd, buf + len, cap - len - 1);
+        if (n > 0) len += (size_t)n;
+        else if (n == 0) {
+            close(fd);
+            buf[len] = '\0';
+            *out = (__ArgFile){ buf, len, false };
+            return true;
+        } else if (errno != EINTR) break;
+    }
+    duFree(buf);
+    close(fd);
+    return false;
+#else
+    FILE *f = fopen(path, "rb");
+    if (!f) return false;
+
+    size_t len = 0, cap = 4096;
+    char *buf = (char *)duMalloc(cap);
+    while (buf) {
+        if (cap - len < 2) {
+            char *grown = (char *)duRealloc(buf, cap * 2);
+            if (!grown) break;
+            buf = grown;
+            cap *= 2;
+        }
+        size_t n = fread(buf + len, 1, cap - len - 1, f);
+        len += n;
+        if (n == 0) {
+            if (ferror(f)) break;
+            fclose(f);
+            buf[len] = '\0';
+            *out = (__ArgFile){ buf, len, false };
+            return true;
+        }
+    }
+    duFree(buf);
+    fclose(f);
+    return false;
+#endif
+}
+
+// Splits a response file into arguments in place. Unquoting and escapes
+// only ever shorten a token, so each one is rewritten over its own bytes
+// and NUL-terminated no later than where its separator was.
+static bool __argTokenize(ArgParser *p, char *s) {
+    for (;;) {
+        while (*s && isspace((unsigned char)*s)) s++;
+        if (!*s) return true;
+
+        char *tok = s, *w = s;
+        char quote = 0;
+        while (*s && (quote || !isspace((unsigned char)*s))) {
+            char c = *s++;
+            if (quote == c) quote = 0;
+            else if (!quote && (c == '\'' || c == '"')) quote = c;
+            else if (c == '\\' && quote != '\'' && *s) *w++ = *s++;
+            else *w++ = c;
+        }
+
+        bool last = *s == '\0';
+        *w = '\0';
+        if (!__argPushArg(p, tok)) return false;
+        if (last) return true;
+        s++;
+    }
+}
+
+// Builds p->args from argv with every "@path" replaced by the file's tokens
+static bool __argExpand(ArgParser *p, int argc, char **argv) {
+    bool literal = false;  // Set by "--": later arguments are positionals as given
+    p->nargs = 0;
+    for (int i = 0; i < argc; i++) {
+        char *arg = argv[i];
+        if (i == 0 || literal || !arg || arg[0] != '@' || arg[1] == '\0') {
+            if (!__argPushArg(p, arg)) return false;
+            if (i > 0 && arg && strcmp(arg, "--") == 0) literal = true;
+            continue;
+        }
+
+        if (p->nfiles % 8 == 0) {
+            __ArgFile *grown = (__ArgFile *)duRealloc(p->files, (p->nfiles + 8) * sizeof(__ArgFile));
+            if (!grown) return false;
+            p->files = grown;
+        }
+
+        __ArgFile *f = &p->files[p->nfiles];
+        if (!__argLoadFile(arg + 1, f)) {
+            fprintf(stderr, "Error: cannot read response file %s\n", arg + 1);
+            return false;
+        }
+        p->nfiles++;
+
+        size_t first = p->nargs;
+        if (!__argTokenize(p, f->data)) return false;
+        for (size_t j = first; j < p->nargs && !literal; j++) {
+            literal = strcmp(p->args[j], "--") == 0;
+        }
+    }
+    return p->nargs <= INT_MAX;
+}
+
+#endif // DU_VECTOR
+
+// Appends a positional argument when collecting them
+static bool __argPositional(void *positional, char *argument) {
+#ifdef DU_VECTOR
+    if (positional && !vecPush((Vector *)positional, &argument)) {
+        fprintf(stderr, "Error: out of memory collecting arguments\n");
+        return false;
+    }
+#else
+    (void)positional;
+    (void)argument;
+#endif
+    return true;
+}
+
+// Stores one option. 'value' is its inline value (after '=' or the rest of
+// a short group) or NULL to take the next argument. 'shown' names the
+// option in error messages.
+static bool __argApply(ArgParser *p, int32_t idx, const char *value,
+                       const char *shown, int *i, int argc, char **argv) {
+    ArgSpec *spec = &p->specs[idx];
+    p->found[idx] = true;
+
+    if (spec->type == DU_ARG_BOL) {
+        if (spec->out) *(bool *)spec->out = true;
+        return true;
+    }
+    if (!spec->out) return true;
+
+    if (!value) {
+        if (*i + 1 >= argc) {
+            const char *what = spec->type == DU_ARG_INT ? "integer"
+                             : spec->type == DU_ARG_DBL ? "double" : "string";
+            fprintf(stderr, "Error: expected %s value after %s\n", what, shown);
+            return false;
+        }
+        value = argv[++*i];
+    }
+
+    switch (spec->type) {
+        case DU_ARG_INT:
+            *(int *)spec->out = atoi(value);
+            break;
+
+        case DU_ARG_DBL:
+            *(double *)spec->out = atof(value);
+            break;
+
+        case DU_ARG_STR:
+            *(const char **)spec->out = value;
+            break;
+
+        // Just to shut up the compiler warnings
+        case DU_ARG_BOL:
+        case DU_ARG_END:
+            break;
+    }
+    return true;
+}
+
+// Main loop; 'positional' is a Vector * when collecting, NULL otherwise
+static bool __argParse(ArgParser *p, int argc, char **argv, void *positional) {
+    bool isGood = true;
+    bool options = true;  // Cleared by "--"
+    memset(p->found, 0, (size_t)p->count * sizeof(bool));
+
+    for (int i = 1; i < argc; i++) {
+        char *argument = argv[i];
+        if (!argument) continue;
+
+        if (!options || (argument[0] == '-' && argument[1] == '-' && argument[2] == '\0')) {
+            if (options) options = false;
+            else if (!__argPositional(positional, argument)) isGood = false;
+        } else if (argument[0] == '-' && argument[1] == '-') {
+            // --name or --name=value
+            const char *name = argument + 2;
+            const char *eq = strchr(name, '=');
+            size_t len = eq ? (size_t)(eq - name) : strlen(name);
+
+            int32_t idx = __argFindName(p, name, len, __ARG_LONG);
+            if (idx >= 0 && !__argApply(p, idx, eq ? eq + 1 : NULL, argument, &i, argc, argv)) {
+                isGood = false;
+            }
+        } else if (argument[0] == '-' && argument[1] != '\0') {
+            // -a, or a group -abc whose booleans may end in one option taking
+            // a value. A group with an unknown character is ignored as a whole.
+            size_t n = 1;
+            bool takes = false;  // Group ends in an option taking a value
+            while (argument[n]) {
+                int32_t idx = p->shorts[(uint8_t)argument[n]];
+                if (idx < 0) break;
+                n++;
+                if (p->specs[idx].type != DU_ARG_BOL) {
+                    takes = true;
+                    break;
+                }
+            }
+            if (argument[n] && !takes) continue;
+
+            for (size_t c = 1; c < n; c++) {
+                char shown[3] = { '-', argument[c], '\0' };
+                int32_t idx = p->shorts[(uint8_t)argument[c]];
+                const char *value = (c + 1 == n && argument[n]) ? argument + n : NULL;
+                if (!__argApply(p, idx, value, shown, &i, argc, argv)) isGood = false;
+            }
+        } else {
+            int32_t idx = __argFindName(p, argument, strlen(argument), __ARG_BARE);
+            if (idx < 0) {
+                if (!__argPositional(positional, argument)) isGood = false;
+            } else if (!__argApply(p, idx, NULL, argument, &i, argc, argv)) {
+                isGood = false;
+            }
+        }
+    }
+
+    for (int32_t idx = 0; idx < p->count; idx++) {
+        ArgSpec *spec = &p->specs[idx];
+        if (spec->is_req && !p->found[idx]) {
+            isGood = false;
+            fprintf(stderr, "Error: required argument --%s (or -%s) missing\n",
+                    spec->l_rep ? spec->l_rep : "",
+                    spec->s_rep ? spec->s_rep : "");
+        }
+    }
+
+    return isGood;
+}
+
+bool argParserParse(ArgParser *parser, int argc, char **argv) {
+    if (!parser || argc == 1) return false;
+    return __argParse(parser, argc, argv, NULL);
+}
+
+#ifdef DU_VECTOR
+
+bool argParserParseEx(ArgParser *parser, int argc, char **argv, uint32_t flags, Vector *positional) {
+    assert(parser && argv);
+    assert(!positional || positional->cell_size == sizeof(char *));
+
+    if (flags & DU_ARGS_RESPONSE_FILES) {
+        if (!__argExpand(parser, argc, argv)) return false;
+        return __argParse(parser, (int)parser->nargs, parser->args, positional);
+    }
+    return __argParse(parser, argc, argv, positional);
+}
+
+#endif // DU_VECTOR
+
+bool parseArgs(ArgSpec *ctx, int argc, char **argv) {
+    if (!ctx || argc == 1) return false;
+
+    ArgParser *p = argParserNew(ctx);
+    if (!p) return false;
+
+    bool isGood = argParserParse(p, argc, argv);
+    argParserFree(p);
+    return isGood;
+}
+
+void printHelp(const char *prog, ArgSpec *ctx) {
+    if (!ctx) return;
+
+    printf("Usage: %s [options]\n\n", prog);
+    printf("Options:\n");
+
+
+    for (ArgSpec *spec = ctx; spec->type != DU_ARG_END; spec++) {
+        // Build option string
+        char optBuf[128] = {0};
+
+        switch (spec->type) {
+            case DU_ARG_INT:
+                strncat(optBuf, " <int>   ", sizeof(optBuf) - strlen(optBuf) - 1);
+                break;
+            case DU_ARG_DBL:
+                strncat(optBuf, " <double>", sizeof(optBuf) - strlen(optBuf) - 1);
+                break;
+            case DU_ARG_STR:
+                strncat(optBuf, " <string>", sizeof(optBuf) - strlen(optBuf) - 1);
+                break;
+            default:
+                break;
+        }
+
+        if (spec->s_rep) {
+            snprintf(optBuf + strlen(optBuf), sizeof(optBuf) - strlen(optBuf),
+                        "-%s", spec->s_rep);
+        }
+
+        if (spec->l_rep) {
+            if (strlen(optBuf) > 0) {
+                strncat(optBuf, ", ", sizeof(optBuf) - strlen(optBuf) - 1);
+            }
+            snprintf(optBuf + strlen(optBuf), sizeof(optBuf) - strlen(optBuf),
+                        "--%s", spec->l_rep);
+        }
+
+        printf("  %-20s %s%s\n",
+                optBuf,
+                spec->help ? spec->help : "",
+                spec->is_req ? " (required)" : "");
+    }
+
+    printf("\n");
+}
+
+#endif // DU_ARGS
+
+
+#ifdef DU_STRINGS
+
+/*
+ * Substring search shared by strCount, strReplace and the tokenizers.
+ *  - 1-byte needles go to memchr.
+ *  - Needles up to DU_STR_HORSPOOL_MIN bytes compare the needle's first
+ *    and last bytes against 16 (SSE2) or 32 (AVX2) positions at once and
+ *    only memcmp the candidates that match both.
+ *  - Longer needles use Horspool, skipping up to the needle's length.
+ *
+ * Periodic input (runs of 'a' against "aaa...ab") defeats both filters
+ * and makes them O(h_len * n_len). Each one counts the candidates that
+ * failed to match and hands the rest of the haystack to Two-Way, which
+ * is linear, once they have cost more than a few passes over the
+ * haystack (see __strFindDegraded).
+ */
+#define DU_STR_HORSPOOL_MIN 64
+#define DU_STR_FIND_SLACK    8  // Failed candidates always allowed
+
+typedef const char *(*__StrFindKernel)(const char *h, size_t h_len, const char *n, size_t n_len);
+
+// A failed candidate costs up to n_len byte compares. True once 'fails'
+// of them add up to more than 4x the 'scanned' haystack bytes.
+static inline bool __strFindDegraded(size_t fails, size_t scanned, size_t n_len) {
+    return fails > DU_STR_FIND_SLACK + scanned / n_len * 4;
+}
+
+// Splits the needle at its critical factorization n[0..suffix) +
+// n[suffix..n_len), returning 'suffix' and the period of the right half.
+// The maximal suffix is computed under both byte orderings and the
+// later one is kept.
+static size_t __strCriticalFactor(const uint8_t *n, size_t n_len, size_t *period) {
+    size_t ms[2], per[2];
+
+    for (int rev = 0; rev < 2; rev++) {
+        size_t m = SIZE_MAX, j = 0, k = 1, p = 1;
+        while (j + k < n_len) {
+            uint8_t a = n[j + k], b = n[m + k];
+            if (rev ? a > b : a < b) {
+                j += k;
+                k = 1;
+                p = j - m;
+            } else if (a == b) {
+                if (k != p) {
+                    k++;
+                } else {
+                    j += p;
+                    k = 1;
+                }
+            } else {
+                m = j++;
+                k = p = 1;
+            }
+        }
+        ms[rev] = m;
+        per[rev] = p;
+    }
+
+    // SIZE_MAX stands for "before the first byte", hence the + 1
+    int pick = ms[1] + 1 > ms[0] + 1;
+    *period = per[pick];
+    return ms[pick] + 1;
+}
+
+// Two-Way (Crochemore-Perrin): matches the right half of the needle
+// forwards, then the left half backwards, and shifts by the period so
+// no haystack byte is compared more than twice. O(h_len + n_len) time,
+// O(1) space. Windows whose first right-half byte is wrong are skipped
+// with memchr, which only ever moves forward.
+static const char *__strFindTwoWay(const char *hs, size_t h_len, const char *ns, size_t n_len) {
+    const uint8_t *h = (const uint8_t *)hs;
+    const uint8_t *n = (const uint8_t *)ns;
+    if (h_len < n_len) return NULL;
+
+    size_t period;
+    size_t suffix = __strCriticalFactor(n, n_len, &period);
+    size_t last = h_len - n_len;  // Last possible start
+
+    if (memcmp(n, n + period, suffix) == 0) {
+        // Periodic needle: after a full match, the first n_len - period
+        // bytes of the next window are already known to match
+        size_t memory = 0;
+        for (size_t j = 0; j <= last; ) {
+            if (memory == 0 && h[j + suffix] != n[suffix]) {
+                const uint8_t *q = memchr(h + j + suffix, n[suffix], last - j + 1);
+                if (!q) return NULL;
+                j = (size_t)(q - h) - suffix;
+            }
+
+            size_t i = suffix > memory ? suffix : memory;
+            while (i < n_len && n[i] == h[i + j]) i++;
+            if (i < n_len) {
+                j += i - suffix + 1;
+                memory = 0;
+                continue;
+            }
+
+            i = suffix - 1;
+            while (memory < i + 1 && n[i] == h[i + j]) i--;
+            if (i + 1 < memory + 1) return hs + j;
+            j += period;
+            memory = n_len - period;
+        }
+    } else {
+        // No useful period: any mismatch of the left half allows a shift
+        // past the longer of the two halves
+        period = (suffix > n_len - suffix ? suffix : n_len - suffix) + 1;
+        for (size_t j = 0; j <= last; ) {
+            if (h[j + suffix] != n[suffix]) {
+                const uint8_t *q = memchr(h + j + suffix, n[suffix], last - j + 1);
+                if (!q) return NULL;
+                j = (size_t)(q - h) - suffix;
+            }
+
+            size_t i = suffix;
+            while (i < n_len && n[i] == h[i + j]) i++;
+            if (i < n_len) {
+                j += i - suffix + 1;
+                continue;
+            }
+
+            i = suffix - 1;
+            while (i != SIZE_MAX && n[i] == h[i + j]) i--;
+            if (i == SIZE_MAX) return hs + j;
+            j += period;
+        }
+    }
+    return NULL;
+}
+
+// memchr for the first byte, then the last byte, then the rest
+static const char *__strFindScalar(const char *h, size_t h_len, const char *n, size_t n_len) {
+    const char *start = h;
+    const char *end = h + h_len - n_len + 1;  // One past the last possible start
+    size_t fails = 0;
+    while (h < end) {
+        h = memchr(h, n[0], (size_t)(end - h));
+        if (!h) return NULL;
+        if (h[n_len - 1] == n[n_len - 1] && memcmp(h + 1, n + 1, n_len - 2) == 0) return h;
+        h++;
+        if (__strFindDegraded(++fails, (size_t)(h - start), n_len)) {
+            return __strFindTwoWay(h, h_len - (size_t)(h - start), n, n_len);
+        }
+    }
+    return NULL;
+}
+
+static const char *__strFindHorspool(const char *h, size_t h_len, const char *n, size_t n_len) {
+    size_t shift[256];
+    for (size_t i = 0; i < 256; i++) shift[i] = n_len;
+    for (size_t i = 0; i + 1 < n_len; i++) shift[(uint8_t)n[i]] = n_len - 1 - i;
+
+    uint8_t last = (uint8_t)n[n_len - 1];
+    size_t fails = 0;
+    for (size_t i = 0; i + n_len <= h_len; ) {
+        uint8_t c = (uint8_t)h[i + n_len - 1];
+        if (c == last) {
+            if (memcmp(h + i, n, n_len - 1) == 0) return h + i;
+            if (__strFindDegraded(++fails, i, n_len)) {
+                return __strFindTwoWay(h + i + 1, h_len - i - 1, n, n_len);
+            }
+        }
+        i += shift[c];
+    }
+    return NULL;
+}
+
+#if !defined(DU_STRINGS_NO_SIMD) && defined(__GNUC__) \
+        && (defined(__x86_64__) || defined(__i386__))
+#define DU_STRINGS_X86
+
+#include <immintrin.h>
+
+// Candidates are the set bits of 'mask', relative to 'base'. Every
+// position before a failed candidate has been ruled out, so Two-Way can
+// take over right after it.
+#define __STR_CHECK_MASK(mask, base)                                          \
+    while (mask) {                                                            \
+        const char *c = (base) + __builtin_ctz(mask);                         \
+        if (memcmp(c + 1, n + 1, n_len - 2) == 0) return c;                   \
+        if (__strFindDegraded(++fails, (size_t)(c - h), n_len)) {             \
+            size_t done = (size_t)(c + 1 - h);                                \
+            return __strFindTwoWay(c + 1, h_len - done, n, n_len);            \
+        }                                                                     \
+        mask &= mask - 1;                                                     \
+    }
+
+__attribute__((target("sse2")))
+static const char *__strFindSse2(const char *h, size_t h_len, const char *n, size_t n_len) {
+    const __m128i first = _mm_set1_epi8(n[0]);
+    const __m128i last  = _mm_set1_epi8(n[n_len - 1]);
+
+    size_t i = 0, fails = 0;
+    for (; i + n_len - 1 + 16 <= h_len; i += 16) {
+        __m128i f = _mm_cmpeq_epi8(first, _mm_loadu_si128((const __m128i *)(h + i)));
+        __m128i l = _mm_cmpeq_epi8(last,  _mm_loadu_si128((const __m128i *)(h + i + n_len - 1)));
+        unsigned mask = (unsigned)_mm_movemask_epi8(_mm_and_si128(f, l));
+        __STR_CHECK_MASK(mask, h + i)
+    }
+    return __strFindScalar(h + i, h_len - i, n, n_len);
+}
+
+__attribute__((target("avx2")))
+static const char *__strFindAvx2(const char *h, size_t h_len, const char *n, size_t n_len) {
+    const __m256i first = _mm256_set1_epi8(n[0]);
+    const __m256i last  = _mm256_set1_epi8(n[n_len - 1]);
+
+    size_t i = 0, fails = 0;
+    for (; i + n_len - 1 + 32 <= h_len; i += 32) {
+        __m256i f = _mm256_cmpeq_epi8(first, _mm256_loadu_si256((const __m256i *)(h + i)));
+        __m256i l = _mm256_cmpeq_epi8(last,  _mm256_loadu_si256((const __m256i *)(h + i + n_len - 1)));
+        unsigned mask = (unsigned)_mm256_movemask_epi8(_mm256_and_si256(f, l));
+        __STR_CHECK_MASK(mask, h + i)
+    }
+    return __strFindScalar(h + i, h_len - i, n, n_len);
+}
+
+#undef __STR_CHECK_MASK
+
+static __StrFindKernel __str_find_kernel = __strFindSse2;
+
+__attribute__((constructor))
+static void __strSelectKernel(void) {
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) __str_find_kernel = __strFindAvx2;
+}
+
+#else
+
+static const __StrFindKernel __str_find_kernel = __strFindScalar;
+
+#endif
+
+// Finds the first occurrence of n[0..n_len) in h[0..h_len), or NULL
+static const char *__strFind(const char *h, size_t h_len, const char *n, size_t n_len) {
+    if (n_len == 0) return h;
+    if (n_len > h_len) return NULL;
+    if (n_len == 1) return memchr(h, n[0], h_len);
+    if (n_len >= DU_STR_HORSPOOL_MIN) return __strFindHorspool(h, h_len, n, n_len);
+    return __str_find_kernel(h, h_len, n, n_len);
+}
+
+char *strLTrim(char *s) {
+    if (!s) return s;
+
+    char *p = s;
+    while (*p && isspace((unsigned char)*p)) p++;
+
+    if (p != s) memmove(s, p, strlen(p) + 1);
+    return s;
+}
+
+char *strRTrim(char *s) {
+    if (!s) return s;
+
+    size_t len = strlen(s);
+    while (len > 0 && isspace((unsigned char)s[len - 1])) len--;
+
+    s[len] = '\0';
+    return s;
+}
+
+char *strTrim(char *s) {
+    if (!s) return s;
+
+    strRTrim(s);
+    strLTrim(s);
+
+    return s;
+}
+
+void sbInit(StrBuilder *sb) {
+    assert(sb);
+    sb->buf = NULL;
+    sb->len = 0;
+    sb->cap = 0;
+}
+
+bool sbReserve(StrBuilder *sb, size_t extra) {
+    assert(sb);
+    if (extra >= SIZE_MAX - sb->len) return false;
+
+    size_t need = sb->len + extra + 1;
+    if (need <= sb->cap) return true;
+
+    size_t want = sb->cap < 16 ? 16 : sb->cap;
+    while (want < need) want = want > SIZE_MAX / 2 ? need : want * 2;
+
+    char *grown = (char *)duRealloc(sb->buf, want);
+    if (!grown) return false;
+    __DU_STAT_ADD(str_allocs, 1);
+    __DU_STAT_ADD(str_bytes, want);
+
+    sb->buf = grown;
+    sb->cap = want;
+    return true;
+}
+
+bool sbAppendN(StrBuilder *sb, const char *p, size_t n) {
+    assert(sb && (p || n == 0));
+    if (!sbReserve(sb, n)) return false;
+
+    if (n) memcpy(sb->buf + sb->len, p, n);
+    sb->len += n;
+    sb->buf[sb->len] = '\0';
+    return true;
+}
+
+bool sbAppend(StrBuilder *sb, const char *s) {
+    assert(s);
+    return sbAppendN(sb, s, strlen(s));
+}
+
+bool sbAppendChar(StrBuilder *sb, char c) {
+    assert(sb);
+    if (sb->len + 1 >= sb->cap && !sbReserve(sb, 1)) return false;
+
+    sb->buf[sb->len++] = c;
+    sb->buf[sb->len] = '\0';
+    return true;
+}
+
+bool sbAppendv(StrBuilder *sb, const char *fmt, va_list ap) {
+    assert(sb && fmt);
+
+    size_t spare = sb->cap - sb->len;  // Terminator's byte included
+    va_list probe;
+    va_copy(probe, ap);
+    int n = vsnprintf(sb->cap ? sb->buf + sb->len : NULL, spare, fmt, probe);
+    va_end(probe);
+
+    if (n >= 0 && (size_t)n >= spare) {
+        // Did not fit; the truncated attempt overwrote the terminator
+        if (sb->cap) sb->buf[sb->len] = '\0';
+        if (!sbReserve(sb, (size_t)n)) return false;
+        n = vsnprintf(sb->buf + sb->len, (size_t)n + 1, fmt, ap);
+    }
+    if (n < 0) {
+        if (sb->cap) sb->buf[sb->len] = '\0';
+        return false;
+    }
+
+    sb->len += (size_t)n;
+    return true;
+}
+
+bool sbAppendf(StrBuilder *sb, const char *fmt, ...) {
+    va_list ap;
+    va_start(ap, fmt);
+    bool ok = sbAppendv(sb, fmt, ap);
+    va_end(ap);
+    return ok;
+}
+
+bool sbReplace(StrBuilder *sb, const char *s, const char *needle, const char *replacement) {
+    assert(sb && s && needle && replacement);
+
+    size_t s_len = strlen(s);
+    size_t n_len = strlen(needle);
+    if (n_len == 0) return sbAppendN(sb, s, s_len);
+    size_t r_len = strlen(replacement);
+
+    const char *src = s, *end = s + s_len, *m;
+    while ((m = __strFind(src, (size_t)(end - src), needle, n_len))) {
+        if (!sbAppendN(sb, src, (size_t)(m - src))) return false;
+        if (!sbAppendN(sb, replacement, r_len)) return false;
+        src = m + n_len;
+    }
+    return sbAppendN(sb, src, (size_t)(end - src));
+}
+
+StrView sbView(const StrBuilder *sb) {
+    assert(sb);
+    return strViewN(sb->buf ? sb->buf : "", sb->len);
+}
+
+void sbClear(StrBuilder *sb) {
+    assert(sb);
+    sb->len = 0;
+    if (sb->buf) sb->buf[0] = '\0';
+}
+
+char *sbDetach(StrBuilder *sb) {
+    assert(sb);
+    char *out = sb->buf;
+    if (!out) {
+        out = duCalloc(1, 1);
+        __DU_STAT_ADD(str_allocs, 1);
+        __DU_STAT_ADD(str_bytes, 1);
+    }
+    sbInit(sb);
+    return out;
+}
+
+void sbFree(StrBuilder *sb) {
+    assert(sb);
+    duFree(sb->buf);
+    sbInit(sb);
+}
+
+char *strReplace(const char *s, const char *needle, const char *replacement) {
+    assert(s && needle && replacement);
+
+    size_t s_len = strlen(s);
+    size_t n_len = strlen(needle);
+    size_t r_len = strlen(replacement);
+
+    // Output never outgrows the input unless the replacement is longer
+    StrBuilder sb;
+    sbInit(&sb);
+    size_t guess = s_len;
+    if (n_len && r_len > n_len) guess += (r_len - n_len) * 4;
+
+    if (!sbReserve(&sb, guess) || !sbReplace(&sb, s, needle, replacement)) {
+        sbFree(&sb);
+        return NULL;
+    }
+    return sbDetach(&sb);
+}
+
+char *strToLower(char *s) {
+    if (!s) return s;
+
+    char *p = s;
+    while (*p) {
+        if (*p >= 'A' && *p <= 'Z') *p += 32;
+        p++;
+    }
+
+    return s;
+}
+
+char *strToUpper(char *s) {
+    if (!s) return s;
+
+    char *p = s;
+    while (*p) {
+        if (*p >= 'a' && *p <= 'z') *p -= 32;
+        p++;
+    }
+
+    return s;
+}
+
+bool strStartsWith(const char *s, const char *prefix) {
+    if (!s || !prefix) return false;
+    size_t s_len = strlen(s);
+    size_t pr_len = strlen(prefix);
+    
+    if (pr_len > s_len) return false;
+    return (strncmp(s, prefix, pr_len) == 0);
+}
+
+bool strEndsWith(const char *s, const char *suffix) {
+    if (!s || !suffix) return false;
+    size_t s_len = strlen(s);
+    size_t su_len = strlen(suffix);
+
+    if (su_len > s_len) return false;
+    return strncmp(s + s_len - su_len, suffix, su_len) == 0;
+}
+
+char *strSlice(const char *s, size_t start, size_t end) {
+    assert(s);
+
+    // Only scan as far as 'end', not the whole string
+    const char *nul = memchr(s, '\0', end);
+    size_t s_len = nul ? (size_t)(nul - s) : end;
+    if (start >= s_len || start >= end) return strDup("");
+    if (end > s_len) end = s_len;
+
+    return strViewDup(strViewN(s + start, end - start));
+}
+
+size_t strCount(const char *s, const char *needle) {
+    assert(s && needle);
+
+    size_t n_len = strlen(needle);
+    if (n_len == 0) return 0;
+
+    size_t c = 0;
+    const char *p = s, *end = s + strlen(s);
+    while ((p = __strFind(p, (size_t)(end - p), needle, n_len))) {
+        c++;
+        p += n_len;
+    }
+
+    return c;
+}
+
+char *strDup(const char *s) {
+    assert(s);
+    size_t len = strlen(s);
+    char *copy = (char *)duMalloc(len + 1);
+    if (!copy) return NULL;
+    __DU_STAT_ADD(str_allocs, 1);
+    __DU_STAT_ADD(str_bytes, len + 1);
+    memcpy(copy, s, len + 1);
+    return copy;
+}
+
+char *strRev(char *s) {
+    if (!s || strlen(s) <= 1) return s;
+
+    size_t l = 0, r = strlen(s) - 1;
+    while (l < r) {
+        char temp = s[l];
+        s[l++] = s[r];
+        s[r--] = temp;
     }
 
-    return idx;
+    return s;
+}
+
+StrView strView(const char *s) {
+    assert(s);
+    return (StrView){ s, strlen(s) };
 }
 
-size_t b64Decode(char *in, size_t len, uint8_t *out) {
-    assert(in != NULL && len != 0 && out != NULL);
+StrView strViewN(const char *p, size_t len) {
+    assert(p || len == 0);
+    return (StrView){ p, len };
+}
 
-    size_t idx = 0;
-    for (size_t i = 0; i < len; i += 4) {
-        uint8_t c1 = in[ i ] == '=' ? 0 : b64_dt[(uint8_t)in[ i ]];
-        uint8_t c2 = in[i+1] == '=' ? 0 : b64_dt[(uint8_t)in[i+1]];
-        uint8_t c3 = in[i+2] == '=' ? 0 : b64_dt[(uint8_t)in[i+2]];
-        uint8_t c4 = in[i+3] == '=' ? 0 : b64_dt[(uint8_t)in[i+3]];
+StrView strTrimView(StrView v) {
+    while (v.len > 0 && isspace((unsigned char)v.p[0])) {
+        v.p++;
+        v.len--;
+    }
+    while (v.len > 0 && isspace((unsigned char)v.p[v.len - 1])) v.len--;
+    return v;
+}
 
-        uint32_t g = (c1 << 18) | (c2 << 12) | (c3 << 6) | c4;
+StrView strSliceView(StrView v, size_t start, size_t end) {
+    if (end > v.len) end = v.len;
+    if (start >= end) return (StrView){ v.p + (start < v.len ? start : v.len), 0 };
+    return (StrView){ v.p + start, end - start };
+}
 
-        out[idx++] = (g >> 16) & 0xFF;
+bool strViewEq(StrView a, StrView b) {
+    return a.len == b.len && (a.len == 0 || memcmp(a.p, b.p, a.len) == 0);
+}
 
-        if (in[i+2] != '=') out[idx++] = (g >> 8) & 0xFF;
-        if (in[i+3] != '=') out[idx++] = g & 0xFF;
-    }
+char *strViewDup(StrView v) {
+    char *out = (char *)duMalloc(v.len + 1);
+    if (!out) return NULL;
+    __DU_STAT_ADD(str_allocs, 1);
+    __DU_STAT_ADD(str_bytes, v.len + 1);
 
-    return idx;
+    if (v.len > 0) memcpy(out, v.p, v.len);
+    out[v.len] = '\0';
+    return out;
 }
 
-#endif // DU_BASE64
+void strTokInit(StrTokenizer *tok, StrView s, char delim) {
+    assert(tok);
+    tok->rest = s;
+    tok->delim = delim;
+    tok->done = false;
+}
 
+bool strTokNext(StrTokenizer *tok, StrView *out) {
+    assert(tok && out);
+    if (tok->done) return false;
 
-#ifdef DU_HASH
+    const char *d = __strFind(tok->rest.p, tok->rest.len, &tok->delim, 1);
+    if (!d) {
+        *out = tok->rest;
+        tok->done = true;
+        return true;
+    }
 
-#define AI 0x67452301
-#define BI 0xefcdab89
-#define CI 0x98badcfe
-#define DI 0x10325476
+    size_t n = (size_t)(d - tok->rest.p);
+    *out = (StrView){ tok->rest.p, n };
+    tok->rest.p += n + 1;
+    tok->rest.len -= n + 1;
+    return true;
+}
 
-static const uint32_t S[64] = {
-    7,12,17,22,7,12,17,22,7,12,17,22,7,12,17,22,
-        5,9,14,20,5,9,14,20,5,9,14,20,5,9,14,20,
-    4,11,16,23,4,11,16,23,4,11,16,23,4,11,16,23,
-    6,10,15,21,6,10,15,21,6,10,15,21,6,10,15,21
-};
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// In order to use this functionality you must define DU_VECTOR
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
-static const uint32_t T[64] = {
-    0xd76aa478, 0xe8c7b756, 0x242070db, 0xc1bdceee,
-    0xf57c0faf, 0x4787c62a, 0xa8304613, 0xfd469501,
-    0x698098d8, 0x8b44f7af, 0xffff5bb1, 0x895cd7be,
-    0x6b901122, 0xfd987193, 0xa679438e, 0x49b40821,
-    0xf61e2562, 0xc040b340, 0x265e5a51, 0xe9b6c7aa,
-    0xd62f105d, 0x02441453, 0xd8a1e681, 0xe7d3fbc8,
-    0x21e1cde6, 0xc33707d6, 0xf4d50d87, 0x455a14ed,
-    0xa9e3e905, 0xfcefa3f8, 0x676f02d9, 0x8d2a4c8a,
-    0xfffa3942, 0x8771f681, 0x6d9d6122, 0xfde5380c,
-    0xa4beea44, 0x4bdecfa9, 0xf6bb4b60, 0xbebfbc70,
-    0x289b7ec6, 0xeaa127fa, 0xd4ef3085, 0x04881d05,
-    0xd9d4d039, 0xe6db99e5, 0x1fa27cf8, 0xc4ac5665,
-    0xf4292244, 0x432aff97, 0xab9423a7, 0xfc93a039,
-    0x655b59c3, 0x8f0ccc92, 0xffeff47d, 0x85845dd1,
-    0x6fa87e4f, 0xfe2ce6e0, 0xa3014314, 0x4e0811a1,
-    0xf7537e82, 0xbd3af235, 0x2ad7d2bb, 0xeb86d391
-};
+#ifdef DU_VECTOR
 
-#define LR32(x,b) (((x) << ((b) & 31)) | ((x) >> (32 - ((b) & 31))))
-#define RR32(x,b) (((x) >> ((b) & 31)) | ((x) << (32 - ((b) & 31))))
+Vector *strSplit(const char *s, const char delim) {
+    if (!s) return NULL;
 
-#define F(x,y,z)  (((x) & (y)) | ((~(x)) & (z)))
-#define G(x,y,z)  (((x) & (z)) | ((y) & (~z))  )
-#define H(x,y,z)  ((x) ^ (y) ^ (z)             )
-#define I(x,y,z)  ((y) ^ ((x) | (~z))          )
+    Vector *parts = vecNew(sizeof(char *), 0, false);
+    if (!parts) return NULL;
 
-#define FF(a, b, c, d, x, s, ac) \
-    a += F(b, c, d) + x + ac; \
-    a = LR32(a, s); \
-    a += b;
+    StrTokenizer tok;
+    StrView v;
+    strTokInit(&tok, strView(s), delim);
+    while (strTokNext(&tok, &v)) {
+        char *part = strViewDup(v);
+        if (!part || !vecPush(parts, &part)) {
+            duFree(part);
+            for (size_t i = 0; i < parts->length; i++) duFree(*(char **)vecAt(parts, i));
+            vecFree(parts, false);
+            return NULL;
+        }
+    }
 
-#define GG(a, b, c, d, x, s, ac) \
-    a += G(b, c, d) + x + ac; \
-    a = LR32(a, s); \
-    a += b;
+    return parts;
+}
 
-#define HH(a, b, c, d, x, s, ac) \
-    a += H(b, c, d) + x + ac; \
-    a = LR32(a, s); \
-    a += b;
+bool strSplitView(StrView s, const char delim, Vector *out) {
+    assert(out && out->cell_size == sizeof(StrView));
 
-#define II(a, b, c, d, x, s, ac) \
-    a += I(b, c, d) + x + ac; \
-    a = LR32(a, s); \
-    a += b;
+    StrTokenizer tok;
+    StrView v;
+    strTokInit(&tok, s, delim);
+    while (strTokNext(&tok, &v)) {
+        if (!vecPush(out, &v)) return false;
+    }
+    return true;
+}
 
-typedef struct {
-    uint32_t a, b, c, d;
-    uint8_t    buff[64];
-    size_t         size;
-    size_t         blen;
-} Context;
+bool sbJoin(StrBuilder *sb, const Vector *parts, const char *sep) {
+    assert(sb && parts && sep);
 
-void __md5Init(Context *ctx) {
-    assert(ctx != NULL);
-    memset(ctx, 0, sizeof(Context));
-    ctx->a = AI;
-    ctx->b = BI;
-    ctx->c = CI;
-    ctx->d = DI;
+    size_t sep_len = strlen(sep);
+    for (size_t i = 0; i < parts->length; i++) {
+        if (i > 0 && !sbAppendN(sb, sep, sep_len)) return false;
+        if (!sbAppend(sb, *(char **)vecAt((Vector *)parts, i))) return false;
+    }
+    return true;
 }
 
-void __md5HandleBlock(Context *ctx, uint8_t block[64]) {
-    assert(ctx != NULL && block != NULL);
+char *strJoin(const Vector *parts, const char *sep) {
+    if (parts->length == 0) return NULL;
 
-    uint32_t M[16] = {0};
-    for (int i = 0; i < 16; i++) {
-        M[i] = (block[i * 4]       ) 
-        | (block[(i * 4) + 1] <<  8) 
-        | (block[(i * 4) + 2] << 16) 
-        | (block[(i * 4) + 3] << 24);
+    StrBuilder sb;
+    sbInit(&sb);
+    if (!sbJoin(&sb, parts, sep)) {
+        sbFree(&sb);
+        return NULL;
     }
+    return sbDetach(&sb);
+}
 
-    uint32_t a = ctx->a;
-    uint32_t b = ctx->b;
-    uint32_t c = ctx->c;
-    uint32_t d = ctx->d;
+#endif // DU_VECTOR
 
-    // Round 1
-    FF(a, b, c, d, M[ 0],  7, T[ 0]);
-    FF(d, a, b, c, M[ 1], 12, T[ 1]);
-    FF(c, d, a, b, M[ 2], 17, T[ 2]);
-    FF(b, c, d, a, M[ 3], 22, T[ 3]);
-    FF(a, b, c, d, M[ 4],  7, T[ 4]);
-    FF(d, a, b, c, M[ 5], 12, T[ 5]);
-    FF(c, d, a, b, M[ 6], 17, T[ 6]);
-    FF(b, c, d, a, M[ 7], 22, T[ 7]);
-    FF(a, b, c, d, M[ 8],  7, T[ 8]);
-    FF(d, a, b, c, M[ 9], 12, T[ 9]);
-    FF(c, d, a, b, M[10], 17, T[10]);
-    FF(b, c, d, a, M[11], 22, T[11]);
-    FF(a, b, c, d, M[12],  7, T[12]);
-    FF(d, a, b, c, M[13], 12, T[13]);
-    FF(c, d, a, b, M[14], 17, T[14]);
-    FF(b, c, d, a, M[15], 22, T[15]);
-
-    // Round 2
-    GG(a, b, c, d, M[ 1],  5, T[16]);
-    GG(d, a, b, c, M[ 6],  9, T[17]);
-    GG(c, d, a, b, M[11], 14, T[18]);
-    GG(b, c, d, a, M[ 0], 20, T[19]);
-    GG(a, b, c, d, M[ 5],  5, T[20]);
-    GG(d, a, b, c, M[10],  9, T[21]);
-    GG(c, d, a, b, M[15], 14, T[22]);
-    GG(b, c, d, a, M[ 4], 20, T[23]);
-    GG(a, b, c, d, M[ 9],  5, T[24]);
-    GG(d, a, b, c, M[14],  9, T[25]);
-    GG(c, d, a, b, M[ 3], 14, T[26]);
-    GG(b, c, d, a, M[ 8], 20, T[27]);
-    GG(a, b, c, d, M[13],  5, T[28]);
-    GG(d, a, b, c, M[ 2],  9, T[29]);
-    GG(c, d, a, b, M[ 7], 14, T[30]);
-    GG(b, c, d, a, M[12], 20, T[31]);
-
-    // Round 3
-    HH(a, b, c, d, M[ 5],  4, T[32]);
-    HH(d, a, b, c, M[ 8], 11, T[33]);
-    HH(c, d, a, b, M[11], 16, T[34]);
-    HH(b, c, d, a, M[14], 23, T[35]);
-    HH(a, b, c, d, M[ 1],  4, T[36]);
-    HH(d, a, b, c, M[ 4], 11, T[37]);
-    HH(c, d, a, b, M[ 7], 16, T[38]);
-    HH(b, c, d, a, M[10], 23, T[39]);
-    HH(a, b, c, d, M[13],  4, T[40]);
-    HH(d, a, b, c, M[ 0], 11, T[41]);
-    HH(c, d, a, b, M[ 3], 16, T[42]);
-    HH(b, c, d, a, M[ 6], 23, T[43]);
-    HH(a, b, c, d, M[ 9],  4, T[44]);
-    HH(d, a, b, c, M[12], 11, T[45]);
-    HH(c, d, a, b, M[15], 16, T[46]);
-    HH(b, c, d, a, M[ 2], 23, T[47]);
-
-    // Round 4
-    II(a, b, c, d, M[ 0],  6, T[48]);
-    II(d, a, b, c, M[ 7], 10, T[49]);
-    II(c, d, a, b, M[14], 15, T[50]);
-    II(b, c, d, a, M[ 5], 21, T[51]);
-    II(a, b, c, d, M[12],  6, T[52]);
-    II(d, a, b, c, M[ 3], 10, T[53]);
-    II(c, d, a, b, M[10], 15, T[54]);
-    II(b, c, d, a, M[ 1], 21, T[55]);
-    II(a, b, c, d, M[ 8],  6, T[56]);
-    II(d, a, b, c, M[15], 10, T[57]);
-    II(c, d, a, b, M[ 6], 15, T[58]);
-    II(b, c, d, a, M[13], 21, T[59]);
-    II(a, b, c, d, M[ 4],  6, T[60]);
-    II(d, a, b, c, M[11], 10, T[61]);
-    II(c, d, a, b, M[ 2], 15, T[62]);
-    II(b, c, d, a, M[ 9], 21, T[63]);
+#ifdef DU_ARENA
 
-    ctx->a += a;
-    ctx->b += b;
-    ctx->c += c;
-    ctx->d += d;
+char *strViewDupA(Arena *arena, StrView v) {
+    assert(arena && (v.p || v.len == 0));
+    if (v.len == SIZE_MAX) return NULL;
 
-    // Clean up macros
-    #undef F
-    #undef G
-    #undef H
-    #undef I
-    #undef FF
-    #undef GG
-    #undef HH
-    #undef II
+    char *out = arenaAlloc(arena, v.len + 1);
+    if (!out) return NULL;
+    if (v.len) memcpy(out, v.p, v.len);
+    out[v.len] = '\0';
+    return out;
 }
 
-void __md5UpdateLen(Context *ctx, uint8_t *in, size_t len, int update_len) {
-    assert(ctx != NULL && in != NULL);
+char *strDupA(Arena *arena, const char *s) {
+    assert(s);
+    return strViewDupA(arena, strView(s));
+}
 
-    if (update_len) ctx->size += len; 
+#ifdef DU_VECTOR
 
-    size_t offset = 0;
-    if (ctx->blen > 0) {
-        size_t copy = 64 - ctx->blen;
-        if (copy > len) copy = len;
+Vector *strSplitA(Arena *arena, const char *s, const char delim) {
+    assert(arena && s);
 
-        memcpy(ctx->buff + ctx->blen, in, copy);
-        ctx->blen += copy;
-        offset += copy;
+    Vector *parts = vecNewWith(arenaAllocator(arena), sizeof(char *), 0, false);
+    if (!parts) return NULL;
 
-        if (ctx->blen == 64) {
-            __md5HandleBlock(ctx, ctx->buff);
-            ctx->blen = 0;
-        }
+    StrTokenizer tok;
+    StrView v;
+    strTokInit(&tok, strView(s), delim);
+    while (strTokNext(&tok, &v)) {
+        char *part = strViewDupA(arena, v);
+        if (!part || !vecPush(parts, &part)) return NULL;
     }
+    return parts;
+}
 
-    while (len - offset >= 64) {
-        __md5HandleBlock(ctx, in + offset);
-        offset += 64;
-    }
+char *strJoinA(Arena *arena, const Vector *parts, const char *sep) {
+    assert(arena && parts && sep);
+    if (parts->length == 0) return NULL;
 
-    if (len > offset) {
-        ctx->blen = len - offset;
-        memcpy(ctx->buff, in + offset, ctx->blen);
+    // Nothing else is allocated while joining, so 'buf' stays the arena's
+    // top allocation and every growth below extends it in place
+    size_t sep_len = strlen(sep);
+    size_t len = 0, cap = 0;
+    char *buf = NULL;
+
+    for (size_t i = 0; i < parts->length; i++) {
+        const char *part = *(char **)vecAt((Vector *)parts, i);
+        size_t part_len = strlen(part);
+        size_t need = len + part_len + (i > 0 ? sep_len : 0) + 1;
+
+        if (need > cap) {
+            size_t want = cap * 2 > need ? cap * 2 : need;
+            if (want < 64) want = 64;
+            char *grown = arenaRealloc(arena, buf, cap, want);
+            if (!grown) return NULL;
+            buf = grown;
+            cap = want;
+        }
+
+        if (i > 0) {
+            memcpy(buf + len, sep, sep_len);
+            len += sep_len;
+        }
+        memcpy(buf + len, part, part_len);
+        len += part_len;
     }
-}
 
-void __md5Update(Context *ctx, uint8_t *in, size_t len) {
-    __md5UpdateLen(ctx, in, len, 1);
+    buf[len] = '\0';
+    return arenaRealloc(arena, buf, cap, len + 1);  // Gives back the unused tail
 }
 
-void md5_finalize(Context *ctx, char out[16]) {
-    assert(ctx != NULL && out != NULL);
+#endif // DU_VECTOR
 
-    uint8_t padding[64] = {0x80};
-    size_t pad_len = (ctx->blen < 56) ? (56 - ctx->blen) : (120 - ctx->blen);
-    __md5UpdateLen(ctx, padding, pad_len, 0); 
+#endif // DU_ARENA
 
-    uint8_t length_bytes[8];
-    uint64_t size_bits = ctx->size * 8;
-    for (int i = 0; i < 8; i++) {
-        length_bytes[i] = (uint8_t)((size_bits >> (8 * i)) & 0xFF);
+#endif // DU_STRINGS
+
+
+#ifdef DU_TUI
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <errno.h>
+#include <unistd.h>
+#endif
+
+static TuiFrame *__tui_frame = NULL;  // Active frame, NULL when unbuffered
+
+// Writes all 'n' bytes to 'fd'
+static bool __tuiWriteAll(int fd, const char *s, size_t n) {
+#if defined(__unix__) || defined(__APPLE__)
+    while (n > 0) {
+        ssize_t w = write(fd, s, n);
+        if (w < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        s += w;
+        n -= (size_t)w;
     }
-    __md5UpdateLen(ctx, length_bytes, 8, 0);
+    return true;
+#else
+    // No write(2); the frame still goes out as one stdio call
+    (void)fd;
+    return fwrite(s, 1, n, stdout) == n && fflush(stdout) == 0;
+#endif
+}
 
-    uint32_t state[4] = { ctx->a, ctx->b, ctx->c, ctx->d };
-    for (int i = 0; i < 4; i++) {
-        out[(i * 4)    ] = (state[i] >>  0) & 0xFF;
-        out[(i * 4) + 1] = (state[i] >>  8) & 0xFF;
-        out[(i * 4) + 2] = (state[i] >> 16) & 0xFF;
-        out[(i * 4) + 3] = (state[i] >> 24) & 0xFF;
+// Appends to the active frame. If the buffer cannot grow, the pending
+// output is flushed first so nothing is dropped or reordered.
+static void __tuiFrameAppend(TuiFrame *f, const char *s, size_t n) {
+    if (f->len + n > f->cap) {
+        size_t want = f->cap ? f->cap : DU_TUI_FRAME_INIT;
+        while (want < f->len + n) want *= 2;
+
+        char *grown = (char *)duRealloc(f->buf, want);
+        if (grown) {
+            f->buf = grown;
+            f->cap = want;
+        } else {
+            tuiFlush();
+            if (n > f->cap) {
+                __tuiWriteAll(f->fd, s, n);
+                return;
+            }
+        }
     }
 
-    ctx->blen = 0;
-    ctx->size = 0;
-    memset(ctx->buff, 0, 64);
+    memcpy(f->buf + f->len, s, n);
+    f->len += n;
 }
 
-void md5Digest(uint8_t *data, size_t len, uint8_t out[16]) {
-    Context ctx = {0};
-    __md5Init(&ctx);
-    __md5Update(&ctx, data, len);
-    md5_finalize(&ctx, (char *)out);
+static void __tuiEmit(const char *s, size_t n) {
+    if (__tui_frame) __tuiFrameAppend(__tui_frame, s, n);
+    else fwrite(s, 1, n, stdout);
 }
 
-#endif // DU_HASH
-
-
-#ifdef DU_VECTOR
+// Writes the decimal digits of 'n' at 'p', returns the digit count
+static size_t __tuiPutUint(char *p, unsigned n) {
+    char tmp[10];
+    size_t len = 0;
+    do {
+        tmp[len++] = (char)('0' + n % 10);
+        n /= 10;
+    } while (n);
+
+    for (size_t i = 0; i < len; i++) p[i] = tmp[len - 1 - i];
+    return len;
+}
 
-void __vecPurge(Vector *vec) {
-    assert(vec);
-    memset(vec->data, 0, vec->cell_size * vec->capacity);
+// Emits CSI <n> <op>, e.g. "\x1b[12A"
+static void __tuiCsi(unsigned n, char op) {
+    char seq[16] = { '\x1b', '[' };
+    size_t len = 2 + __tuiPutUint(seq + 2, n);
+    seq[len++] = op;
+    __tuiEmit(seq, len);
 }
 
-Vector *vecNew(uint16_t cell_size, uint32_t capacity_opt, bool do_clear) {
-    assert(cell_size > 0);
-    if (capacity_opt == 0) capacity_opt = 4;
+void tuiSetColor(const char *foreground, const char *background) {
+    if (foreground) __tuiEmit(foreground, strlen(foreground));
+    if (background) __tuiEmit(background, strlen(background));
+}
 
-    Vector *v = (Vector *)malloc(sizeof(Vector));
-    if (!v) return NULL;
+void tuiReset(void) {
+    __tuiEmit(DU_TUI_RESET, sizeof(DU_TUI_RESET) - 1);
+}
 
-    v->capacity = capacity_opt;
-    v->length = 0;
-    v->cell_size = cell_size;
-    
-    v->data = malloc(v->cell_size * v->capacity);
-    if (!v->data) {
-        free(v);
-        return NULL;
-    }
+void tuiCursorUp(uint8_t n) {
+    if (n > 0) __tuiCsi(n, 'A');
+}
 
-    if (do_clear) __vecPurge(v);
-    return v;
+void tuiCursorDown(uint8_t n) {
+    if (n > 0) __tuiCsi(n, 'B');
 }
 
-void vecFree(Vector *vec, bool purge_data) {
-    if (!vec) return;
-    if (purge_data) __vecPurge(vec);
-    free(vec->data);
-    free(vec);
+void tuiCursorRight(uint8_t n) {
+    if (n > 0) __tuiCsi(n, 'C');
 }
 
-void vecSet(Vector *vec, uint32_t idx, const void *val) {
-    assert(vec && idx < vec->length);
-    memcpy((char *)vec->data + (vec->cell_size * idx), val, vec->cell_size);
+void tuiCursorLeft(uint8_t n) {
+    if (n > 0) __tuiCsi(n, 'D');
 }
 
-void *vecAt(Vector *vec, uint32_t idx) {
-    assert(vec && idx < vec->length);
-    return (void *)((char *)vec->data + (vec->cell_size * idx));
+void tuiCursorPos(uint16_t x, uint16_t y) {
+    char seq[16] = { '\x1b', '[' };
+    size_t len = 2 + __tuiPutUint(seq + 2, y);
+    seq[len++] = ';';
+    len += __tuiPutUint(seq + len, x);
+    seq[len++] = 'H';
+    __tuiEmit(seq, len);
 }
 
-void vecPush(Vector *vec, const void *val) {
-    assert(vec);
+void tuiHideCursor(void) {
+    __tuiEmit("\x1b[?25l", 6);
+}
 
-    // Handle resizing
-    if (vec->length == vec->capacity) {
-        vec->capacity *= 2;
-        void *temp = realloc(vec->data, vec->cell_size * vec->capacity);
-        if (!temp) return;
-        vec->data = temp;
-    }
+void tuiShowCursor(void) {
+    __tuiEmit("\x1b[?25h", 6);
+}
 
-    vec->length++;
-    vecSet(vec, vec->length-1, val);
+void tuiClearScreen(void) {
+    __tuiEmit("\x1b[2J\x1b[H", 7);
 }
 
-void *vecPop(Vector *vec) {
-    assert(vec && vec->length > 0);
+void tuiFrameBegin(TuiFrame *frame, int fd) {
+    assert(frame);
+    if (__tui_frame && __tui_frame != frame) tuiFrameEnd();
 
-    void *val = vecAt(vec, vec->length-1);
-    vec->length--;
+    fflush(stdout);
+    if (frame != __tui_frame) frame->len = 0;
+    frame->fd = fd;
+    __tui_frame = frame;
+}
 
-    return val;
+void tuiWrite(const char *s, size_t n) {
+    assert(s || n == 0);
+    if (n) __tuiEmit(s, n);
 }
 
-void vecReserve(Vector *vec, uint32_t new_capacity, bool do_clear) {
-    assert(vec);
+bool tuiFlush(void) {
+    TuiFrame *f = __tui_frame;
+    if (!f || f->len == 0) return true;
 
-    void *temp = realloc(vec->data, new_capacity * vec->cell_size);
-    if (!temp) return;
-    
-    if (do_clear) memset(
-        (char *)vec->data + vec->capacity * vec->cell_size,
-        0, (new_capacity - vec->capacity) * vec->cell_size
-    );
-    
-    vec->data = temp;
-    vec->capacity = new_capacity;
+    bool ok = __tuiWriteAll(f->fd, f->buf, f->len);
+    f->len = 0;
+    return ok;
 }
 
-#endif // DU_VECTOR
+bool tuiFrameEnd(void) {
+    TuiFrame *f = __tui_frame;
+    if (!f) return true;
 
+    bool ok = tuiFlush();
+    __tui_frame = NULL;
+    duFree(f->buf);
+    f->buf = NULL;
+    f->cap = 0;
+    return ok;
+}
 
-#ifdef DU_DICT_IMPL
 
-/*
- * This hash function is based on the DJB2 hash function
- * Author: Daniel J. Bernstein (djb)
- */
-static uint32_t __dictHashBytes(const void *key, size_t key_len, uint32_t size) {
-    const uint8_t *data = (const uint8_t *)key;
-    uint32_t hash = 5381;
-    for (size_t i = 0; i < key_len; i++) {
-        hash = ((hash << 5) + hash) ^ data[i]; // hash * 33 ^ data[i]
+// Small staging buffer so a present does not call __tuiEmit per cell
+typedef struct {
+    char   b[512];
+    size_t n;
+} __TuiOut;
+
+static void __tuiOutPut(__TuiOut *o, const char *s, size_t n) {
+    if (o->n + n > sizeof(o->b)) {
+        __tuiEmit(o->b, o->n);
+        o->n = 0;
     }
-    return hash % size;
-}
-
-static bool __dictIsKeyEqual(const void *k1, size_t l1, const void *k2, size_t l2) {
-    if (l1 != l2) return false;
-    return (memcmp(k1, k2, l1) == 0);
+    memcpy(o->b + o->n, s, n);
+    o->n += n;
 }
 
-Dictionary *dictNew(uint32_t size, void (*free_key)(void *), void (*free_val)(void *)) {
-    Dictionary *d = malloc(sizeof(Dictionary));
-    if (!d) return NULL;
+static const TuiCell __tui_blank = { ' ', DU_TUI_COLOR_DEFAULT, DU_TUI_COLOR_DEFAULT, 0 };
 
-    d->size = size;
-    d->free_key = free_key;
-    d->free_val = free_val;
+static bool __tuiCellEq(const TuiCell *a, const TuiCell *b) {
+    return a->glyph == b->glyph && a->fg == b->fg && a->bg == b->bg && a->attr == b->attr;
+}
 
-    d->entries = calloc(size, sizeof(DictEntry *));
-    if (!d->entries) {
-        free(d);
-        return NULL;
-    }
+// Writes the SGR parameter selecting color 'c', returns its length
+static size_t __tuiColorParam(char *p, uint16_t c, bool bg) {
+    if (c >= DU_TUI_COLOR_DEFAULT) return __tuiPutUint(p, bg ? 49 : 39);
+    if (c < 8)  return __tuiPutUint(p, (bg ? 40u : 30u) + c);
+    if (c < 16) return __tuiPutUint(p, (bg ? 100u : 90u) + c - 8);
 
-    return d;
+    memcpy(p, bg ? "48;5;" : "38;5;", 5);
+    return 5 + __tuiPutUint(p + 5, c);
 }
 
-void dictSet(Dictionary *dict, void *key, size_t key_len, void *val) {
-    if (!dict || !key) return;
+// Emits one SGR sequence taking the terminal from 'pen' to the style of
+// 'want'. Attributes can only be switched off by a reset, so losing one
+// starts over from the defaults.
+static void __tuiSgr(__TuiOut *o, TuiCell *pen, bool *known, const TuiCell *want) {
+    static const uint8_t codes[5] = { 1, 2, 4, 5, 7 };  // DU_TUI_ATTR_* order
 
-    uint32_t idx = __dictHashBytes(key, key_len, dict->size);
-    DictEntry *entry = dict->entries[idx];
+    char seq[64] = { '\x1b', '[' };
+    size_t len = 2;
 
-    while (entry) {
-        if (__dictIsKeyEqual(entry->key, entry->key_len, key, key_len)) {
-            if (dict->free_val) dict->free_val(entry->val);
-            entry->val = val;
-            return;
-        }
-        entry = entry->next;
+    if (!*known || (pen->attr & ~want->attr)) {
+        seq[len++] = '0';
+        *pen = __tui_blank;
+        *known = true;
     }
 
-    DictEntry *new = malloc(sizeof(DictEntry));
-    if (!new) return;
-
+    uint8_t added = want->attr & ~pen->attr;
+    for (size_t i = 0; i < 5; i++) {
+        if (!(added & (1u << i))) continue;
+        if (len > 2) seq[len++] = ';';
+        len += __tuiPutUint(seq + len, codes[i]);
+    }
+    if (want->fg != pen->fg) {
+        if (len > 2) seq[len++] = ';';
+        len += __tuiColorParam(seq + len, want->fg, false);
+    }
+    if (want->bg != pen->bg) {
+        if (len > 2) seq[len++] = ';';
+        len += __tuiColorParam(seq + len, want->bg, true);
+    }
+    if (len == 2) return;
 
-    new->key = (void*)key;
-    new->key_len = key_len;
-    new->val = val;
-    new->next = dict->entries[idx];
-    dict->entries[idx] = new;
+    seq[len++] = 'm';
+    __tuiOutPut(o, seq, len);
+    pen->fg = want->fg;
+    pen->bg = want->bg;
+    pen->attr = want->attr;
 }
 
-void *dictGet(Dictionary *dict, void *key, size_t key_len) {
-    if (!dict || !key) return NULL;
+// Encodes a code point as UTF-8, returns its length
+static size_t __tuiUtf8Put(char *p, uint32_t c) {
+    if (c == 0) c = ' ';
+    if (c > 0x10FFFF || (c >= 0xD800 && c <= 0xDFFF)) c = 0xFFFD;
+
+    if (c < 0x80) {
+        p[0] = (char)c;
+        return 1;
+    }
+    if (c < 0x800) {
+        p[0] = (char)(0xC0 | (c >> 6));
+        p[1] = (char)(0x80 | (c & 0x3F));
+        return 2;
+    }
+    if (c < 0x10000) {
+        p[0] = (char)(0xE0 | (c >> 12));
+        p[1] = (char)(0x80 | ((c >> 6) & 0x3F));
+        p[2] = (char)(0x80 | (c & 0x3F));
+        return 3;
+    }
+    p[0] = (char)(0xF0 | (c >> 18));
+    p[1] = (char)(0x80 | ((c >> 12) & 0x3F));
+    p[2] = (char)(0x80 | ((c >> 6) & 0x3F));
+    p[3] = (char)(0x80 | (c & 0x3F));
+    return 4;
+}
 
-    uint32_t idx = __dictHashBytes(key, key_len, dict->size);
-    DictEntry *entry = dict->entries[idx];
+// Decodes the code point at '*s' and advances past it (U+FFFD for bad input)
+static uint32_t __tuiUtf8Next(const unsigned char **s) {
+    const unsigned char *p = *s;
+    uint32_t c = p[0];
+    size_t n;  // Continuation bytes
+    if      (c < 0x80) n = 0;
+    else if (c < 0xC2) n = SIZE_MAX;
+    else if (c < 0xE0) n = 1;
+    else if (c < 0xF0) n = 2;
+    else if (c < 0xF5) n = 3;
+    else               n = SIZE_MAX;
+
+    if (n == SIZE_MAX) {
+        *s = p + 1;
+        return 0xFFFD;
+    }
 
-    while (entry) {
-        if (__dictIsKeyEqual(entry->key, entry->key_len, key, key_len)) {
-            return entry->val;
+    c &= 0x7F >> n;
+    for (size_t i = 1; i <= n; i++) {
+        if ((p[i] & 0xC0) != 0x80) {
+            *s = p + i;
+            return 0xFFFD;
         }
-        entry = entry->next;
+        c = (c << 6) | (p[i] & 0x3F);
     }
-
-    return NULL;
+    *s = p + n + 1;
+    return c;
 }
 
-void dictFree(Dictionary *dict) {
-    if (!dict) return;
-
-    for (uint32_t i = 0; i < dict->size; i++) {
-        DictEntry *entry = dict->entries[i];
-        while (entry) {
-            DictEntry *next = entry->next;
-            if (dict->free_key) dict->free_key(entry->key);
-            if (dict->free_val) dict->free_val(entry->val);
-            free(entry);
-            entry = next;
-        }
+TuiScreen *tuiScreenNew(uint16_t width, uint16_t height) {
+    TuiScreen *scr = (TuiScreen *)duCalloc(1, sizeof(TuiScreen));
+    if (!scr) return NULL;
+
+    if (!tuiScreenResize(scr, width, height)) {
+        duFree(scr);
+        return NULL;
     }
+    return scr;
+}
 
-    free(dict->entries);
-    free(dict);
+bool tuiScreenResize(TuiScreen *scr, uint16_t width, uint16_t height) {
+    assert(scr && width > 0 && height > 0);
+
+    // Both buffers share one allocation, front first
+    size_t cells = (size_t)width * height;
+    TuiCell *block = (TuiCell *)duMalloc(2 * cells * sizeof(TuiCell));
+    if (!block) return false;
+
+    duFree(scr->front);
+    scr->front = block;
+    scr->back = block + cells;
+    scr->width = width;
+    scr->height = height;
+    for (size_t i = 0; i < 2 * cells; i++) block[i] = __tui_blank;
+    scr->full = true;
+    return true;
 }
 
-#endif // DU_DICT
+void tuiScreenClear(TuiScreen *scr, uint16_t fg, uint16_t bg) {
+    assert(scr);
+    TuiCell c = { ' ', fg, bg, 0 };
+    size_t cells = (size_t)scr->width * scr->height;
+    for (size_t i = 0; i < cells; i++) scr->back[i] = c;
+}
+
+void tuiScreenSet(TuiScreen *scr, uint16_t x, uint16_t y,
+                  uint32_t glyph, uint16_t fg, uint16_t bg, uint8_t attr) {
+    assert(scr);
+    if (x >= scr->width || y >= scr->height) return;
 
+    TuiCell *c = &scr->back[(size_t)y * scr->width + x];
+    c->glyph = glyph;
+    c->fg = fg;
+    c->bg = bg;
+    c->attr = attr;
+}
 
-#ifdef DU_ARGS_IMPL
+size_t tuiScreenPrint(TuiScreen *scr, uint16_t x, uint16_t y, const char *text,
+                      uint16_t fg, uint16_t bg, uint8_t attr) {
+    assert(scr && text);
+    if (y >= scr->height) return 0;
 
-static bool __isFlagDec(char *argument, const char *s_rep, const char *l_rep) {
-    if (!argument) return false;
+    const unsigned char *p = (const unsigned char *)text;
+    size_t n = 0;
+    while (*p && x < scr->width) {
+        tuiScreenSet(scr, x++, y, __tuiUtf8Next(&p), fg, bg, attr);
+        n++;
+    }
+    return n;
+}
 
-    // Check against l_rep
-    if (strncmp(argument, "--", 2) == 0 && l_rep) {
-        const char *arg_name = argument + 2;
-        const char *alias = l_rep;
+void tuiScreenInvalidate(TuiScreen *scr) {
+    assert(scr);
+    scr->full = true;
+}
 
-        while(alias) {
-            const char *next = strchr(alias, ',');
-            size_t len = (next) ? (size_t)(next - alias) : strlen(alias);
+void tuiScreenPresent(TuiScreen *scr) {
+    assert(scr);
+
+    __TuiOut out;
+    out.n = 0;
+    TuiCell pen = __tui_blank;
+    bool pen_known = false;  // Style set before this present is unknown
+    size_t cx = SIZE_MAX, cy = SIZE_MAX;  // Terminal cursor, SIZE_MAX if unknown
+    size_t w = scr->width;
+
+    for (size_t y = 0; y < scr->height; y++) {
+        TuiCell *front = scr->front + y * w;
+        TuiCell *back = scr->back + y * w;
+
+        size_t x = 0;
+        while (x < w) {
+            if (!scr->full && __tuiCellEq(&front[x], &back[x])) {
+                x++;
+                continue;
+            }
 
-            if (strncmp(alias, arg_name, len) == 0 
-                    && (arg_name[len] == '\0' || arg_name[len] == '=')) {
-                return true;
+            // Extend the run over later changes that are at most
+            // DU_TUI_MERGE_GAP unchanged cells apart
+            size_t last = x;
+            for (size_t j = x + 1; j < w && j - last - 1 <= DU_TUI_MERGE_GAP; j++) {
+                if (scr->full || !__tuiCellEq(&front[j], &back[j])) last = j;
             }
 
-            alias = (next) ? next + 1 : NULL;
-        }
-    }
+            if (cy != y || cx != x) {
+                char seq[32] = { '\x1b', '[' };
+                size_t len = 2;
+                if (cy == y && cx < x) {
+                    // Forward on the same row is shorter as a relative move
+                    len += __tuiPutUint(seq + len, (unsigned)(x - cx));
+                    seq[len++] = 'C';
+                } else {
+                    len += __tuiPutUint(seq + len, (unsigned)y + 1);
+                    seq[len++] = ';';
+                    len += __tuiPutUint(seq + len, (unsigned)x + 1);
+                    seq[len++] = 'H';
+                }
+                __tuiOutPut(&out, seq, len);
+            }
 
-    // Check against s_rep
-    else if (strncmp(argument, "-", 1) == 0 
-                && s_rep && argument[1] != '\0' 
-                && argument[2] == '\0') {
-                    
-        char arg_char = *(argument + 1);
-        while (*s_rep != '\0') {
-            if (arg_char == *s_rep) {
-                return true;
+            for (; x <= last; x++) {
+                char glyph[4];
+                __tuiSgr(&out, &pen, &pen_known, &back[x]);
+                __tuiOutPut(&out, glyph, __tuiUtf8Put(glyph, back[x].glyph));
+                front[x] = back[x];
             }
-            s_rep++;
+
+            // Writing the last column leaves the cursor in a pending-wrap
+            // state terminals disagree on
+            cx = x < w ? x : SIZE_MAX;
+            cy = y;
         }
     }
 
-    // Check whole command
-    else if (l_rep) {
-        if (strcmp(argument, l_rep) == 0) {
-            return true;
-        }
+    if (pen_known && (pen.fg != DU_TUI_COLOR_DEFAULT || pen.bg != DU_TUI_COLOR_DEFAULT || pen.attr)) {
+        __tuiOutPut(&out, DU_TUI_RESET, sizeof(DU_TUI_RESET) - 1);
     }
+    if (out.n) __tuiEmit(out.b, out.n);
+    scr->full = false;
+}
 
-    return false;
+void tuiScreenFree(TuiScreen *scr) {
+    if (!scr) return;
+    duFree(scr->front);
+    duFree(scr);
 }
 
-bool parseArgs(ArgSpec *ctx, int argc, char **argv) {
-    if (!ctx || argc == 1) return false;
+#endif // DU_TUI
 
-    bool isGood = true;
 
-    int count = 0;
-    for (ArgSpec *spec = ctx; spec->type != DU_ARG_END; spec++) count++;
-    bool *found = calloc(count, sizeof(bool));
+#ifdef DU_IO
 
-    for (int i = 1; i < argc; i++) {
-        char *argument = argv[i];
-        int idx = 0;
-
-        for (ArgSpec *spec = ctx; spec->type != DU_ARG_END; spec++, idx++) {
-            if (__isFlagDec(argument, spec->s_rep, spec->l_rep)) {
-                found[idx] = true;
-
-                switch (spec->type) {
-                    case DU_ARG_BOL:
-                        if (spec->out)
-                            *(bool *)spec->out = true;
-                        break;
-                
-                    case DU_ARG_INT: {
-                        if (!spec->out) break;
-                        char *val = strchr(argument, '=');
-                        if (val) {
-                            *(int *)spec->out = atoi(val + 1);
-                        } else if (i + 1 < argc) {
-                            *(int *)spec->out = atoi(argv[++i]);
-                        } else {
-                            fprintf(stderr, "Error: expected integer value after %s\n", argument);
-                            isGood = false;
-                        }
-                        break;
-                    }
-                
-                    case DU_ARG_DBL: {
-                        if (!spec->out) break;
-                        char *val = strchr(argument, '=');
-                        if (val) {
-                            *(double *)spec->out = atof(val + 1);
-                        } else if (i + 1 < argc) {
-                            *(double *)spec->out = atof(argv[++i]);
-                        } else {
-                            fprintf(stderr, "Error: expected double value after %s\n", argument);
-                            isGood = false;
-                        }
-                        break;
-                    }
-                
-                    case DU_ARG_STR: {
-                        if (!spec->out) break;
-                        if (i + 1 < argc) {
-                            *(char **)spec->out = argv[++i];
-                        } else {
-                            fprintf(stderr, "Error: expected string value after %s\n", argument);
-                            isGood = false;
-                        }
-                        break;
-                    }
-
-                    // Just to shut up the compiler warnings
-                    case DU_ARG_END: {
-                        break;
-                    }
-                }
-            }
-        }
-    }
+#if defined(__unix__) || defined(__APPLE__)
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
 
-    int idx = 0;
-    for (ArgSpec *spec = ctx; spec->type != DU_ARG_END; spec++, idx++) {
-        if (spec->is_req && !found[idx]) {
-            isGood = false;
-            fprintf(stderr, "Error: required argument --%s (or -%s) missing\n",
-                    spec->l_rep ? spec->l_rep : "",
-                    spec->s_rep ? spec->s_rep : "");
+#if !defined(DU_IO_NO_SIMD) && defined(__GNUC__) \
+        && (defined(__x86_64__) || defined(__i386__))
+#define DU_IO_X86
+
+#include <immintrin.h>
+
+// Scans the whole 64-byte blocks of p[0..len) for '\n'. Returns the
+// offset of the first block holding one, with bit i of '*mask' set when
+// byte i of that block is '\n'; or the bytes scanned with '*mask' 0.
+typedef size_t (*__IoNewlineKernel)(const char *p, size_t len, uint64_t *mask);
+
+__attribute__((target("sse2")))
+static size_t __ioNewlinesSse2(const char *p, size_t len, uint64_t *mask) {
+    const __m128i nl = _mm_set1_epi8('\n');
+    size_t i = 0;
+    for (; i + 64 <= len; i += 64) {
+        uint64_t m = 0;
+        for (int k = 0; k < 4; k++) {
+            __m128i v = _mm_loadu_si128((const __m128i *)(p + i + 16 * k));
+            m |= (uint64_t)(uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(v, nl)) << (16 * k);
+        }
+        if (m) {
+            *mask = m;
+            return i;
         }
     }
+    *mask = 0;
+    return i;
+}
 
-    free(found);
-    return isGood;
+__attribute__((target("avx2")))
+static size_t __ioNewlinesAvx2(const char *p, size_t len, uint64_t *mask) {
+    const __m256i nl = _mm256_set1_epi8('\n');
+    size_t i = 0;
+    for (; i + 64 <= len; i += 64) {
+        __m256i lo = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *)(p + i)), nl);
+        __m256i hi = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *)(p + i + 32)), nl);
+        if (_mm256_testz_si256(_mm256_or_si256(lo, hi), _mm256_or_si256(lo, hi))) continue;
+
+        *mask = (uint64_t)(uint32_t)_mm256_movemask_epi8(lo)
+              | (uint64_t)(uint32_t)_mm256_movemask_epi8(hi) << 32;
+        return i;
+    }
+    *mask = 0;
+    return i;
 }
 
-void printHelp(const char *prog, ArgSpec *ctx) {
-    if (!ctx) return;
+__attribute__((target("avx512bw")))
+static size_t __ioNewlinesAvx512(const char *p, size_t len, uint64_t *mask) {
+    const __m512i nl = _mm512_set1_epi8('\n');
+    size_t i = 0;
+    for (; i + 64 <= len; i += 64) {
+        uint64_t m = _mm512_cmpeq_epi8_mask(_mm512_loadu_si512((const void *)(p + i)), nl);
+        if (m) {
+            *mask = m;
+            return i;
+        }
+    }
+    *mask = 0;
+    return i;
+}
 
-    printf("Usage: %s [options]\n\n", prog);
-    printf("Options:\n");
+static __IoNewlineKernel __io_newline_kernel = __ioNewlinesSse2;
 
+__attribute__((constructor))
+static void __ioSelectKernel(void) {
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512bw")) __io_newline_kernel = __ioNewlinesAvx512;
+    else if (__builtin_cpu_supports("avx2")) __io_newline_kernel = __ioNewlinesAvx2;
+}
 
-    for (ArgSpec *spec = ctx; spec->type != DU_ARG_END; spec++) {
-        // Build option string
-        char optBuf[128] = {0};
+#endif
 
-        switch (spec->type) {
-            case DU_ARG_INT:
-                strncat(optBuf, " <int>   ", sizeof(optBuf) - strlen(optBuf) - 1);
-                break;
-            case DU_ARG_DBL:
-                strncat(optBuf, " <double>", sizeof(optBuf) - strlen(optBuf) - 1);
-                break;
-            case DU_ARG_STR:
-                strncat(optBuf, " <string>", sizeof(optBuf) - strlen(optBuf) - 1);
-                break;
-            default:
-                break;
-        }
+void ioLinesInit(IoLines *it, StrView text) {
+    assert(it && (text.p || text.len == 0));
+    *it = (IoLines){ text.p, text.len, 0, 0, 0, 0 };
+}
 
-        if (spec->s_rep) {
-            snprintf(optBuf + strlen(optBuf), sizeof(optBuf) - strlen(optBuf),
-                        "-%s", spec->s_rep);
+// Returns the next line and whether a '\n' ended it (false for the
+// unterminated rest of the text). The kernel stops at the first 64-byte
+// block holding a newline and keeps its bitmask, so the following short
+// lines in that block cost a bit scan each; the final partial block
+// falls back to memchr.
+static bool __ioLinesNext(IoLines *it, StrView *line, bool *ended) {
+    if (it->pos >= it->len) return false;
+
+    size_t nl = it->len;
+    for (;;) {
+#ifdef DU_IO_X86
+        if (it->mask) {
+            nl = it->mask_at + (size_t)__builtin_ctzll(it->mask);
+            it->mask &= it->mask - 1;
+            break;
         }
-
-        if (spec->l_rep) {
-            if (strlen(optBuf) > 0) {
-                strncat(optBuf, ", ", sizeof(optBuf) - strlen(optBuf) - 1);
+        if (it->len - it->scan >= 64) {
+            it->scan += __io_newline_kernel(it->data + it->scan, it->len - it->scan, &it->mask);
+            if (it->mask) {
+                it->mask_at = it->scan;
+                it->scan += 64;
             }
-            snprintf(optBuf + strlen(optBuf), sizeof(optBuf) - strlen(optBuf),
-                        "--%s", spec->l_rep);
+            continue;
         }
-
-        printf("  %-20s %s%s\n",
-                optBuf,
-                spec->help ? spec->help : "",
-                spec->is_req ? " (required)" : "");
+#endif
+        const char *p = it->scan < it->len ? memchr(it->data + it->scan, '\n', it->len - it->scan) : NULL;
+        if (p) nl = (size_t)(p - it->data);
+        it->scan = p ? nl + 1 : it->len;
+        break;
     }
 
-    printf("\n");
-}
+    *ended = nl < it->len;
+    size_t end = nl;
+    if (end > it->pos && it->data[end - 1] == '\r') end--;
 
-#endif // DU_ARGS
+    *line = (StrView){ it->data + it->pos, end - it->pos };
+    it->pos = *ended ? nl + 1 : it->len;
+    return true;
+}
 
+bool ioLinesNext(IoLines *it, StrView *line) {
+    assert(it && line);
+    bool ended;
+    return __ioLinesNext(it, line, &ended);
+}
 
-#ifdef DU_STRINGS
+// Reads up to 'n' bytes into 'dst', returning the count (0 at EOF or error)
+static size_t __ioRead(IoReader *r, char *dst, size_t n) {
+#if defined(__unix__) || defined(__APPLE__)
+    for (;;) {
+        ssize_t got = read(r->fd, dst, n);
+        if (got >= 0) return (size_t)got;
+        if (errno != EINTR) {
+            r->error = true;
+            return 0;
+        }
+    }
+#else
+    size_t got = fread(dst, 1, n, r->fp);
+    if (got == 0 && ferror(r->fp)) r->error = true;
+    return got;
+#endif
+}
 
-char *strTrimL(char *s) {
-    if (!s) return s;
+// Moves the unread rest of 'buf' to its front and reads more after it,
+// doubling the buffer when the rest already fills it (one long line).
+// The rest holds no newline, so scanning resumes after it.
+static bool __ioFill(IoReader *r) {
+    size_t rest = r->lines.len - r->lines.pos;
+    if (rest > 0 && r->lines.pos > 0) memmove(r->buf, r->buf + r->lines.pos, rest);
+
+    if (rest == r->cap) {
+        if (r->cap > SIZE_MAX / 2) return false;
+        char *grown = (char *)duRealloc(r->buf, r->cap * 2);
+        if (!grown) return false;
+        r->buf = grown;
+        r->cap *= 2;
+    }
 
-    char *p = s;
-    while (*p && isspace((unsigned char)*p)) p++;
+    size_t got = __ioRead(r, r->buf + rest, r->cap - rest);
+    if (got == 0) r->eof = true;
 
-    memmove(s, p, strlen(p) + 1);
-    return s;
+    r->lines = (IoLines){ r->buf, rest + got, 0, rest, 0, 0 };
+    return !r->error;
 }
 
-char *strTrimR(char *s) {
-    if (!s) return s;
+// Sets up the buffered mode
+static bool __ioStartBuffered(IoReader *r) {
+    r->buf = duMalloc(DU_IO_CHUNK);
+    if (!r->buf) return false;
+    r->cap = DU_IO_CHUNK;
+    ioLinesInit(&r->lines, (StrView){ r->buf, 0 });
+    return true;
+}
 
-    char *p = s + strlen(s) - 1;
-    while(p >= s && isspace((unsigned char)*p)) p--;
+#if defined(__unix__) || defined(__APPLE__)
+
+bool ioOpenFd(IoReader *r, int fd) {
+    assert(r && fd >= 0);
+    memset(r, 0, sizeof(*r));
+    r->fd = fd;
+
+    struct stat st;
+    if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode)
+            && st.st_size > 0 && (uint64_t)st.st_size <= SIZE_MAX) {
+        size_t size = (size_t)st.st_size;
+        void *map = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (map != MAP_FAILED) {
+#if defined(POSIX_MADV_SEQUENTIAL)
+            posix_madvise(map, size, POSIX_MADV_SEQUENTIAL);
+#elif defined(MADV_SEQUENTIAL)
+            madvise(map, size, MADV_SEQUENTIAL);
+#endif
+            r->map = map;
+            r->map_len = size;
+            r->eof = true;
+            ioLinesInit(&r->lines, (StrView){ map, size });
+
+            // Start where the descriptor is, as a read loop would
+            off_t off = lseek(fd, 0, SEEK_CUR);
+            if (off > 0) {
+                size_t skip = (uint64_t)off < size ? (size_t)off : size;
+                r->lines.pos = r->lines.scan = skip;
+            }
+            return true;
+        }
+    }
 
-    *(p + 1) = '\0';
-    return s;
+    // Pipes, empty or special files, or a failed mmap
+    return __ioStartBuffered(r);
 }
 
-char *strTrim(char *s) {
-    if (!s) return s;
+bool ioOpen(IoReader *r, const char *path) {
+    assert(r && path);
 
-    strTrimL(s);
-    strTrimR(s);
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return false;
 
-    return s;
+    if (!ioOpenFd(r, fd)) {
+        close(fd);
+        return false;
+    }
+    r->owns_fd = true;
+    return true;
 }
 
-char *strReplace(const char *s, const char *needle, const char *replacement) {
-    assert(s && needle && replacement);
+#else
 
-    size_t n_len = strlen(needle);
-    if (n_len == 0) return strDup(s);
-    size_t r_len = strlen(replacement);
+bool ioOpen(IoReader *r, const char *path) {
+    assert(r && path);
+    memset(r, 0, sizeof(*r));
+    r->fd = -1;
 
-    size_t new_len = strlen(s) + ((r_len - n_len) * strCount(s, needle));
-    
-    char *out = malloc(new_len + 1);
-    if (!out) return NULL;
+    r->fp = fopen(path, "rb");
+    if (!r->fp) return false;
 
-    const char *src = s;
-    char *dst = out;
-    while (*src) {
-        if (strncmp(src, needle, n_len) == 0) {
-            memcpy(dst, replacement, r_len);
-            src += n_len;
-            dst += r_len;
-        } else {
-            *dst++ = *src++;
-        }
+    if (!__ioStartBuffered(r)) {
+        fclose(r->fp);
+        r->fp = NULL;
+        return false;
     }
-
-    *dst = '\0';
-    return out;
+    return true;
 }
 
-char *strToLower(char *s) {
-    if (!s) return s;
+#endif
 
-    char *p = s;
-    while (*p) {
-        if (*p >= 'A' && *p <= 'Z') *p += 32;
-        p++;
+bool ioReadLine(IoReader *r, StrView *line) {
+    assert(r && line);
+
+    for (;;) {
+        // An unterminated line is only final at EOF; otherwise rewind,
+        // read more and look again
+        IoLines save = r->lines;
+        bool ended;
+        if (__ioLinesNext(&r->lines, line, &ended) && (ended || r->eof)) return true;
+        if (r->eof || r->error) return false;
+
+        r->lines = save;
+        if (!__ioFill(r)) {
+            r->error = true;
+            return false;
+        }
     }
-
-    return s;
 }
 
-char *strToUpper(char *s) {
-    if (!s) return s;
-
-    char *p = s;
-    while (*p) {
-        if (*p >= 'a' && *p <= 'z') *p -= 32;
-        p++;
-    }
+void ioClose(IoReader *r) {
+    if (!r) return;
 
-    return s;
+#if defined(__unix__) || defined(__APPLE__)
+    if (r->map) munmap(r->map, r->map_len);
+    if (r->owns_fd && r->fd >= 0) close(r->fd);
+#else
+    if (r->fp) fclose(r->fp);
+#endif
+    duFree(r->buf);
+    memset(r, 0, sizeof(*r));
+    r->fd = -1;
 }
 
-bool strStartsWith(const char *s, const char *prefix) {
-    if (!s || !prefix) return false;
-    size_t s_len = strlen(s);
-    size_t pr_len = strlen(prefix);
-    
-    if (pr_len > s_len) return false;
-    return (strncmp(s, prefix, pr_len) == 0);
-}
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// In order to use this functionality you must define DU_VECTOR
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
-bool strEndsWith(const char *s, const char *suffix) {
-    if (!s || !suffix) return false;
-    size_t s_len = strlen(s);
-    size_t su_len = strlen(suffix);
+#ifdef DU_VECTOR
 
-    if (su_len > s_len) return false;
-    return strncmp(s + s_len - su_len, suffix, su_len) == 0;
+bool ioSplitFields(StrView line, char delim, Vector *fields) {
+    assert(fields && fields->cell_size == sizeof(StrView));
+    fields->length = 0;
+    return strSplitView(line, delim, fields);
 }
 
-char *strSlice(const char *s, size_t start, size_t end) {
-    assert(s);
-
-    size_t s_len = strlen(s);
-    if (start >= s_len || start >= end) return strDup("");
-    if (end > s_len) end = s_len;
+#endif // DU_VECTOR
 
-    size_t len = end - start;
-    char *out = malloc(len + 1);
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// In order to use this functionality you must define DU_POOL
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
-    memcpy(out, s + start, len);
-    out[len] = '\0';
+#ifdef DU_POOL
 
-    return out;
+typedef struct {
+    const char *data;   // Unread part of the mapping
+    size_t      len;
+    size_t      chunk;  // Bytes per chunk
+    IoChunkFn   fn;
+    void       *ctx;
+} __IoParallelJob;
+
+// Start of the first line beginning at or after 'off'
+static size_t __ioLineStart(const char *data, size_t len, size_t off) {
+    if (off == 0) return 0;
+    if (off >= len) return len;
+    const char *nl = memchr(data + off - 1, '\n', len - off + 1);
+    return nl ? (size_t)(nl - data) + 1 : len;
 }
 
-size_t strCount(const char *s, const char *needle) {
-    size_t n_len = strlen(needle);
-    size_t c = 0;
+// Chunk i holds the lines that start in [i * chunk, (i + 1) * chunk)
+static void __ioParallelTask(void *arg, size_t begin, size_t end) {
+    __IoParallelJob *j = arg;
+    for (size_t i = begin; i < end; i++) {
+        size_t from = __ioLineStart(j->data, j->len, i * j->chunk);
+        size_t to = __ioLineStart(j->data, j->len, (i + 1) * j->chunk);
+        if (from < to) j->fn(j->ctx, i, (StrView){ j->data + from, to - from });
+    }
+}
 
-    const char *p = s;
-    while((p = strstr(p, needle))) {
-        c++;
-        p += n_len;
+bool ioParallel(ThreadPool *pool, IoReader *r, size_t chunk_size, IoChunkFn fn, void *ctx) {
+    assert(r && fn);
+    if (chunk_size == 0) chunk_size = DU_IO_PARALLEL_CHUNK;
+
+    IoLines *it = &r->lines;
+    if (r->map) {
+        __IoParallelJob job = { it->data + it->pos, it->len - it->pos, chunk_size, fn, ctx };
+        size_t chunks = (job.len + chunk_size - 1) / chunk_size;
+        parallelFor(pool, 0, chunks, 1, __ioParallelTask, &job);
+        it->pos = it->scan = it->len;
+        it->mask = 0;
+        return true;
     }
 
-    return c;
+    // Buffered: everything up to the last newline of each fill
+    size_t chunk = 0;
+    for (;;) {
+        size_t last = it->len;
+        while (last > it->pos && it->data[last - 1] != '\n') last--;
+        if (r->eof) last = it->len;
+
+        if (last > it->pos) {
+            fn(ctx, chunk++, (StrView){ it->data + it->pos, last - it->pos });
+            it->pos = it->scan = last;
+            it->mask = 0;
+        }
+        if (r->eof) return !r->error;
+        if (!__ioFill(r)) {
+            r->error = true;
+            return false;
+        }
+    }
 }
 
-char *strDup(const char *s) {
-    assert(s);
-    size_t len = strlen(s);
-    char *copy = malloc(len + 1);
-    if (!copy) return NULL;
-    memcpy(copy, s, len + 1);
-    return copy;
-}
+#endif // DU_POOL
 
-char *strRev(char *s) {
-    if (!s || strlen(s) <= 1) return s;
 
-    size_t l = 0, r = strlen(s) - 1;
-    while (l < r) {
-        char temp = s[l];
-        s[l++] = s[r];
-        s[r--] = temp;
-    }
+#endif // DU_IO
 
-    return s;
-}
 
-// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
-// In order to use this functionality you must define DU_VECTOR
-// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+#ifdef DU_RING
 
-#ifdef DU_VECTOR
+#if defined(__unix__) || defined(__APPLE__)
+#include <sched.h>
+#endif
 
-Vector *strSplit(const char *s, const char delim) {
-    if (!s) return NULL;
+// SPSC: 'head' is written by the producer only and 'tail' by the consumer
+// only; each side caches the other's index and rereads it only when the
+// cached value says the ring is full / empty.
+// MPMC: Vyukov's bounded queue, with batches claimed at once. A slot
+// holding sequence number s is free for position s and filled for
+// position s - 1. A batch is the run of ready slots at 'head' / 'tail',
+// claimed with one CAS; the slots are checked first, so nobody ever
+// waits on a peer that is still copying.
+struct ring_s {
+    size_t   head;        // Next position to write
+    size_t   tail_cache;  // Producer's last view of 'tail' (SPSC)
+    char     pad0[DU_CACHE_LINE - 2 * sizeof(size_t)];
+    size_t   tail;        // Next position to read
+    size_t   head_cache;  // Consumer's last view of 'head' (SPSC)
+    char     pad1[DU_CACHE_LINE - 2 * sizeof(size_t)];
+    uint8_t *cells;       // Records (SPSC) or sequence + record slots (MPMC)
+    size_t   mask;        // capacity - 1
+    size_t   stride;      // Bytes per slot
+    uint16_t cell_size;   // Bytes per record
+    uint32_t flags;       // DU_RING_* flags given to ringNew
+    void    *mem;         // Allocation holding the ring and its cells
+    const DuAllocator *alloc;
+};
 
-    char needle[2] = { delim, '\0' };
-    uint32_t p_len = (uint32_t)strCount(s, needle) + 1;
-    if (p_len == 1) return NULL;
+#define __RING_LOAD(p)     __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define __RING_STORE(p, v) __atomic_store_n((p), (v), __ATOMIC_RELEASE)
 
-    Vector *parts = vecNew(sizeof(char *), p_len, true);
-    if (!parts) return NULL;
+// Backs off while waiting on another thread: pause at first, then give
+// the CPU away so a preempted peer can finish
+static inline void __ringRelax(unsigned *spins) {
+    if (++*spins < 64) {
+#if defined(__x86_64__) || defined(__i386__)
+        __builtin_ia32_pause();
+#endif
+        return;
+    }
+    *spins = 0;
+#if defined(__unix__) || defined(__APPLE__)
+    sched_yield();
+#endif
+}
 
-    const char *p = s;
-    size_t l = 0, r = 0;
-    while(*p) {
-        if (*p == delim) {
-            r = p - s;
-            char *tok = strSlice(s, l, r);
-            vecPush(parts, &tok);
-            l = r + 1;
-        }
-        p++;
+Ring *ringNew(uint16_t cell_size, size_t capacity, uint32_t flags) {
+    return ringNewWith(NULL, cell_size, capacity, flags);
+}
+
+Ring *ringNewWith(const DuAllocator *alloc, uint16_t cell_size, size_t capacity, uint32_t flags) {
+    assert(cell_size > 0);
+    if (!alloc) alloc = duGetAllocator();
+
+    size_t cap = 2;
+    while (cap < capacity && cap <= SIZE_MAX / 4) cap <<= 1;
+
+    // MPMC slots start with a sequence number and stay size_t aligned
+    size_t stride = cell_size;
+    if (flags & DU_RING_MPMC) {
+        stride = (sizeof(size_t) + cell_size + sizeof(size_t) - 1) & ~(sizeof(size_t) - 1);
     }
+    if (cap > (SIZE_MAX - sizeof(Ring) - 2 * DU_CACHE_LINE) / stride) return NULL;
+
+    // The ring and its cells share one allocation, aligned to a cache line
+    // by hand so the padded indices really get lines of their own
+    size_t ring_bytes = (sizeof(Ring) + DU_CACHE_LINE - 1) & ~(size_t)(DU_CACHE_LINE - 1);
+    void *mem = __duAllocA(alloc, ring_bytes + cap * stride + DU_CACHE_LINE);
+    if (!mem) return NULL;
+
+    uintptr_t at = ((uintptr_t)mem + DU_CACHE_LINE - 1) & ~(uintptr_t)(DU_CACHE_LINE - 1);
+    Ring *ring = (Ring *)at;
+    memset(ring, 0, sizeof(Ring));
+    ring->cells = (uint8_t *)ring + ring_bytes;
+    ring->mask = cap - 1;
+    ring->stride = stride;
+    ring->cell_size = cell_size;
+    ring->flags = flags;
+    ring->mem = mem;
+    ring->alloc = alloc;
+
+    if (flags & DU_RING_MPMC) {
+        for (size_t i = 0; i < cap; i++) memcpy(ring->cells + i * stride, &i, sizeof(size_t));
+    }
+    return ring;
+}
 
-    r = p - s;
-    if (r > l) {
-        char *tok = strSlice(s, l, r);
-        vecPush(parts, &tok);
+// Copies 'n' records between the ring's contiguous cells at position
+// 'pos' and 'buf', in at most two pieces around the end of the buffer
+static void __ringCopySpsc(Ring *ring, size_t pos, void *buf, size_t n, bool to_ring) {
+    size_t at = pos & ring->mask;
+    size_t first = ring->mask + 1 - at;
+    if (first > n) first = n;
+
+    uint8_t *cells = ring->cells + at * ring->stride;
+    uint8_t *b = buf;
+    size_t bytes = first * ring->cell_size;
+    size_t rest = (n - first) * ring->cell_size;
+
+    if (to_ring) {
+        memcpy(cells, b, bytes);
+        if (rest) memcpy(ring->cells, b + bytes, rest);
     } else {
-        // trailing delim
-        char *tok = strDup("");
-        vecPush(parts, &tok);
+        memcpy(b, cells, bytes);
+        if (rest) memcpy(b + bytes, ring->cells, rest);
     }
+}
 
-    return parts;
+static inline size_t *__ringSeq(Ring *ring, size_t pos) {
+    return (size_t *)(ring->cells + (pos & ring->mask) * ring->stride);
 }
 
-char *strJoin(const Vector *parts, const char *sep) {
-    uint32_t count = parts->length;
-    if (count == 0) return NULL;
+static size_t __ringTryPushSpsc(Ring *ring, const void *src, size_t n) {
+    size_t cap = ring->mask + 1;
+    size_t head = ring->head;
 
-    size_t sep_len = strlen(sep);
-    size_t total_len = 0;
-    
-    for (uint32_t i = 0; i < count; i++) {
-        char *s = *(char **)vecAt((Vector *)parts, i);
-        total_len += strlen(s);
-        if (i < count - 1) total_len += sep_len;
-    }
+    if (cap - (head - ring->tail_cache) < n) ring->tail_cache = __RING_LOAD(&ring->tail);
+    size_t room = cap - (head - ring->tail_cache);
+    if (n > room) n = room;
+    if (n == 0) return 0;
 
-    char *joined = malloc(total_len + 1);
-    if (!joined) return NULL;
+    __ringCopySpsc(ring, head, (void *)src, n, true);
+    __RING_STORE(&ring->head, head + n);
+    return n;
+}
+
+static size_t __ringTryPopSpsc(Ring *ring, void *dst, size_t n) {
+    size_t tail = ring->tail;
+
+    if (ring->head_cache - tail < n) ring->head_cache = __RING_LOAD(&ring->head);
+    size_t avail = ring->head_cache - tail;
+    if (n > avail) n = avail;
+    if (n == 0) return 0;
+
+    __ringCopySpsc(ring, tail, dst, n, false);
+    __RING_STORE(&ring->tail, tail + n);
+    return n;
+}
 
-    char *p = joined;
-    for (uint32_t i = 0; i < count; i++) {
-        char *s = *(char **)vecAt((Vector *)parts, i);
-        size_t len = strlen(s);
-        memcpy(p, s, len);
-        p += len;
+// Counts the slots from 'pos' on (up to 'n') whose sequence number is
+// 'pos + i + ahead', i.e. free to push (ahead = 0) or full to pop
+// (ahead = 1). '*stale' is set when the first slot shows 'pos' was
+// already taken by another thread.
+static size_t __ringReady(Ring *ring, size_t pos, size_t n, size_t ahead, bool *stale) {
+    size_t k = 0;
+    *stale = false;
+    for (; k < n; k++) {
+        intptr_t dif = (intptr_t)(__RING_LOAD(__ringSeq(ring, pos + k)) - (pos + k + ahead));
+        if (dif != 0) {
+            *stale = k == 0 && dif > 0;
+            break;
+        }
+    }
+    return k;
+}
 
-        if (i < count - 1) {
-            memcpy(p, sep, sep_len);
-            p += sep_len;
+static size_t __ringTryPushMpmc(Ring *ring, const void *src, size_t n) {
+    size_t pos = __atomic_load_n(&ring->head, __ATOMIC_RELAXED);
+
+    // A ready slot stays ready until its position is claimed, so the CAS
+    // on 'head' alone makes the whole batch ours
+    size_t k;
+    for (;;) {
+        bool stale;
+        k = __ringReady(ring, pos, n, 0, &stale);
+        if (stale) {
+            pos = __atomic_load_n(&ring->head, __ATOMIC_RELAXED);
+            continue;
         }
+        if (k == 0) return 0;  // Full, or the next slot is still being read
+        if (__atomic_compare_exchange_n(&ring->head, &pos, pos + k, true,
+                                        __ATOMIC_ACQ_REL, __ATOMIC_RELAXED)) break;
     }
 
-    *p = '\0';
-    return joined;
+    const uint8_t *s = (const uint8_t *)src;
+    for (size_t i = 0; i < k; i++) {
+        size_t *seq = __ringSeq(ring, pos + i);
+        memcpy(seq + 1, s + i * ring->cell_size, ring->cell_size);
+        __RING_STORE(seq, pos + i + 1);
+    }
+    return k;
 }
 
-#endif // DU_VECTOR
+static size_t __ringTryPopMpmc(Ring *ring, void *dst, size_t n) {
+    size_t pos = __atomic_load_n(&ring->tail, __ATOMIC_RELAXED);
 
-#endif // DU_STRINGS
+    size_t k;
+    for (;;) {
+        bool stale;
+        k = __ringReady(ring, pos, n, 1, &stale);
+        if (stale) {
+            pos = __atomic_load_n(&ring->tail, __ATOMIC_RELAXED);
+            continue;
+        }
+        if (k == 0) return 0;  // Empty, or the next slot is still being written
+        if (__atomic_compare_exchange_n(&ring->tail, &pos, pos + k, true,
+                                        __ATOMIC_ACQ_REL, __ATOMIC_RELAXED)) break;
+    }
 
+    uint8_t *d = (uint8_t *)dst;
+    for (size_t i = 0; i < k; i++) {
+        size_t *seq = __ringSeq(ring, pos + i);
+        memcpy(d + i * ring->cell_size, seq + 1, ring->cell_size);
+        __RING_STORE(seq, pos + i + ring->mask + 1);
+    }
+    return k;
+}
 
-#ifdef DU_TUI
+size_t ringTryPushN(Ring *ring, const void *src, size_t n) {
+    assert(ring && (src || n == 0));
+    if (ring->flags & DU_RING_MPMC) return __ringTryPushMpmc(ring, src, n);
+    return __ringTryPushSpsc(ring, src, n);
+}
 
-void tuiSetColor(const char *foreground, const char *background) {
-    if (foreground) printf("%s", foreground);
-    if (background) printf("%s", background);
+size_t ringTryPopN(Ring *ring, void *dst, size_t n) {
+    assert(ring && (dst || n == 0));
+    if (ring->flags & DU_RING_MPMC) return __ringTryPopMpmc(ring, dst, n);
+    return __ringTryPopSpsc(ring, dst, n);
 }
 
-void tuiReset(void) {
-    printf("%s", DU_TUI_RESET);
+void ringPushN(Ring *ring, const void *src, size_t n) {
+    const uint8_t *s = src;
+    unsigned spins = 0;
+    while (n > 0) {
+        size_t k = ringTryPushN(ring, s, n);
+        if (k == 0) {
+            __ringRelax(&spins);
+            continue;
+        }
+        s += k * ring->cell_size;
+        n -= k;
+    }
 }
 
-void tuiCursorUp(uint8_t n) {
-    if (n > 0) printf("\x1b[%uA", n);
+void ringPopN(Ring *ring, void *dst, size_t n) {
+    uint8_t *d = dst;
+    unsigned spins = 0;
+    while (n > 0) {
+        size_t k = ringTryPopN(ring, d, n);
+        if (k == 0) {
+            __ringRelax(&spins);
+            continue;
+        }
+        d += k * ring->cell_size;
+        n -= k;
+    }
 }
 
-void tuiCursorDown(uint8_t n) {
-    if (n > 0) printf("\x1b[%uB", n);
+bool ringTryPush(Ring *ring, const void *rec) {
+    return ringTryPushN(ring, rec, 1) == 1;
 }
 
-void tuiCursorRight(uint8_t n) {
-    if (n > 0) printf("\x1b[%uC", n);
+bool ringTryPop(Ring *ring, void *out) {
+    return ringTryPopN(ring, out, 1) == 1;
 }
 
-void tuiCursorLeft(uint8_t n) {
-    if (n > 0) printf("\x1b[%uD", n);
+void ringPush(Ring *ring, const void *rec) {
+    ringPushN(ring, rec, 1);
 }
 
-void tuiCursorPos(uint8_t x, uint8_t y) {
-    printf("\x1b[%u;%uH", y, x);
+void ringPop(Ring *ring, void *out) {
+    ringPopN(ring, out, 1);
 }
 
-void tuiHideCursor(void) {
-    printf("\x1b[?25l");
+size_t ringCount(const Ring *ring) {
+    assert(ring);
+    size_t tail = __RING_LOAD(&ring->tail);
+    size_t head = __RING_LOAD(&ring->head);
+    size_t n = head - tail;
+    return n > ring->mask + 1 ? 0 : n;
 }
 
-void tuiShowCursor(void) {
-    printf("\x1b[?25h");
+size_t ringCapacity(const Ring *ring) {
+    assert(ring);
+    return ring->mask + 1;
 }
 
-void tuiClearScreen(void) {
-    printf("\x1b[2J\x1b[H");
+void ringFree(Ring *ring) {
+    if (!ring) return;
+    __duFreeA(ring->alloc, ring->mem);
 }
 
-#endif // DU_TUI
+#undef __RING_LOAD
+#undef __RING_STORE
+
+#endif // DU_RING
 
 
 #endif // DU_IMPLEMENTATION